@@ -44,8 +44,8 @@ int main(int argc, char *argv[]) {
   Config * cfg = hemocell.cfg;
 
   int nx, ny, nz;
-  nx = ny = nz =(*cfg)["domain"]["refDirN"].read<int>() ;
-//  ny = nz = (*cfg)["domain"]["refDirN"].read<int>() ;
+  nx = ny = nz = cfg->get<int>("domain/refDirN") ;
+//  ny = nz = cfg->get<int>("domain/refDirN") ;
   hlog << "(unbounded) (Parameters) calculating flow parameters" << endl;
   param::lbm_pipe_parameters((*cfg),nx);
   param::printParameters();
@@ -57,7 +57,7 @@ int main(int argc, char *argv[]) {
 //  param::tau_CEPAC = param::tau;
 
   hemocell.lattice = new MultiBlockLattice3D<T, DESCRIPTOR>(
-            defaultMultiBlockPolicy3D().getMultiBlockManagement(nx,ny,nz, (*cfg)["domain"]["fluidEnvelope"].read<int>()),
+            defaultMultiBlockPolicy3D().getMultiBlockManagement(nx,ny,nz, cfg->get<int>("domain/fluidEnvelope")),
             defaultMultiBlockPolicy3D().getBlockCommunicator(),
             defaultMultiBlockPolicy3D().getCombinedStatistics(),
             defaultMultiBlockPolicy3D().getMultiCellAccess<T, DESCRIPTOR>(),
@@ -69,7 +69,7 @@ int main(int argc, char *argv[]) {
   hemocell.latticeEquilibrium(1.,plb::Array<T, 3>(0.,0.,0.));
 
   //Driving Force
-  double shear_rate = (*cfg)["parameters"]["shearRate"].read<double>(); //input shear rate s-1
+  double shear_rate = cfg->get<double>("parameters/shearRate"); //input shear rate s-1
   hlog << "shear_rate = " << shear_rate << endl;
 
   double velocity_max = (shear_rate*(nz*param::dx));
@@ -85,14 +85,14 @@ int main(int argc, char *argv[]) {
   hemocell.initializeCellfield();
 
   hemocell.addCellType<RbcHighOrderModel>("RBC", RBC_FROM_SPHERE);
-  hemocell.setMaterialTimeScaleSeparation("RBC", (*cfg)["ibm"]["stepMaterialEvery"].read<int>());
+  hemocell.setMaterialTimeScaleSeparation("RBC", cfg->get<int>("ibm/stepMaterialEvery"));
   hemocell.setInitialMinimumDistanceFromSolid("RBC", 1); //Micrometer! not LU
 
   hemocell.addCellType<PltSimpleModel>("PLT",ELLIPSOID_FROM_SPHERE);
-  hemocell.setMaterialTimeScaleSeparation("PLT", (*cfg)["ibm"]["stepMaterialEvery"].read<int>());
+  hemocell.setMaterialTimeScaleSeparation("PLT", cfg->get<int>("ibm/stepMaterialEvery"));
   hemocell.enableSolidifyMechanics("PLT");
 
-  hemocell.setParticleVelocityUpdateTimeScaleSeparation((*cfg)["ibm"]["stepParticleEvery"].read<int>());
+  hemocell.setParticleVelocityUpdateTimeScaleSeparation(cfg->get<int>("ibm/stepParticleEvery"));
 
   vector<int> outputs = {OUTPUT_POSITION,OUTPUT_TRIANGLES,OUTPUT_FORCE,OUTPUT_FORCE_VOLUME,OUTPUT_FORCE_BENDING,OUTPUT_FORCE_LINK,OUTPUT_FORCE_AREA,OUTPUT_FORCE_VISC};
   hemocell.setOutputs("RBC", outputs);
@@ -130,7 +130,7 @@ int main(int argc, char *argv[]) {
   hemocell.lattice->initialize();
   hemocell.cellfields->CEPACfield->initialize();
 
-  hemocell.enableBoundaryParticles((*cfg)["domain"]["kRep"].read<T>(), (*cfg)["domain"]["BRepCutoff"].read<T>(),(*cfg)["ibm"]["stepMaterialEvery"].read<int>());
+  hemocell.enableBoundaryParticles(cfg->get<T>("domain/kRep"), cfg->get<T>("domain/BRepCutoff"),cfg->get<int>("ibm/stepMaterialEvery"));
 
   //loading the cellfield
   if (not cfg->checkpointed) {
@@ -140,9 +140,9 @@ int main(int argc, char *argv[]) {
     hemocell.loadCheckPoint();
   }
 
-  unsigned int tmax = (*cfg)["sim"]["tmax"].read<unsigned int>();
-  unsigned int tmeas = (*cfg)["sim"]["tmeas"].read<unsigned int>();
-  unsigned int tcheckpoint = (*cfg)["sim"]["tcheckpoint"].read<unsigned int>();
+  unsigned int tmax = cfg->get<unsigned int>("sim/tmax");
+  unsigned int tmeas = cfg->get<unsigned int>("sim/tmeas");
+  unsigned int tcheckpoint = cfg->get<unsigned int>("sim/tcheckpoint");
 
   hlog << "(PipeFlow) Starting simulation..." << endl;
 
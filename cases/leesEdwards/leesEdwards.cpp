@@ -40,7 +40,7 @@ int main (int argc, char * argv[]) {
     new GuoExternalForceBGKdynamics<T, DESCRIPTOR>(1.0/param::tau));
 
   hemocell.lattice->toggleInternalStatistics(false);
-  LeesEdwardsBC<T, DESCRIPTOR> LEbc (*hemocell.lattice, param::shearrate_lbm, dt, &hemocell.LEcurrentDisplacement);
+  LeesEdwardsBC<T, DESCRIPTOR> LEbc (hemocell, param::shearrate_lbm, dt);
   LEbc.initialize();
 
   hemocell.lattice->initialize();
@@ -77,9 +77,7 @@ int main(int argc, char *argv[]) {
 
   //Driving Force
   T poiseuilleForce =  8 * param::nu_lbm * (param::u_lbm_max * 0.5) / param::pipe_radius / param::pipe_radius;
-  setExternalVector(*hemocell.lattice, (*hemocell.lattice).getBoundingBox(),
-                    DESCRIPTOR<T>::ExternalField::forceBeginsAt,
-                    plb::Array<T, DESCRIPTOR<T>::d>(poiseuilleForce, 0.0, 0.0));
+  hemocell.setBodyForce({poiseuilleForce, 0.0, 0.0});
 
   hemocell.lattice->initialize();
 
@@ -140,11 +138,6 @@ int main(int argc, char *argv[]) {
   while (hemocell.iter < tmax ) {
     hemocell.iterate();
 
-    //Set driving force as required after each iteration
-    setExternalVector(*hemocell.lattice, hemocell.lattice->getBoundingBox(),
-                DESCRIPTOR<T>::ExternalField::forceBeginsAt,
-                plb::Array<T, DESCRIPTOR<T>::d>(poiseuilleForce, 0.0, 0.0));
-
     if (hemocell.iter % tmeas == 0) {
         hlog << "(main) Stats. @ " <<  hemocell.iter << " (" << hemocell.iter * param::dt << " s):" << std::endl;
         hlog << "\t # of cells: " << CellInformationFunctionals::getTotalNumberOfCells(&hemocell);
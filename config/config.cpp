@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "genericFunctions.h"
 #include <stdexcept>
 #include <sys/stat.h>
+#include <cmath>
 
 #include "parallelism/mpiManager.h"
 #include "io/parallelIO.h"
@@ -50,12 +51,52 @@ namespace hemo {
     orig = new tinyxml2::XMLDocument();
     orig->LoadFile(paramXmlFileName.c_str());
    // Check if it is a fresh start or a checkpointed run 
+    checkpointed = 0;
     tinyxml2::XMLNode * first =orig->FirstChild()->NextSibling();
     if (first) {
       string firstField = first->Value(); 
       if (firstField == "Checkpoint") { checkpointed = 1; } //If the first field is not checkpoint but hemocell
       else { checkpointed = 0; }
     }
+
+    // Parse all parameters once, so get<T>() does not have to
+    parameters.clear();
+    tinyxml2::XMLElement * root = orig->FirstChildElement(checkpointed ? "Checkpoint" : "hemocell");
+    if (root && checkpointed) {
+      root = root->FirstChildElement("hemocell");
+    }
+    if (root) {
+      parseParameters(root, "");
+    }
+  }
+
+  void Config::parseParameters(tinyxml2::XMLElement * element, const std::string & path) {
+    for (tinyxml2::XMLElement * child = element->FirstChildElement(); child; child = child->NextSiblingElement()) {
+      const string childPath = path.empty() ? string(child->Name()) : path + "/" + child->Name();
+      // Only the first of repeated elements is accessible, as with operator[]
+      if (parameters.find(childPath) != parameters.end()) {
+        continue;
+      }
+      ConfigParameter & value = parameters[childPath];
+      if (child->GetText()) {
+        value.text = child->GetText();
+        const size_t begin = value.text.find_first_not_of(" \t\n\r");
+        const size_t end = value.text.find_last_not_of(" \t\n\r");
+        value.text = (begin == string::npos) ? "" : value.text.substr(begin, end - begin + 1);
+      }
+      std::stringstream text(value.text);
+      value.isNumber = (text >> value.number) && (text >> std::ws).eof();
+      value.isSection = child->FirstChildElement() != nullptr;
+      parseParameters(child, childPath);
+    }
+  }
+
+  const ConfigParameter & Config::parameter(const std::string & path) const {
+    std::map<std::string,ConfigParameter>::const_iterator value = parameters.find(path);
+    if (value == parameters.end()) {
+      throw invalid_argument("XML child " + path + " does not exist.");
+    }
+    return value->second;
   }
   
   Config::~Config() {
@@ -95,7 +136,7 @@ void loadDirectories(hemo::Config * cfg, bool edit_out_dir)  {
   //setting outdir
   if (edit_out_dir) {
     try {
-      std::string outDir = (*cfg)["parameters"]["outputDirectory"].read<string>();
+      std::string outDir = cfg->get<string>("parameters/outputDirectory");
       while (outDir[outDir.size()-1] == '/') {
         outDir.pop_back();
       }
@@ -126,7 +167,7 @@ outdir_done:
   }
   //Setting logdir  
   try {
-    std::string outDir = (*cfg)["parameters"]["logDirectory"].read<string>() + "/";
+    std::string outDir = cfg->get<string>("parameters/logDirectory") + "/";
     outDir = plb::global::directories().getOutputDir() + "/" + outDir;
     plb::global::directories().setLogOutDir(outDir);
   } catch (std::invalid_argument & exeption) {
@@ -136,7 +177,7 @@ outdir_done:
   //Setting logfile
   string logfilename = "logfile";
   try {
-    logfilename = (*cfg)["parameters"]["logFile"].read<string>();
+    logfilename = cfg->get<string>("parameters/logFile");
   } catch (std::invalid_argument & exeption) {}
   if (!plb::global::mpi().getRank()) {
     mkpath(plb::global::directories().getLogOutDir().c_str(), 0777);
@@ -167,7 +208,7 @@ outdir_done:
   
   //Setting CheckpointDirectory
   try { 
-    hemo::global.checkpointDirectory = plb::global::directories().getOutputDir() + "/" + (*cfg)["parameters"]["checkpointDirectory"].read<string>() + "/";
+    hemo::global.checkpointDirectory = plb::global::directories().getOutputDir() + "/" + cfg->get<string>("parameters/checkpointDirectory") + "/";
   } catch (std::invalid_argument & exception) {
     hemo::global.checkpointDirectory = plb::global::directories().getOutputDir() + "/checkpoint/";
   }
@@ -176,14 +217,25 @@ outdir_done:
 ConfigValues global;
 
 void loadGlobalConfigValues(hemo::Config * cfg) {
+  checkConfigParameters(cfg);
   try {
-   global.cellsDeletedInfo = (*cfg)["verbose"]["cellsDeletedInfo"].read<int>();
+   global.cellsDeletedInfo = cfg->get<int>("verbose/cellsDeletedInfo");
   } catch(std::invalid_argument & e) {}
   try {
-   global.enableCEPACfield = (*cfg)["parameters"]["enableCEPACfield"].read<int>();
+   global.profilerTraceStart = cfg->get<unsigned int>("verbose/profilerTraceStart");
+   global.profilerTraceEnd = cfg->get<unsigned int>("verbose/profilerTraceEnd");
   } catch(std::invalid_argument & e) {}
   try {
-   global.enableSolidifyMechanics = (*cfg)["parameters"]["enableSolidifyMechanics"].read<int>();
+   global.hardwareCounterDepth = cfg->get<unsigned int>("verbose/hardwareCounterDepth");
+  } catch(std::invalid_argument & e) {}
+  try {
+   global.blockTelemetryInterval = cfg->get<unsigned int>("verbose/blockTelemetry");
+  } catch(std::invalid_argument & e) {}
+  try {
+   global.enableCEPACfield = cfg->get<int>("parameters/enableCEPACfield");
+  } catch(std::invalid_argument & e) {}
+  try {
+   global.enableSolidifyMechanics = cfg->get<int>("parameters/enableSolidifyMechanics");
 #ifndef SOLIDIFY_MECHANICS
    if (global.enableSolidifyMechanics) {
      hlog << "(Hemocell) (Config) Error EnableSolidifyMechanics is true but SOLIDIFY_MECHANICS (compile time) Is not defined" << std::endl;
@@ -193,5 +245,174 @@ void loadGlobalConfigValues(hemo::Config * cfg) {
   } catch(std::invalid_argument & e) {}
 }
 
+namespace {
+enum ParameterType { REAL, INTEGER, TEXT };
+
+struct KnownParameter {
+  const char * path;
+  ParameterType type;
+};
+
+// The parameters of the main config that are read by the library, the
+// examples or the cases
+const KnownParameter knownParameters[] = {
+  {"domain/geometry", TEXT},
+  {"domain/rhoP", REAL},
+  {"domain/nuP", REAL},
+  {"domain/dx", REAL},
+  {"domain/dt", REAL},
+  {"domain/refDir", INTEGER},
+  {"domain/refDirN", INTEGER},
+  {"domain/blockSize", INTEGER},
+  {"domain/kBT", REAL},
+  {"domain/Re", REAL},
+  {"domain/shearrate", REAL},
+  {"domain/particleEnvelope", INTEGER},
+  {"domain/fluidEnvelope", INTEGER},
+  {"domain/kRep", REAL},
+  {"domain/RepCutoff", REAL},
+  {"domain/BRepCutoff", REAL},
+  {"domain/mABx", INTEGER},
+  {"domain/mABy", INTEGER},
+  {"domain/mABz", INTEGER},
+  {"domain/Nx", INTEGER},
+  {"domain/Ny", INTEGER},
+  {"domain/Nz", INTEGER},
+  {"domain/nx", INTEGER},
+  {"domain/ny", INTEGER},
+  {"domain/nz", INTEGER},
+  {"domain/WSR", REAL},
+  {"domain/capillaryD", REAL},
+  {"domain/drivingForce", REAL},
+  {"domain/timeStepSize", INTEGER},
+  {"domain/minTimeStepSize", INTEGER},
+  {"domain/minForce", REAL},
+  {"domain/maxForce", REAL},
+  {"sim/tmax", INTEGER},
+  {"sim/tmeas", INTEGER},
+  {"sim/tcheckpoint", INTEGER},
+  {"sim/tbalance", INTEGER},
+  {"sim/tcsv", INTEGER},
+  {"sim/hematocrit", REAL},
+  {"sim/particlePosFile", TEXT},
+  {"sim/interiorViscosity", INTEGER},
+  {"sim/interiorViscosityEntireGrid", INTEGER},
+  {"ibm/stepMaterialEvery", INTEGER},
+  {"ibm/stepParticleEvery", INTEGER},
+  {"ibm/radius", REAL},
+  {"ibm/shape", INTEGER},
+  {"ibm/minNumOfTriangles", INTEGER},
+  {"ibm/minForceLimit", REAL},
+  {"ibm/maxForceLimit", REAL},
+  {"ibm/cellPath", TEXT},
+  {"verbose/cellsDeletedInfo", INTEGER},
+  {"verbose/profilerTraceStart", INTEGER},
+  {"verbose/profilerTraceEnd", INTEGER},
+  {"verbose/hardwareCounterDepth", INTEGER},
+  {"verbose/blockTelemetry", INTEGER},
+  {"parameters/outputDirectory", TEXT},
+  {"parameters/logDirectory", TEXT},
+  {"parameters/logFile", TEXT},
+  {"parameters/checkpointDirectory", TEXT},
+  {"parameters/enableCEPACfield", INTEGER},
+  {"parameters/enableSolidifyMechanics", INTEGER},
+  {"parameters/enableInteriorViscosity", INTEGER},
+  {"parameters/warmup", INTEGER},
+  {"parameters/maxPackIter", INTEGER},
+  {"parameters/maxFlin", REAL},
+  {"parameters/stretchForce", REAL},
+  {"parameters/prctForced", REAL},
+  {"parameters/shearRate", REAL},
+  {"parameters/speedRate", REAL},
+  {"parameters/Re", REAL},
+  {"parameters/heightChannel", REAL},
+  {"parameters/widthChannel", REAL},
+  {"parameters/widthStenosis", REAL},
+  {"parameters/percentageStenosis", REAL},
+  {"parameters/angleStenosis", REAL},
+  {"preInlet/record", TEXT},
+  {"preInlet/replay", TEXT},
+  {"preInlet/parameters/lengthN", INTEGER},
+  {"preInlet/parameters/Re", REAL},
+  {"preInlet/parameters/pABx", INTEGER},
+  {"preInlet/parameters/pABy", INTEGER},
+  {"preInlet/parameters/pABz", INTEGER},
+  {"preInlet/parameters/nProcs", INTEGER},
+  {"preInlet/parameters/pulseFile", TEXT},
+  {"preInlet/parameters/pulseFileName", TEXT},
+  {"preInlet/parameters/pFrequency", REAL},
+  {"preInlet/parameters/Cells/Cell", TEXT},
+};
+
+// The parameters of a material config, read by HemoCellField, the cell
+// mechanics and the solidification
+const KnownParameter knownMaterialParameters[] = {
+  {"MaterialModel/name", TEXT},
+  {"MaterialModel/comment", TEXT},
+  {"MaterialModel/StlFile", TEXT},
+  {"MaterialModel/kernel", TEXT},
+  {"MaterialModel/InnerEdges/Edge", TEXT},
+  {"MaterialModel/radius", REAL},
+  {"MaterialModel/minNumTriangles", INTEGER},
+  {"MaterialModel/aspectRatio", REAL},
+  {"MaterialModel/Volume", REAL},
+  {"MaterialModel/kLink", REAL},
+  {"MaterialModel/kBend", REAL},
+  {"MaterialModel/kVolume", REAL},
+  {"MaterialModel/kArea", REAL},
+  {"MaterialModel/eta_m", REAL},
+  {"MaterialModel/kInnerLink", REAL},
+  {"MaterialModel/kInnerRigid", REAL},
+  {"MaterialModel/kCytoskeleton", REAL},
+  {"MaterialModel/coreRadius", REAL},
+  {"MaterialModel/viscosityRatio", REAL},
+  {"MaterialModel/enableInteriorViscosity", INTEGER},
+  {"MaterialModel/distanceThreshold", REAL},
+  {"MaterialModel/shearThreshold", REAL},
+};
+
+template<size_t N>
+void checkParameters(hemo::Config * cfg, const KnownParameter (&knownParameters)[N], const std::string & prefix) {
+  std::map<std::string,ParameterType> known;
+  for (const KnownParameter & parameter : knownParameters) {
+    known[parameter.path] = parameter.type;
+  }
+
+  bool malformed = false;
+  std::string unknown;
+  for (const std::pair<const std::string,ConfigParameter> & parameter : cfg->getParameters()) {
+    std::map<std::string,ParameterType>::const_iterator type = known.find(parameter.first);
+    if (type == known.end()) {
+      if (!parameter.second.isSection) {
+        unknown += " " + parameter.first;
+      }
+      continue;
+    }
+    if (type->second == TEXT) {
+      continue;
+    }
+    const ConfigParameter & value = parameter.second;
+    if (!value.isNumber || (type->second == INTEGER && value.number != std::floor(value.number))) {
+      plb::pcout << prefix << " (Error) " << parameter.first << " should be "
+                 << (type->second == INTEGER ? "an integer" : "a number") << ", but is \"" << value.text << "\"" << std::endl;
+      malformed = true;
+    }
+  }
+  if (!unknown.empty()) {
+    plb::pcout << prefix << " (Warning) Parameters unknown to HemoCell, these are only used when the case reads them:" << unknown << std::endl;
+  }
+  if (malformed) {
+    exit(1);
+  }
+}
+}
+
+void checkConfigParameters(hemo::Config * cfg) {
+  checkParameters(cfg, knownParameters, "(HemoCell) (Config)");
+}
+
+void checkMaterialParameters(hemo::Config * cfg, const std::string & name) {
+  checkParameters(cfg, knownMaterialParameters, "(HemoCell) (Config) (" + name + ")");
 }
 
+}
@@ -31,6 +31,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <map>
+#include <stdexcept>
 
 namespace hemo {
 
@@ -55,6 +57,14 @@ namespace hemo {
   };
   
   
+  /// The text of an element of a Config, parsed once when the Config is loaded
+  struct ConfigParameter {
+    std::string text;
+    bool isNumber = false;
+    double number = 0.;
+    bool isSection = false; // Has child elements
+  };
+
   class Config {
     tinyxml2::XMLDocument * orig;
   public:
@@ -66,20 +76,55 @@ namespace hemo {
     void reload(std::string paramXmlFilename);
   
     hemo::XMLElement operator[] (std::string name) const;
+
+    /// Typed access to a parsed parameter, e.g. get<T>("domain/dx"), without
+    /// parsing the XML again. Throws invalid_argument when the parameter does
+    /// not exist or is not a number.
+    template<typename T>
+    T get(const std::string & path) const;
+
+    /// All parsed parameters, indexed by their path
+    const std::map<std::string,ConfigParameter> & getParameters() const { return parameters; }
     
     tinyxml2::XMLNode* ShallowClone(tinyxml2::XMLDocument* document) const;
     bool ShallowEqual(const tinyxml2::XMLNode* compare ) const;
     bool Accept( tinyxml2::XMLVisitor* visitor ) const;
   private:
+    std::map<std::string,ConfigParameter> parameters;
+
     void load(std::string paramXmlFilename);
+    void parseParameters(tinyxml2::XMLElement * element, const std::string & path);
+    const ConfigParameter & parameter(const std::string & path) const;
   };
 
+  template<typename T>
+  T Config::get(const std::string & path) const {
+    const ConfigParameter & value = parameter(path);
+    if (!value.isNumber) {
+      throw std::invalid_argument("Config parameter " + path + " is not a number.");
+    }
+    return static_cast<T>(value.number);
+  }
+
+  template<>
+  inline std::string Config::get<std::string>(const std::string & path) const {
+    return parameter(path).text;
+  }
+
 void loadDirectories(hemo::Config * cfg, bool edit_out_dir = true);
 
 struct ConfigValues {
   bool hemoCellInitialized = false; // Keep track since two hemocells cannot run at the same time, because of static variables
   bool cellsDeletedInfo = false;
 
+  // Record a profiler trace of the iterations [profilerTraceStart, profilerTraceEnd), disabled when equal
+  unsigned int profilerTraceStart = 0;
+  unsigned int profilerTraceEnd = 0;
+  // Count hardware events in the profiler timers up to this depth, 0 disables
+  unsigned int hardwareCounterDepth = 0;
+  // Write the cost of every atomic block every this many iterations, 0 disables
+  unsigned int blockTelemetryInterval = 0;
+
   bool enableCEPACfield = false;
 
   bool enableSolidifyMechanics = false;
@@ -95,5 +140,12 @@ extern ConfigValues global;
 
 void loadGlobalConfigValues(hemo::Config * cfg);
 
+/// Report malformed parameters known to HemoCell as an error and parameters
+/// unknown to HemoCell as a warning
+void checkConfigParameters(hemo::Config * cfg);
+
+/// The same for the material config of a cell type, name is used in the messages
+void checkMaterialParameters(hemo::Config * cfg, const std::string & name);
+
 }
 #endif
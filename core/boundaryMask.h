@@ -0,0 +1,93 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef HEMO_BOUNDARYMASK_H
+#define HEMO_BOUNDARYMASK_H
+
+#include "constant_defaults.h"
+#include "atomicBlock/blockLattice3D.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace hemo {
+
+/*
+ * One bit per node of an atomic block (envelope included) that is set when the
+ * dynamics of the node is a boundary. The nodes are ordered as the cells of a
+ * plb::BlockLattice3D (x, y, z with z fastest), so isBoundary() replaces a
+ * virtual getDynamics().isBoundary() call by a shift and a mask.
+ *
+ * The mask has to be rebuilt whenever the dynamics of the lattice change,
+ * HemoCellFields::updateBoundaryMasks() does so for all local blocks.
+ */
+class BoundaryMask {
+public:
+  void build(plb::BlockLattice3D<T,DESCRIPTOR> & lattice) {
+    nx = lattice.getNx();
+    ny = lattice.getNy();
+    nz = lattice.getNz();
+    bits.assign((nx*ny*nz + 63)/64, 0);
+    for (plint x = 0; x < nx; x++) {
+      for (plint y = 0; y < ny; y++) {
+        for (plint z = 0; z < nz; z++) {
+          if (lattice.get(x,y,z).getDynamics().isBoundary()) {
+            setBoundary(x,y,z);
+          }
+        }
+      }
+    }
+  }
+
+  inline bool isBoundary(plint x, plint y, plint z) const {
+    const plint node = index(x,y,z);
+    return (bits[node >> 6] >> (node & 63)) & 1;
+  }
+
+  inline void setBoundary(plint x, plint y, plint z) {
+    const plint node = index(x,y,z);
+    bits[node >> 6] |= uint64_t(1) << (node & 63);
+  }
+
+  /// Number of nodes that are not a boundary
+  plint countFluid() const {
+    plint boundaries = 0;
+    for (const uint64_t & word : bits) {
+      boundaries += __builtin_popcountll(word);
+    }
+    return nx*ny*nz - boundaries;
+  }
+
+  bool empty() const { return bits.empty(); }
+
+private:
+  inline plint index(plint x, plint y, plint z) const {
+    return (x*ny + y)*nz + z;
+  }
+
+  plint nx = 0, ny = 0, nz = 0;
+  std::vector<uint64_t> bits;
+};
+
+}
+#endif
@@ -90,6 +90,9 @@ HemoCell::HemoCell(char * configFileName, int argc, char * argv[], HemoCell::MPI
   printHeader();
   
   //Start statistics
+  if (global.hardwareCounterDepth) {
+    Profiler::enableHardwareCounters(global.hardwareCounterDepth);
+  }
   global.statistics.start();
   
 }
@@ -114,6 +117,12 @@ HemoCell::~HemoCell() {
   if (loadBalancer) {
     delete loadBalancer;
   }
+  if (blockTelemetry) {
+    delete blockTelemetry;
+  }
+  if (timescaleController) {
+    delete timescaleController;
+  }
   if (preInlet) { 
     delete preInlet;
   }
@@ -132,11 +141,19 @@ void HemoCell::latticeEquilibrium(T rho, hemo::Array<T, 3> vel) {
   plb::initializeAtEquilibrium(*lattice, (*lattice).getBoundingBox(), rho, vel_plb);
 }
 
+void HemoCell::setBodyForce(hemo::Array<T, 3> force) {
+  hlog << "(HemoCell) (Fluid) Setting body force to " << force[0] << ", " << force[1] << ", " << force[2] << endl;
+  bodyForce = force;
+  plb::Array<T,3> force_plb = {force[0],force[1],force[2]};
+  setExternalVector(*lattice, (*lattice).getBoundingBox(),
+          DESCRIPTOR<T>::ExternalField::forceBeginsAt, force_plb);
+}
+
 void HemoCell::initializeCellfield() {
   if (!domain_lattice) {
     domain_lattice = lattice;
   }
-  cellfields = new HemoCellFields(*lattice,(*cfg)["domain"]["particleEnvelope"].read<int>(),*this);
+  cellfields = new HemoCellFields(*lattice,cfg->get<int>("domain/particleEnvelope"),*this);
 
   //Set envelope of fluid to 1 again, while maintaining outer one for correct force distribution
   lattice->getMultiBlockManagement().changeEnvelopeWidth(1);
@@ -301,6 +318,11 @@ void HemoCell::iterate() {
   if (!sanityCheckDone) {
     sanityCheck();
     cellfields->calculateCommunicationStructure();
+    // Cases may define boundaries after initializeCellfield()
+    cellfields->updateBoundaryMasks();
+  }
+  if (iter == global.profilerTraceStart && global.profilerTraceEnd > global.profilerTraceStart) {
+    global.statistics.startTrace();
   }
   global.statistics.getCurrent()["iterate"].start();
   // ### 1 ### Particle Force to Fluid
@@ -310,6 +332,11 @@ void HemoCell::iterate() {
   if(boundaryRepulsionEnabled && iter % cellfields->boundaryRepulsionTimescale == 0) {
     cellfields->applyBoundaryRepulsionForce();
   }
+  // Particles injected by the pre-inlet travel during the repulsion, they
+  // need their kernels from spreadParticleForce()
+  if (preInlet) {
+    preInlet->finishPreInletParticleBoundary();
+  }
   cellfields->spreadParticleForce();
 
   // #### 2 #### LBM
@@ -364,15 +391,27 @@ void HemoCell::iterate() {
     cellfields->deleteNonLocalParticles(3);
   }
 
-  global.statistics.getCurrent()["setExternalVector"].start();
-  // Reset Forces on the lattice, TODO do own efficient implementation
-  setExternalVector(*lattice, (*lattice).getBoundingBox(),
-          DESCRIPTOR<T>::ExternalField::forceBeginsAt,
-          plb::Array<T, DESCRIPTOR<T>::d>(0.0, 0.0, 0.0));
-  global.statistics.getCurrent().stop();
+  if (cellfields->particleReorderTimescale && iter % cellfields->particleReorderTimescale == 0) {
+    cellfields->reorderParticles();
+  }
+
+  // Reset the forces on the lattice, only the nodes that received a particle force
+  cellfields->resetSpreadForce(bodyForce);
   
   iter++;
   global.statistics.getCurrent().stop();
+  if (timescaleController && iter % timescaleController->getInterval() == 0) {
+    timescaleController->update();
+  }
+  if (iter == global.profilerTraceEnd && global.profilerTraceEnd > global.profilerTraceStart) {
+    global.statistics.outputTrace(hlog.filename + ".trace.json");
+  }
+  if (global.blockTelemetryInterval && iter % global.blockTelemetryInterval == 0) {
+    if (!blockTelemetry) {
+      blockTelemetry = new BlockTelemetry(*this, global::directories().getLogOutDir() + "blockTelemetry.csv");
+    }
+    blockTelemetry->record();
+  }
 }
 
 T HemoCell::calculateFractionalLoadImbalance() {
@@ -396,6 +435,12 @@ void HemoCell::setRepulsionTimeScaleSeperation(unsigned int separation){
   cellfields->repulsionTimescale = separation;
 }
 
+void HemoCell::setParticleReorderTimescale(unsigned int interval, bool byCell) {
+  hlog << "(HemoCell) (Particle reordering) Sorting particles on " << (byCell ? "cell" : "Morton order") << " every " << interval << " timesteps" << endl;
+  cellfields->particleReorderTimescale = interval;
+  cellfields->particleReorderByCell = byCell;
+}
+
 void HemoCell::setSolidifyTimeScaleSeperation(unsigned int separation){
   hlog << "(HemoCell) (Solidify Timescale Seperation) Setting seperation to " << separation << " timesteps"<<endl;
   cellfields->solidifyTimescale = separation;
@@ -409,6 +454,14 @@ void HemoCell::setInteriorViscosityTimeScaleSeperation(unsigned int separation,
   cellfields->interiorViscosityEntireGridTimescale = separation_entire_grid;
 }
 
+void HemoCell::enableAdaptiveTimescaleSeparation(unsigned int maxSeparation, unsigned int interval) {
+  hlogfile << "(HemoCell) WARNING time-scale separation can introduce numerical error! " << endl;
+  if (timescaleController) {
+    delete timescaleController;
+  }
+  timescaleController = new TimescaleController(*this, maxSeparation, interval);
+}
+
 void HemoCell::setInitialMinimumDistanceFromSolid(string name, T distance) {
   hlog << "(HemoCell) (Set Distance) Setting minimum distance from solid to " << distance << " micrometer for " << name << endl; 
   if (loadParticlesIsCalled) {
@@ -440,13 +493,14 @@ void HemoCell::initializeLattice(MultiBlockManagement3D const & management) {
     delete lattice;
   }
 
-  if (!preInlet) {
+  // A replayed pre-inlet does not need its own processors
+  if (!preInlet || preInlet->isReplaying()) {
   
     try {
       SparseBlockStructure3D sb = createRegularDistribution3D(management.getBoundingBox(),
-                                                             (*cfg)["domain"]["mABx"].read<int>(),
-                                                             (*cfg)["domain"]["mABy"].read<int>(),
-                                                             (*cfg)["domain"]["mABz"].read<int>());
+                                                             cfg->get<int>("domain/mABx"),
+                                                             cfg->get<int>("domain/mABy"),
+                                                             cfg->get<int>("domain/mABz"));
 
       hlog << "(HemoCell) Domain management overwritten from config file." << endl;
       ExplicitThreadAttribution * eta = new ExplicitThreadAttribution(BlockToMpi);
@@ -482,9 +536,9 @@ void HemoCell::initializeLattice(MultiBlockManagement3D const & management) {
   totalNodes += cellsInBoundingBox(management.getBoundingBox());
   
   try  { // Look for block management info in the config file
-        plint preInlet_pABx = (*cfg)["preInlet"]["parameters"]["pABx"].read<plint>();
-        plint preInlet_pABy = (*cfg)["preInlet"]["parameters"]["pABy"].read<plint>();
-        plint preInlet_pABz = (*cfg)["preInlet"]["parameters"]["pABz"].read<plint>();
+        plint preInlet_pABx = cfg->get<plint>("preInlet/parameters/pABx");
+        plint preInlet_pABy = cfg->get<plint>("preInlet/parameters/pABy");
+        plint preInlet_pABz = cfg->get<plint>("preInlet/parameters/pABz");
         preInlet->nProcs = preInlet_pABx*preInlet_pABy*preInlet_pABz;
       }
   catch (const std::invalid_argument& e)  {
@@ -521,9 +575,9 @@ void HemoCell::initializeLattice(MultiBlockManagement3D const & management) {
   
   try {  // Look for block management info in the config file    
     SparseBlockStructure3D sb_preinlet = createRegularDistribution3D(preInlet->location,
-                                                                     (*cfg)["preInlet"]["parameters"]["pABx"].read<int>(),
-                                                                     (*cfg)["preInlet"]["parameters"]["pABy"].read<int>(),
-                                                                     (*cfg)["preInlet"]["parameters"]["pABz"].read<int>());
+                                                                     cfg->get<int>("preInlet/parameters/pABx"),
+                                                                     cfg->get<int>("preInlet/parameters/pABy"),
+                                                                     cfg->get<int>("preInlet/parameters/pABz"));
     hlog << "(HemoCell) (PreInlet) Domain management overwritten from config file." << endl;
     ExplicitThreadAttribution * eta_preinlet = new ExplicitThreadAttribution(preInlet->BlockToMpi);
     preinlet_lattice_management = new MultiBlockManagement3D(sb_preinlet,eta_preinlet,management.getEnvelopeWidth(),management.getRefinementLevel());
@@ -537,9 +591,9 @@ void HemoCell::initializeLattice(MultiBlockManagement3D const & management) {
 
   try { // Look for block management info in the config file
     SparseBlockStructure3D sb = createRegularDistribution3D(management.getBoundingBox(),
-                                                           (*cfg)["domain"]["mABx"].read<int>(),
-                                                           (*cfg)["domain"]["mABy"].read<int>(),
-                                                           (*cfg)["domain"]["mABz"].read<int>());
+                                                           cfg->get<int>("domain/mABx"),
+                                                           cfg->get<int>("domain/mABy"),
+                                                           cfg->get<int>("domain/mABz"));
     hlog << "(HemoCell) Domain management overwritten from config file." << endl;
     ExplicitThreadAttribution * eta = new ExplicitThreadAttribution(BlockToMpi);
     domain_lattice_management = new MultiBlockManagement3D(sb,eta,management.getEnvelopeWidth(),management.getRefinementLevel());
@@ -661,7 +715,7 @@ void HemoCell::sanityCheck() {
   }
      
   
-  if ((*cfg)["sim"]["tmax"].read<long int>() > 100000000000 ) {
+  if (cfg->get<long int>("sim/tmax") > 100000000000 ) {
     hlog << "(HemoCell) (SanityChecking) More than 100000000000 iterations requested, this means that the zero padding will not be consistent, therefore string sorting output will not work!" << endl;
   };
   
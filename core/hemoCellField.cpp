@@ -45,10 +45,11 @@ HemoCellField::HemoCellField(HemoCellFields& cellFields_, string & name_, unsign
 
   string materialXML = name + ".xml";
   materialCfg = new Config(materialXML.c_str());
+  checkMaterialParameters(materialCfg, name);
 
   T aspectRatio = 0.3;
   if (constructType == ELLIPSOID_FROM_SPHERE) {
-    aspectRatio = (*materialCfg)["MaterialModel"]["aspectRatio"].read<T>();
+    aspectRatio = materialCfg->get<T>("MaterialModel/aspectRatio");
   }
 
   if(constructType == STRING_FROM_VERTEXES) {
@@ -57,13 +58,13 @@ HemoCellField::HemoCellField(HemoCellFields& cellFields_, string & name_, unsign
   } else {
     try {
       boundaryElement = new TriangleBoundary3D<T>(constructMeshElement(constructType, 
-                         (*materialCfg)["MaterialModel"]["radius"].read<T>()/param::dx, 
+                         materialCfg->get<T>("MaterialModel/radius")/param::dx, 
                          0, param::dx, 
-                         (*materialCfg)["MaterialModel"]["StlFile"].read<string>(), plb::Array<T,3>(0.,0.,0.), aspectRatio));
+                         materialCfg->get<string>("MaterialModel/StlFile"), plb::Array<T,3>(0.,0.,0.), aspectRatio));
     } catch (std::invalid_argument & exeption) {
       boundaryElement = new TriangleBoundary3D<T>(constructMeshElement(constructType, 
-                         (*materialCfg)["MaterialModel"]["radius"].read<T>()/param::dx, 
-                         (*materialCfg)["MaterialModel"]["minNumTriangles"].read<T>(), param::dx, 
+                         materialCfg->get<T>("MaterialModel/radius")/param::dx, 
+                         materialCfg->get<T>("MaterialModel/minNumTriangles"), param::dx, 
                          string(""), plb::Array<T,3>(0.,0.,0.), aspectRatio));
     }
     meshElement = new TriangularSurfaceMesh<T>(boundaryElement->getMesh());
@@ -91,16 +92,32 @@ HemoCellField::HemoCellField(HemoCellFields& cellFields_, string & name_, unsign
    string materialXML = name + ".xml";
    hemo::Config materialCfg(materialXML.c_str());
    try{
-     volume = materialCfg["MaterialModel"]["Volume"].read<T>();
+     volume = materialCfg.get<T>("MaterialModel/Volume");
      volumeFractionOfLspPerNode = (volume/numVertex)/pow(param::dx*1e6,3);
    } catch (std::invalid_argument & exeption) {
        hlog << "(HemoCell) (WARNING) (AddCellType) Volume of celltype " << name << " not present, volume set to zero" << endl;
    }
    try {
-     interiorViscosityTau = materialCfg["MaterialModel"]["viscosityRatio"].read<T>()*(param::tau-0.5)+0.5;
+     string kernel = materialCfg.get<string>("MaterialModel/kernel");
+     if (kernel == "phi2") {
+       kernelMethod = interpolationCoefficientsPhi2;
+     } else if (kernel == "phi3") {
+       kernelMethod = interpolationCoefficientsPhi3;
+     } else if (kernel == "phi4") {
+       kernelMethod = interpolationCoefficientsPhi4;
+     } else if (kernel == "phi4c") {
+       kernelMethod = interpolationCoefficientsPhi4c;
+     } else {
+       hlog << "(HemoCell) (AddCellType) (" << name << ") (Error) Unknown kernel " << kernel << ", choose from phi2, phi3, phi4 or phi4c" << endl;
+       exit(1);
+     }
+     hlog << "(HemoCell) (AddCellType) (" << name << ") Using the " << kernel << " interpolation kernel" << endl;
+   } catch (std::invalid_argument & e) {}
+   try {
+     interiorViscosityTau = materialCfg.get<T>("MaterialModel/viscosityRatio")*(param::tau-0.5)+0.5;
    } catch (std::invalid_argument & e) {}
    try {
-     doInteriorViscosity = materialCfg["MaterialModel"]["enableInteriorViscosity"].read<bool>();
+     doInteriorViscosity = materialCfg.get<bool>("MaterialModel/enableInteriorViscosity");
      if (doInteriorViscosity) {
 #ifdef INTERIOR_VISCOSITY
        hlog << "(HemoCell) (AddCellType) ("<< name << ") Enabling interior viscosity" << endl;
@@ -33,6 +33,7 @@ class HemoCellField;
 #include "meshMetrics.h"
 #include "hemoCellFields.h"
 #include "hemoCellParticle.h"
+#include "boundaryMask.h"
 
 #include "multiBlock/multiBlockLattice3D.hh"
 #include "particles/multiParticleField3D.hh"
@@ -64,7 +65,7 @@ class HemoCellField{
   unsigned int minimumDistanceFromSolid = 0;
   bool outputTriangles = false;
   vector<hemo::Array<plint,3>> triangle_list;
-  void(*kernelMethod)(plb::BlockLattice3D<T,DESCRIPTOR> &,HemoCellParticle&);
+  void(*kernelMethod)(plb::BlockLattice3D<T,DESCRIPTOR> &,HemoCellParticle&,BoundaryMask const&);
   plb::MultiParticleField3D<HemoCellParticleField> * getParticleField3D();
   plb::MultiBlockLattice3D<T,DESCRIPTOR> * getFluidField3D();
   int getNumberOfCells_Global();
@@ -78,6 +79,9 @@ class HemoCellField{
   hemo::Array<T,6> getOriginalBoundingBox();
   plb::MeshMetrics<T> * meshmetric = 0;
   bool doSolidifyMechanics = false;
+  ///Solidification thresholds, read from the material model by HemoCell::enableSolidifyMechanics()
+  T solidifyDistanceThreshold = 0.;
+  T solidifyShearThreshold = 0.;
   bool doInteriorViscosity = false;
   T interiorViscosityTau = 1.0;
   plb::Dynamics<T,DESCRIPTOR> * innerViscosityDynamics = 0;
@@ -78,7 +78,7 @@ void HemoCellFields::createParticleField(SparseBlockStructure3D* sbStructure, Th
   }
   plint refinement = lattice->getMultiBlockManagement().getRefinementLevel();
 
-  if (hemocell.preInlet) {
+  if (hemocell.preinlet_lattice) {
     preinlet_immersedParticles = new MultiParticleField3D<HemoCellParticleField>(MultiBlockManagement3D(
       *hemocell.preinlet_lattice->getSparseBlockStructure().clone(),
       hemocell.preinlet_lattice->getMultiBlockManagement().getThreadAttribution().clone(),
@@ -196,6 +196,14 @@ void HemoCellFields::copyXMLreader2XMLwriter(XMLreaderProxy readerProxy, XMLwrit
     }
 }
 
+void HemoCellFields::updateBoundaryMasks() {
+  std::vector<plint> const& blocks = immersedParticles->getLocalInfo().getBlocks();
+  for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
+    HemoCellParticleField & pf = immersedParticles->getComponent(blocks[iBlock]);
+    pf.boundaryMask.build(*pf.atomicLattice);
+  }
+}
+
 /*
  * Initialize variables that need to be loaded after a checkpoint AS WELL
  */
@@ -216,16 +224,8 @@ void HemoCellFields::InitAfterLoadCheckpoint()
     immersedParticles->getComponent(blocks[iBlock]).envelopeSize = envelopeSize;
     
     BlockLattice3D<T,DESCRIPTOR> * fluid = immersedParticles->getComponent(blocks[iBlock]).atomicLattice;
-    immersedParticles->getComponent(blocks[iBlock]).nFluidCells = 0;
-    for(unsigned int x = 0; x < fluid->getNx(); x++ ) {
-      for(unsigned int y = 0; y < fluid->getNy(); y++ ) {
-        for(unsigned int z = 0; z < fluid->getNz(); z++ ) {
-          if (!fluid->get(x,y,z).getDynamics().isBoundary()) {
-            immersedParticles->getComponent(blocks[iBlock]).nFluidCells++;
-          }
-        }
-      }
-    }
+    immersedParticles->getComponent(blocks[iBlock]).boundaryMask.build(*fluid);
+    immersedParticles->getComponent(blocks[iBlock]).nFluidCells = immersedParticles->getComponent(blocks[iBlock]).boundaryMask.countFluid();
     
     //Calculate neighbours 
     immersedParticles->getSparseBlockStructure().findNeighbors(blocks[iBlock], envelopeSize,
@@ -251,7 +251,7 @@ void HemoCellFields::load(XMLreader * documentXML, unsigned int & iter, Config *
 
       std::string & chkDir = hemo::global.checkpointDirectory;
 
-      if (hemocell.preInlet) {
+      if (hemocell.preinlet_lattice) {
         plb::parallelIO::load(chkDir + "PRE_lattice", *hemocell.preinlet_lattice, true);
         plb::parallelIO::load(chkDir + "PRE_particleField", *preinlet_immersedParticles, true);
       }
@@ -260,7 +260,7 @@ void HemoCellFields::load(XMLreader * documentXML, unsigned int & iter, Config *
     } else {
       pcout << "(HemoCell) (CellFields) loading checkpoint from non-checkpoint Config" << endl;
       std::string & chkDir = hemo::global.checkpointDirectory;
-      if (hemocell.preInlet) {
+      if (hemocell.preinlet_lattice) {
         plb::parallelIO::load(chkDir + "PRE_lattice", *hemocell.preinlet_lattice, true);
         plb::parallelIO::load(chkDir + "PRE_particleField", *preinlet_immersedParticles, true);
       }
@@ -294,7 +294,7 @@ void HemoCellFields::save(XMLreader *xmlr, unsigned int iter, Config * cfg)
         renameFileToDotOld(outDir + "particleField.dat");
         renameFileToDotOld(outDir + "particleField.plb");
         renameFileToDotOld(outDir + "checkpoint.xml");
-        if (hemocell.preInlet) {
+        if (hemocell.preinlet_lattice) {
           renameFileToDotOld(outDir + "PRE_lattice.dat");
           renameFileToDotOld(outDir + "PRE_lattice.plb");
           renameFileToDotOld(outDir + "PRE_particleField.dat");
@@ -309,7 +309,7 @@ void HemoCellFields::save(XMLreader *xmlr, unsigned int iter, Config * cfg)
     xmlw["Checkpoint"]["General"]["OutDirectory"].set(plb::global::directories().getOutputDir());
     xmlw.print(outDir + "checkpoint.xml");
 
-    if (hemocell.preInlet) {
+    if (hemocell.preinlet_lattice) {
       plb::parallelIO::save(*hemocell.preinlet_lattice, outDir + "PRE_lattice", true);
       plb::parallelIO::save(*preinlet_immersedParticles, outDir + "PRE_particleField", true);
     }
@@ -351,7 +351,7 @@ void HemoCellFields::HemoInterpolateFluidVelocity::processGenericBlocks(Box3D do
     dynamic_cast<HemoCellParticleField*>(blocks[0])->interpolateFluidVelocity(domain);
 }
 void HemoCellFields::interpolateFluidVelocity() {
-  global.statistics.getCurrent()["interpolateFluidVelocity"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("interpolateFluidVelocity")].start();
 
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -375,7 +375,7 @@ void HemoCellFields::HemoSyncEnvelopes::processGenericBlocks(Box3D domain, std::
     dynamic_cast<HemoCellParticleField*>(blocks[0])->syncEnvelopes();
 }
 void HemoCellFields::syncEnvelopes() {
-  global.statistics.getCurrent()["syncEnvelopes"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("syncEnvelopes")].start();
 
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -502,7 +502,7 @@ void HemoCellFields::HemoAdvanceParticles::processGenericBlocks(Box3D domain, st
     dynamic_cast<HemoCellParticleField*>(blocks[0])->advanceParticles();
 }
 void HemoCellFields::advanceParticles() {
-  global.statistics.getCurrent()["advanceParticles"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("advanceParticles")].start();
     
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -515,7 +515,7 @@ void HemoCellFields::HemoSpreadParticleForce::processGenericBlocks(Box3D domain,
     dynamic_cast<HemoCellParticleField*>(blocks[0])->spreadParticleForce(domain);
 }
 void HemoCellFields::spreadParticleForce() {
-  global.statistics.getCurrent()["spreadParticleForce"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("spreadParticleForce")].start();
 
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -524,11 +524,26 @@ void HemoCellFields::spreadParticleForce() {
   global.statistics.getCurrent().stop();
 }
 
+void HemoCellFields::HemoResetSpreadForce::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
+    dynamic_cast<HemoCellParticleField*>(blocks[0])->resetSpreadForce(bodyForce);
+}
+void HemoCellFields::resetSpreadForce(const hemo::Array<T,3> & bodyForce) {
+  global.statistics.getCurrent()[HEMO_TIMER("resetSpreadForce")].start();
+
+  vector<MultiBlock3D*> wrapper;
+  wrapper.push_back(immersedParticles);
+  HemoResetSpreadForce * fnct = new HemoResetSpreadForce();
+  fnct->bodyForce = bodyForce;
+  applyProcessingFunctional(fnct,immersedParticles->getBoundingBox(),wrapper);
+
+  global.statistics.getCurrent().stop();
+}
+
 void HemoCellFields::HemoApplyConstitutiveModel::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
     dynamic_cast<HemoCellParticleField*>(blocks[0])->applyConstitutiveModel(forced);
 }
 void HemoCellFields::applyConstitutiveModel(bool forced) {
-  global.statistics.getCurrent()["applyConstitutiveModel"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("applyConstitutiveModel")].start();
 
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -543,7 +558,7 @@ void HemoCellFields::HemoUnifyForceVectors::processGenericBlocks(Box3D domain, s
     dynamic_cast<HemoCellParticleField*>(blocks[0])->unifyForceVectors();
 }
 void HemoCellFields::unify_force_vectors() {
-  global.statistics.getCurrent()["unifyForceVectors"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("unifyForceVectors")].start();
 
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -556,7 +571,7 @@ void HemoCellFields::HemoRepulsionForce::processGenericBlocks(Box3D domain, std:
     dynamic_cast<HemoCellParticleField*>(blocks[0])->applyRepulsionForce();
 }
 void HemoCellFields::applyRepulsionForce() {
-  global.statistics.getCurrent()["repulsionForce"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("repulsionForce")].start();
 
   vector<MultiBlock3D*>wrapper;
   wrapper.push_back(immersedParticles);
@@ -570,7 +585,7 @@ void HemoCellFields::HemoBoundaryRepulsionForce::processGenericBlocks(Box3D doma
     dynamic_cast<HemoCellParticleField*>(blocks[0])->applyBoundaryRepulsionForce();
 }
 void HemoCellFields::applyBoundaryRepulsionForce() {
-  global.statistics.getCurrent()["boundaryRepulsionForce"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("boundaryRepulsionForce")].start();
 
   vector<MultiBlock3D*>wrapper;
   wrapper.push_back(immersedParticles);
@@ -596,6 +611,8 @@ void HemoCellFields::HemoPopulateBindingSites::processGenericBlocks(Box3D domain
 void HemoCellFields::populateBindingSites(plb::Box3D * box) {
   //Initialize bindingField before entering functional
   bindingFieldHelper::get(*this);
+  //Boundaries might have been defined after the cellfields were initialized
+  updateBoundaryMasks();
   
   vector<MultiBlock3D*>wrapper;
   wrapper.push_back(immersedParticles);
@@ -612,7 +629,7 @@ void HemoCellFields::HemoupdateResidenceTime::processGenericBlocks(Box3D domain,
     dynamic_cast<HemoCellParticleField*>(blocks[0])->updateResidenceTime(rtime);
 }
 void HemoCellFields::updateResidenceTime(unsigned int rtime) {
-    global.statistics.getCurrent()["updateResidenceTime"].start();
+    global.statistics.getCurrent()[HEMO_TIMER("updateResidenceTime")].start();
     vector<MultiBlock3D*>wrapper;
     wrapper.push_back(immersedParticles);
     HemoupdateResidenceTime * fnct = new HemoupdateResidenceTime();
@@ -620,12 +637,24 @@ void HemoCellFields::updateResidenceTime(unsigned int rtime) {
     applyProcessingFunctional(fnct,immersedParticles->getBoundingBox(),wrapper);
     global.statistics.getCurrent().stop();
 }
+void HemoCellFields::HemoReorderParticles::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
+    dynamic_cast<HemoCellParticleField*>(blocks[0])->reorderParticles(byCell);
+}
+void HemoCellFields::reorderParticles() {
+    global.statistics.getCurrent()[HEMO_TIMER("reorderParticles")].start();
+    vector<MultiBlock3D*>wrapper;
+    wrapper.push_back(immersedParticles);
+    HemoReorderParticles * fnct = new HemoReorderParticles();
+    fnct->byCell = particleReorderByCell;
+    applyProcessingFunctional(fnct,immersedParticles->getBoundingBox(),wrapper);
+    global.statistics.getCurrent().stop();
+}
 
 void HemoCellFields::HemoSeperateForceVectors::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
     dynamic_cast<HemoCellParticleField*>(blocks[0])->separateForceVectors();
 }
 void HemoCellFields::separate_force_vectors() {
-  global.statistics.getCurrent()["separateForceVectors"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("separateForceVectors")].start();
 
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -637,7 +666,7 @@ void HemoCellFields::HemoDeleteIncompleteCells::processGenericBlocks(Box3D domai
     dynamic_cast<HemoCellParticleField*>(blocks[0])->deleteIncompleteCells(verbose);
 }
 void HemoCellFields::deleteIncompleteCells(bool verbose) {
-  global.statistics.getCurrent()["deleteIncompleteCells"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("deleteIncompleteCells")].start();
 
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -678,7 +707,7 @@ void HemoCellFields::HemoDeleteNonLocalParticles::processGenericBlocks(Box3D dom
   pf->removeParticles_inverse(pf->localDomain.enlarge(envelopeSize));
 }
 void HemoCellFields::deleteNonLocalParticles(int envelope) {
-  global.statistics.getCurrent()["deleteNonLocalParticles"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("deleteNonLocalParticles")].start();
 
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(immersedParticles);
@@ -712,6 +741,7 @@ HemoCellFields::HemoFindInternalParticleGridPoints *  HemoCellFields::HemoFindIn
 HemoCellFields::HemoSeperateForceVectors * HemoCellFields::HemoSeperateForceVectors::clone() const { return new HemoCellFields::HemoSeperateForceVectors(*this);}
 HemoCellFields::HemoUnifyForceVectors *    HemoCellFields::HemoUnifyForceVectors::clone() const    { return new HemoCellFields::HemoUnifyForceVectors(*this);}
 HemoCellFields::HemoSpreadParticleForce *  HemoCellFields::HemoSpreadParticleForce::clone() const { return new HemoCellFields::HemoSpreadParticleForce(*this);}
+HemoCellFields::HemoResetSpreadForce *  HemoCellFields::HemoResetSpreadForce::clone() const { return new HemoCellFields::HemoResetSpreadForce(*this);}
 HemoCellFields::HemoInterpolateFluidVelocity * HemoCellFields::HemoInterpolateFluidVelocity::clone() const { return new HemoCellFields::HemoInterpolateFluidVelocity(*this);}
 HemoCellFields::HemoAdvanceParticles *     HemoCellFields::HemoAdvanceParticles::clone() const { return new HemoCellFields::HemoAdvanceParticles(*this);}
 HemoCellFields::HemoApplyConstitutiveModel * HemoCellFields::HemoApplyConstitutiveModel::clone() const { return new HemoCellFields::HemoApplyConstitutiveModel(*this);}
@@ -727,6 +757,7 @@ HemoCellFields::HemoSolidifyCells *        HemoCellFields::HemoSolidifyCells::cl
 HemoCellFields::HemoPrepareSolidification *        HemoCellFields::HemoPrepareSolidification::clone() const { return new HemoCellFields::HemoPrepareSolidification(*this);}
 HemoCellFields::HemoPopulateBindingSites * HemoCellFields::HemoPopulateBindingSites::clone() const { return new HemoCellFields::HemoPopulateBindingSites(*this);}
 HemoCellFields::HemoupdateResidenceTime * HemoCellFields::HemoupdateResidenceTime::clone() const { return new HemoCellFields::HemoupdateResidenceTime(*this);}
+HemoCellFields::HemoReorderParticles * HemoCellFields::HemoReorderParticles::clone() const { return new HemoCellFields::HemoReorderParticles(*this);}
 
 
 void HemoCellFields::HemoSyncEnvelopes::getTypeOfModification(std::vector<modif::ModifT>& modified) const {
@@ -111,8 +111,14 @@ public:
   ///Interpolate the velocity of the fluid to the individual particles
   void interpolateFluidVelocity();
   
+  ///Rebuild the boundary masks of the particle fields, needed after the dynamics of the lattice changed
+  void updateBoundaryMasks();
+
   ///Spread the force of all particles over the fluid in this iteration
   void spreadParticleForce();
+
+  ///Reset the fluid force to bodyForce on the nodes written by spreadParticleForce()
+  void resetSpreadForce(const hemo::Array<T,3> & bodyForce);
   
   /// Separate the force vectors of particles so it becomes clear what the vector for each separate force is
   void separate_force_vectors();
@@ -156,6 +162,9 @@ public:
 
   /// increment cell residence time
   void updateResidenceTime(unsigned int rtime);
+
+  /// Sort the particles of every block for memory locality, see HemoCellParticleField::reorderParticles
+  void reorderParticles();
   
   //Class Variables
   
@@ -200,6 +209,10 @@ public:
   
   pluint interiorViscosityTimescale = 1;
   pluint interiorViscosityEntireGridTimescale = 1;
+
+  ///Interval of the particle reordering (0 is off) and whether to order on cell instead of position, set through hemocell.h
+  pluint particleReorderTimescale = 0;
+  bool particleReorderByCell = false;
   
   ///Limit of cycles in a direction (xyz)
   int periodicity_limit[3] = {100};
@@ -241,6 +254,12 @@ public:
    void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
    HemoSpreadParticleForce * clone() const;
   }; 
+  class HemoResetSpreadForce: public HemoCellFunctional {
+   void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
+   HemoResetSpreadForce * clone() const;
+  public:
+   hemo::Array<T,3> bodyForce = {0.,0.,0.};
+  };
   class HemoFindInternalParticleGridPoints: public HemoCellFunctional {
    void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
    HemoFindInternalParticleGridPoints * clone() const;
@@ -328,6 +347,12 @@ public:
   public:
     unsigned int rtime;
   };
+  class HemoReorderParticles: public HemoCellFunctional {
+    void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
+    HemoReorderParticles * clone() const;
+  public:
+    bool byCell = false;
+  };
 };
 }
 #endif
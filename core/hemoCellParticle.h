@@ -29,6 +29,7 @@ namespace hemo {
 #include "helper/array.h"
 #include "core/cell.hh"
 
+#include <cmath>
 #include <cstdint> 
 
 #ifndef PARTICLE_ID
@@ -41,10 +42,23 @@ class HemoCellParticle {
 public:
 
   //VARIABLES
+#ifdef HEMOCELL_MIXED_PRECISION
+  typedef float Tstored;
+#else
+  typedef T Tstored;
+#endif
+
   //Store variables in struct for fast serialization
+  //In the mixed precision build the position and velocity are stored in
+  //single precision, the position relative to the lattice location of the
+  //block the particle is in. Always read and write them with the accessors,
+  //which work with absolute double precision values. Forces stay double.
   struct serializeValues_t {
-    hemo::Array<T,3> v;
-    hemo::Array<T,3> position;
+    hemo::Array<Tstored,3> storedVelocity;
+    hemo::Array<Tstored,3> storedPosition;
+#ifdef HEMOCELL_MIXED_PRECISION
+    hemo::Array<int32_t,3> origin;
+#endif
     hemo::Array<T,3> force;
     hemo::Array<T,3> force_repulsion;
 #if HEMOCELL_MATERIAL_INTEGRATION == 2
@@ -60,20 +74,74 @@ public:
 #ifdef SOLIDIFY_MECHANICS
     bool solidify;
 #endif
+
+    inline hemo::Array<T,3> getPosition() const {
+#ifdef HEMOCELL_MIXED_PRECISION
+      return {origin[0] + T(storedPosition[0]), origin[1] + T(storedPosition[1]), origin[2] + T(storedPosition[2])};
+#else
+      return storedPosition;
+#endif
+    }
+    inline void setPosition(const hemo::Array<T,3> & position) {
+#ifdef HEMOCELL_MIXED_PRECISION
+      for (unsigned int i = 0; i < 3; i++) {
+        storedPosition[i] = position[i] - origin[i];
+      }
+#else
+      storedPosition = position;
+#endif
+    }
+    /// Moves the position, a whole number of lattice units is added to the
+    /// origin so periodic shifts are exact in single precision as well
+    inline void shiftPosition(const hemo::Array<T,3> & offset) {
+#ifdef HEMOCELL_MIXED_PRECISION
+      for (unsigned int i = 0; i < 3; i++) {
+        const T whole = std::floor(offset[i] + 0.5);
+        origin[i] += int32_t(whole);
+        storedPosition[i] = storedPosition[i] + (offset[i] - whole);
+      }
+#else
+      storedPosition += offset;
+#endif
+    }
+    /// Stores the position relative to a new origin, used when the particle
+    /// is added to a block. Does nothing in the double precision build.
+    inline void setOrigin(const plb::Dot3D & location) {
+#ifdef HEMOCELL_MIXED_PRECISION
+      const hemo::Array<int32_t,3> newOrigin = {int32_t(location.x), int32_t(location.y), int32_t(location.z)};
+      for (unsigned int i = 0; i < 3; i++) {
+        storedPosition[i] = T(origin[i] - newOrigin[i]) + T(storedPosition[i]);
+      }
+      origin = newOrigin;
+#else
+      (void)location;
+#endif
+    }
+    inline hemo::Array<T,3> getVelocity() const {
+      return {T(storedVelocity[0]), T(storedVelocity[1]), T(storedVelocity[2])};
+    }
+    inline void setVelocity(const hemo::Array<T,3> & velocity) {
+      for (unsigned int i = 0; i < 3; i++) {
+        storedVelocity[i] = velocity[i];
+      }
+    }
   };
-  
+
   serializeValues_t sv;
 
   hemo::Array<T,3> force_total;
   plint tag;
+  // Nodes of the interpolation kernel, only the first kernelSize are used.
+  // The widest kernels (phi4, phi4c) cover 4x4x4 nodes.
+  static const unsigned int maxKernelSize = 64;
+  unsigned int kernelSize = 0;
   #ifdef INTERIOR_VISCOSITY
   hemo::Array<T,3> normalDirection;
-  //Is vector, optimize with hemo::Array possible
-  std::vector<hemo::Array<plint, 3>> kernelCoordinates;
+  hemo::Array<hemo::Array<plint, 3>, maxKernelSize> kernelCoordinates;
   #endif
 
-  std::vector<plb::Cell<T,DESCRIPTOR>*> kernelLocations;
-  std::vector<T>         kernelWeights;
+  hemo::Array<plb::Cell<T,DESCRIPTOR>*, maxKernelSize> kernelLocations;
+  hemo::Array<T, maxKernelSize> kernelWeights;
 
   hemo::Array<T,3> *force_volume = &sv.force;
   hemo::Array<T,3> *force_bending = &sv.force;
@@ -89,11 +157,12 @@ public:
     sv = copy.sv;
     force_total = copy.force_total;
     tag = copy.tag;
-    kernelLocations = copy.kernelLocations;
-    kernelWeights = copy.kernelWeights;
+    kernelSize = copy.kernelSize;
+    std::copy(copy.kernelLocations.begin(), copy.kernelLocations.begin() + kernelSize, kernelLocations.begin());
+    std::copy(copy.kernelWeights.begin(), copy.kernelWeights.begin() + kernelSize, kernelWeights.begin());
     #ifdef INTERIOR_VISCOSITY
     normalDirection = copy.normalDirection;
-    kernelCoordinates = copy.kernelCoordinates;
+    std::copy(copy.kernelCoordinates.begin(), copy.kernelCoordinates.begin() + kernelSize, kernelCoordinates.begin());
     #endif
     
     if (!(&copy.sv.force == copy.force_volume)) {
@@ -107,8 +176,12 @@ public:
   }
   
   HemoCellParticle (hemo::Array<T,3> position_, plint cellId_, plint vertexId_,pluint celltype_) {
-    sv.v = {0.,0.,0.};
-    sv.position = position_;
+#ifdef HEMOCELL_MIXED_PRECISION
+    //Close to the position until the particle is added to a block
+    sv.origin = {int32_t(std::floor(position_[0])), int32_t(std::floor(position_[1])), int32_t(std::floor(position_[2]))};
+#endif
+    sv.setVelocity({0.,0.,0.});
+    sv.setPosition(position_);
     sv.force = {0.,0.,0.};
     sv.force_repulsion = {0.,0.,0.};
     sv.cellId = cellId_;
@@ -138,11 +211,12 @@ public:
 
   HemoCellParticle & operator =(const HemoCellParticle & copy) {
     sv = copy.sv;
-    kernelLocations = copy.kernelLocations;
-    kernelWeights = copy.kernelWeights;
+    kernelSize = copy.kernelSize;
+    std::copy(copy.kernelLocations.begin(), copy.kernelLocations.begin() + kernelSize, kernelLocations.begin());
+    std::copy(copy.kernelWeights.begin(), copy.kernelWeights.begin() + kernelSize, kernelWeights.begin());
     #ifdef INTERIOR_VISCOSITY
     normalDirection = copy.normalDirection;
-    kernelCoordinates = copy.kernelCoordinates;
+    std::copy(copy.kernelCoordinates.begin(), copy.kernelCoordinates.begin() + kernelSize, kernelCoordinates.begin());
     #endif
     
     if (&copy.sv.force == copy.force_volume) {
@@ -192,12 +266,13 @@ public:
          *  2: Adams-Bashforth
          */
         #if HEMOCELL_MATERIAL_INTEGRATION == 1
-              sv.position += sv.v;
+              sv.setPosition(sv.getPosition() + sv.getVelocity());
 
         #elif HEMOCELL_MATERIAL_INTEGRATION == 2
-              hemo::Array<T,3> dxyz = (1.5*v - 0.5*vPrevious);
-              position +=  dxyz;
-              vPrevious = v;  // Store velocity
+              const hemo::Array<T,3> v = sv.getVelocity();
+              hemo::Array<T,3> dxyz = (1.5*v - 0.5*sv.vPrevious);
+              sv.setPosition(sv.getPosition() + dxyz);
+              sv.vPrevious = v;  // Store velocity
         #endif
         //v = {0.0,0.0,0.0};
     }
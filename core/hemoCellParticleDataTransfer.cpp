@@ -66,6 +66,28 @@ plint HemoCellParticleDataTransfer::getOffset(Dot3D const &absoluteOffset)
 
 HemoCellParticleDataTransfer::HemoCellParticleDataTransfer(){};
 
+/* A particle crossing the sheared z boundary of a Lees-Edwards domain is
+ * displaced along x by the current displacement and jumps to the velocity of
+ * the opposite wall. Returns the velocity jump along x.
+ */
+T HemoCellParticleDataTransfer::addLeesEdwardsShift(Dot3D const &absoluteOffset, hemo::Array<T, 3> &realAbsoluteOffset)
+{
+  HemoCell & hemocell = particleField->cellFields->hemocell;
+  if (!hemocell.leesEdwardsBC) {
+    return 0.;
+  }
+  plint nZ = hemocell.lattice->getNz();
+  if (absoluteOffset.z == -nZ) {
+    realAbsoluteOffset[0] += *hemocell.LEcurrentDisplacement;
+    return hemocell.LEvelocityShift;
+  }
+  if (absoluteOffset.z == nZ) {
+    realAbsoluteOffset[0] -= *hemocell.LEcurrentDisplacement;
+    return -hemocell.LEvelocityShift;
+  }
+  return 0.;
+}
+
 plint HemoCellParticleDataTransfer::staticCellSize() const
 {
   return 0; // Particle containers have only dynamic data.
@@ -74,7 +96,7 @@ plint HemoCellParticleDataTransfer::staticCellSize() const
 void HemoCellParticleDataTransfer::send(
     Box3D domain, std::vector<char> &buffer, modif::ModifT kind) const
 {
-  global.statistics.getCurrent()["MpiSend"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiSend")].start();
   buffer.clear();
   std::vector<NoInitChar> *bufferNoInit = reinterpret_cast<std::vector<NoInitChar> *>(&buffer);
 
@@ -93,13 +115,14 @@ void HemoCellParticleDataTransfer::send(
       offset += sizeof(HemoCellParticle::serializeValues_t);
     }
   }
+  particleField->bytesSent += buffer.size();
   global.statistics.getCurrent().stop();
 }
 
 void HemoCellParticleDataTransfer::send_preinlet(
         Box3D domain, std::vector<char>& buffer, modif::ModifT kind ) const
 {
-  global.statistics.getCurrent()["MpiSend"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiSend")].start();
     buffer.clear();
     std::vector<NoInitChar> * bufferNoInit = reinterpret_cast<std::vector<NoInitChar>*>(&buffer);
     
@@ -118,12 +141,14 @@ void HemoCellParticleDataTransfer::send_preinlet(
           iParticle->sv.restime =0;
         }
     }
+  particleField->bytesSent += buffer.size();
   global.statistics.getCurrent().stop();
 }
 
 void HemoCellParticleDataTransfer::receive(Box3D domain, std::vector<NoInitChar> const &buffer)
 {
-  global.statistics.getCurrent()["MpiReceive"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiReceive")].start();
+  particleField->bytesReceived += buffer.size();
   unsigned int posInBuffer = 0;
   unsigned int size = buffer.size();
   HemoCellParticle::serializeValues_t *newParticle;
@@ -145,10 +170,12 @@ void HemoCellParticleDataTransfer::receive(Box3D domain, std::vector<NoInitChar>
     return;
   }
 
-  global.statistics.getCurrent()["MpiReceive"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiReceive")].start();
+  particleField->bytesReceived += buffer.size();
 
   int offset = getOffset(absoluteOffset);
   hemo::Array<T, 3> realAbsoluteOffset({(T)absoluteOffset.x, (T)absoluteOffset.y, (T)absoluteOffset.z});
+  T velocityShift = addLeesEdwardsShift(absoluteOffset, realAbsoluteOffset);
   unsigned int posInBuffer = 0;
   unsigned int size = buffer.size();
   HemoCellParticle::serializeValues_t *newParticle;
@@ -159,7 +186,11 @@ void HemoCellParticleDataTransfer::receive(Box3D domain, std::vector<NoInitChar>
     newParticle = (HemoCellParticle::serializeValues_t *)&buffer[posInBuffer];
     posInBuffer += sizeof(HemoCellParticle::serializeValues_t);
     //Edit in buffer, but it is not used again anyway
-    newParticle->position += realAbsoluteOffset;
+    newParticle->shiftPosition(realAbsoluteOffset);
+    newParticle->storedVelocity[0] += velocityShift;
+#if HEMOCELL_MATERIAL_INTEGRATION == 2
+    newParticle->vPrevious[0] += velocityShift;
+#endif
 
     //Check for overflows
     if (((offset < 0) && (newParticle->cellId < INT_MIN - offset)) ||
@@ -181,7 +212,8 @@ void HemoCellParticleDataTransfer::receive(Box3D domain, std::vector<NoInitChar>
 
 void HemoCellParticleDataTransfer::receive(char *buffer, unsigned int size, modif::ModifT kind)
 {
-  global.statistics.getCurrent()["MpiReceive"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiReceive")].start();
+  particleField->bytesReceived += size;
 
   if ((kind == modif::hemocell || kind == modif::dataStructure))
   {
@@ -207,7 +239,8 @@ void HemoCellParticleDataTransfer::receive(Box3D const &domain, char *buffer, un
   // Particles, by definition, are dynamic data, and they need to
   //   be reconstructed in any case. Therefore, the receive procedure
   //   is run whenever kind is one of the dynamic types.
-  global.statistics.getCurrent()["MpiReceive"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiReceive")].start();
+  particleField->bytesReceived += size;
 
   if ((kind == modif::hemocell || kind == modif::dataStructure))
   {
@@ -228,7 +261,8 @@ void HemoCellParticleDataTransfer::receive(Box3D const &domain, char *buffer, un
 
 void HemoCellParticleDataTransfer::receivePreInlet(char *buffer, unsigned int size, modif::ModifT kind, Dot3D absoluteOffset)
 {
-  global.statistics.getCurrent()["MpiReceivePreInlet"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiReceivePreInlet")].start();
+  particleField->bytesReceived += size;
   //const map<int,bool> & lpc = particleField->get_lpc();
 
   if ((kind == modif::hemocell || kind == modif::dataStructure))
@@ -245,7 +279,7 @@ void HemoCellParticleDataTransfer::receivePreInlet(char *buffer, unsigned int si
       newParticle = (HemoCellParticle::serializeValues_t *)&buffer[posInBuffer];
       posInBuffer += sizeof(HemoCellParticle::serializeValues_t);
       //Edit in buffer, but it is not used again anyway
-      newParticle->position += realAbsoluteOffset;
+      newParticle->shiftPosition(realAbsoluteOffset);
       //Check for overflows
       if (((offset < 0) && (newParticle->cellId < INT_MIN - offset)) ||
           ((offset > 0) && (newParticle->cellId > INT_MAX - offset)))
@@ -274,12 +308,14 @@ void HemoCellParticleDataTransfer::receive(char *buffer, unsigned int size, modi
     return;
   }
 
-  global.statistics.getCurrent()["MpiReceive"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiReceive")].start();
+  particleField->bytesReceived += size;
 
   if ((kind == modif::hemocell || kind == modif::dataStructure))
   {
     int offset = getOffset(absoluteOffset);
     hemo::Array<T, 3> realAbsoluteOffset({(T)absoluteOffset.x, (T)absoluteOffset.y, (T)absoluteOffset.z});
+    T velocityShift = addLeesEdwardsShift(absoluteOffset, realAbsoluteOffset);
     unsigned int posInBuffer = 0;
 
     HemoCellParticle::serializeValues_t *newParticle;
@@ -290,7 +326,11 @@ void HemoCellParticleDataTransfer::receive(char *buffer, unsigned int size, modi
       newParticle = (HemoCellParticle::serializeValues_t *)&buffer[posInBuffer];
       posInBuffer += sizeof(HemoCellParticle::serializeValues_t);
       //Edit in buffer, but it is not used again anyway
-      newParticle->position += realAbsoluteOffset;
+      newParticle->shiftPosition(realAbsoluteOffset);
+      newParticle->storedVelocity[0] += velocityShift;
+#if HEMOCELL_MATERIAL_INTEGRATION == 2
+      newParticle->vPrevious[0] += velocityShift;
+#endif
       //Check for overflows
       if (((offset < 0) && (newParticle->cellId < INT_MIN - offset)) ||
           ((offset > 0) && (newParticle->cellId > INT_MAX - offset)))
@@ -316,12 +356,14 @@ void HemoCellParticleDataTransfer::receive(Box3D const &domain, char *buffer, un
     return;
   }
 
-  global.statistics.getCurrent()["MpiReceive"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("MpiReceive")].start();
+  particleField->bytesReceived += size;
 
   if ((kind == modif::hemocell || kind == modif::dataStructure))
   {
     int offset = getOffset(absoluteOffset);
     hemo::Array<T, 3> realAbsoluteOffset({(T)absoluteOffset.x, (T)absoluteOffset.y, (T)absoluteOffset.z});
+    T velocityShift = addLeesEdwardsShift(absoluteOffset, realAbsoluteOffset);
     unsigned int posInBuffer = 0;
 
     HemoCellParticle::serializeValues_t *newParticle;
@@ -332,7 +374,11 @@ void HemoCellParticleDataTransfer::receive(Box3D const &domain, char *buffer, un
       newParticle = (HemoCellParticle::serializeValues_t *)&buffer[posInBuffer];
       posInBuffer += sizeof(HemoCellParticle::serializeValues_t);
       //Edit in buffer, but it is not used again anyway
-      newParticle->position += realAbsoluteOffset;
+      newParticle->shiftPosition(realAbsoluteOffset);
+      newParticle->storedVelocity[0] += velocityShift;
+#if HEMOCELL_MATERIAL_INTEGRATION == 2
+      newParticle->vPrevious[0] += velocityShift;
+#endif
       //Check for overflows
       if (((offset < 0) && (newParticle->cellId < INT_MIN - offset)) ||
           ((offset > 0) && (newParticle->cellId > INT_MAX - offset)))
@@ -380,7 +426,7 @@ void HemoCellParticleDataTransfer::attribute(
     Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
     AtomicBlock3D const &from, modif::ModifT kind)
 {
-  global.statistics.getCurrent()["LocalCommunication"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("LocalCommunication")].start();
 
   if ((kind == modif::hemocell || kind == modif::dataStructure))
   {
@@ -415,7 +461,7 @@ void HemoCellParticleDataTransfer::attribute(
     return;
   }
 
-  global.statistics.getCurrent()["LocalCommunication"].start();
+  global.statistics.getCurrent()[HEMO_TIMER("LocalCommunication")].start();
 
   if ((kind == modif::hemocell || kind == modif::dataStructure))
   {
@@ -426,15 +472,7 @@ void HemoCellParticleDataTransfer::attribute(
     //fromParticleField.findParticles(fromDomain, particles);
     int offset = getOffset(absoluteOffset);
     hemo::Array<T, 3> realAbsoluteOffset({(T)absoluteOffset.x, (T)absoluteOffset.y, (T)absoluteOffset.z});
-    plint nZ = this->particleField->cellFields->hemocell.lattice->getNz();
-    if (this->particleField->cellFields->hemocell.leesEdwardsBC) {
-      if (absoluteOffset.z == -nZ) {
-        realAbsoluteOffset[0] += *this->particleField->cellFields->hemocell.LEcurrentDisplacement;
-      }
-      if (absoluteOffset.z == nZ) {
-        realAbsoluteOffset[0] -= *this->particleField->cellFields->hemocell.LEcurrentDisplacement;
-      }
-    }
+    T velocityShift = addLeesEdwardsShift(absoluteOffset, realAbsoluteOffset);
     //Calling addParticle on self can invalidate particles pointer array on realloc from vector
     //Do for every local communication to accomodate overcoupling particle field in the future.
     vector<HemoCellParticle::serializeValues_t> sv_values;
@@ -442,7 +480,11 @@ void HemoCellParticleDataTransfer::attribute(
     for (const HemoCellParticle &particle : fromParticleField.particles)
     {
       sv_values.emplace_back(particle.sv);
-      sv_values.back().position += realAbsoluteOffset;
+      sv_values.back().shiftPosition(realAbsoluteOffset);
+      sv_values.back().storedVelocity[0] += velocityShift;
+#if HEMOCELL_MATERIAL_INTEGRATION == 2
+      sv_values.back().vPrevious[0] += velocityShift;
+#endif
 
       //Check for overflows
       if (((offset < 0) && (sv_values.back().cellId < INT_MIN - offset)) ||
@@ -67,6 +67,7 @@ public:
     virtual void attribute(Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
                            AtomicBlock3D const& from, modif::ModifT kind, Dot3D absoluteOffset);
     plint getOffset(Dot3D const&);
+    T addLeesEdwardsShift(Dot3D const&, hemo::Array<T,3> &);
 private:
     HemoCellParticleField* particleField;
     HemoCellParticleField const * constParticleField;
@@ -24,14 +24,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "hemoCellParticleField.h"
 #include "hemocell.h"
-#include "octree.h"
-#include "mollerTrumbore.h"
+#include "cellBVH.h"
 #include "bindingField.h"
 #include "interiorViscosity.h"
-#pragma GCC diagnostic push 
-#pragma GCC diagnostic ignored "-Wint-in-bool-context"
-#include <Eigen3/Eigenvalues>
-#pragma GCC diagnostic pop
 
 namespace hemo { 
 /* *************** class HemoParticleField3D ********************** */
@@ -107,10 +102,15 @@ const map<int,bool> & HemoCellParticleField::get_lpc() {
     if (!lpc_up_to_date) { update_lpc(); }
     return _lpc;
   }
+vector<unsigned int> HemoCellParticleField::get_particles_on_node(int x, int y, int z) {
+    if (!pg_up_to_date) { update_pg(); }
+    const unsigned int index = grid_index(x,y,z);
+    return vector<unsigned int>(&particle_grid[index][0], &particle_grid[index][0] + particle_grid_size[index]);
+  }
 void HemoCellParticleField::update_lpc() {
   _lpc.clear();
   for (const HemoCellParticle & particle : particles) {
-     if (isContainedABS(particle.sv.position, localDomain)) {
+     if (isContainedABS(particle.sv.getPosition(), localDomain)) {
        _lpc[particle.sv.cellId] = true;
      }
   }
@@ -148,13 +148,12 @@ void HemoCellParticleField::update_pg() {
   
   memset(particle_grid_size,0,sizeof(unsigned int)*this->atomicLattice->getNx()*this->atomicLattice->getNy()*this->atomicLattice->getNz());
   Dot3D const& location = this->atomicLattice->getLocation();
-  hemo::Array<T,3> * pos;
   
   for (unsigned int i = 0 ; i <  particles.size() ; i++) {
-    pos = &particles[i].sv.position;
-    int x = pos->operator[](0)-location.x+0.5;
-    int y = pos->operator[](1)-location.y+0.5;
-    int z = pos->operator[](2)-location.z+0.5;
+    const hemo::Array<T,3> pos = particles[i].sv.getPosition();
+    int x = pos[0]-location.x+0.5;
+    int y = pos[1]-location.y+0.5;
+    int z = pos[2]-location.z+0.5;
     if ((x >= 0) && (x < this->atomicLattice->getNx()) &&
 	(y >= 0) && (y < this->atomicLattice->getNy()) &&
 	(z >= 0) && (z < this->atomicLattice->getNz()) ) 
@@ -172,7 +171,7 @@ void HemoCellParticleField::addParticle(HemoCellParticle* particle) {
 }  
 void HemoCellParticleField::addParticle(const HemoCellParticle::serializeValues_t & sv) {
   HemoCellParticle * local_sparticle, * particle;
-  const hemo::Array<T,3> & pos = sv.position;
+  const hemo::Array<T,3> pos = sv.getPosition();
   const map<int,vector<int>> & particles_per_cell = get_particles_per_cell();
 
   if( this->isContainedABS(pos, this->getBoundingBox()) )
@@ -184,11 +183,12 @@ void HemoCellParticleField::addParticle(const HemoCellParticle::serializeValues_
         local_sparticle =  &particles[particles_per_cell.at(sv.cellId)[sv.vertexId]];
 
         //If our particle is local, do not replace it, envelopes are less important
-        if (isContainedABS(local_sparticle->sv.position, localDomain)) {
+        if (isContainedABS(local_sparticle->sv.getPosition(), localDomain)) {
           return;
         } else {
           //We have the particle already, replace it
           local_sparticle->sv = sv;
+          local_sparticle->sv.setOrigin(this->atomicLattice->getLocation());
           particle = local_sparticle;
           particle->setTag(-1);
 
@@ -205,6 +205,7 @@ outer_else:
       //new entry
       particles.emplace_back(sv);
       particle = &particles.back();
+      particle->sv.setOrigin(this->atomicLattice->getLocation());
       
       //invalidate ppt
       ppt_up_to_date=false;
@@ -217,7 +218,7 @@ outer_else:
       
       if (pg_up_to_date) {
         Dot3D const& location = this->atomicLattice->getLocation();
-        hemo::Array<T,3>  & pos = particle->sv.position;
+        const hemo::Array<T,3> pos = particle->sv.getPosition();
         int x = pos[0]-location.x+0.5;
         int y = pos[1]-location.y+0.5;
         int z = pos[2]-location.z+0.5;
@@ -236,7 +237,7 @@ outer_else:
 
 void HemoCellParticleField::addParticlePreinlet(const HemoCellParticle::serializeValues_t & sv) {
   HemoCellParticle * local_sparticle, * particle;
-  const hemo::Array<T,3> & pos = sv.position;
+  const hemo::Array<T,3> pos = sv.getPosition();
   const map<int,vector<int>> & particles_per_cell = get_particles_per_cell();
 
   if( this->isContainedABS(pos, this->getBoundingBox()) )
@@ -254,6 +255,7 @@ outer_else:
       //new entry
       particles.emplace_back(sv);
       particle = &particles.back();
+      particle->sv.setOrigin(this->atomicLattice->getLocation());
       
       //invalidate ppt
       ppt_up_to_date=false;
@@ -266,7 +268,7 @@ outer_else:
       
       if (pg_up_to_date) {
         Dot3D const& location = this->atomicLattice->getLocation();
-        hemo::Array<T,3>  & pos = particle->sv.position;
+        const hemo::Array<T,3> pos = particle->sv.getPosition();
         int x = pos[0]-location.x+0.5;
         int y = pos[1]-location.y+0.5;
         int z = pos[2]-location.z+0.5;
@@ -328,7 +330,7 @@ void HemoCellParticleField::removeParticles(Box3D domain, plint tag) {
 
   const unsigned int old_size = particles.size();
   for (unsigned int i = 0 ; i < particles.size() ; i++) {
-    if (particles[i].getTag() == tag && this->isContainedABS(particles[i].sv.position,finalDomain)) {
+    if (particles[i].getTag() == tag && this->isContainedABS(particles[i].sv.getPosition(),finalDomain)) {
       particles[i] = particles.back();
       particles.pop_back();
       i--;
@@ -351,7 +353,7 @@ void HemoCellParticleField::removeParticles(Box3D domain) {
 
   const unsigned int old_size = particles.size();
   for (unsigned int i = 0 ; i < particles.size() ; i++) {
-    if (this->isContainedABS(particles[i].sv.position,finalDomain)) {
+    if (this->isContainedABS(particles[i].sv.getPosition(),finalDomain)) {
       particles[i] = particles.back();
       particles.pop_back();
       i--;
@@ -375,7 +377,7 @@ void HemoCellParticleField::removeParticles_inverse(Box3D domain) {
 
   const unsigned int old_size = particles.size();
   for (unsigned int i = 0 ; i < particles.size() ; i++) {
-    if (!this->isContainedABS(particles[i].sv.position,finalDomain)) {
+    if (!this->isContainedABS(particles[i].sv.getPosition(),finalDomain)) {
       particles[i] = particles.back();
       particles.pop_back();
       i--;
@@ -399,7 +401,7 @@ void HemoCellParticleField::findParticles (
     found.clear();
     PLB_ASSERT( contained(domain, this->getBoundingBox()) );
     for (HemoCellParticle & particle : particles) {
-        if (this->isContainedABS(particle.sv.position,domain)) {
+        if (this->isContainedABS(particle.sv.getPosition(),domain)) {
             found.push_back(&particle);
         }
     }
@@ -411,7 +413,7 @@ void HemoCellParticleField::findParticles (
     found.clear();
     PLB_ASSERT( contained(domain, this->getBoundingBox()) );
     for (const HemoCellParticle & particle : particles) {
-        if (this->isContainedABS(particle.sv.position,domain)) {
+        if (this->isContainedABS(particle.sv.getPosition(),domain)) {
             found.push_back(&particle);
         }
     }
@@ -428,7 +430,7 @@ void HemoCellParticleField::findParticles (
       {return;} 
     else {
       for (const unsigned int i : particles_per_type[type]) {
-          if (this->isContainedABS(particles[i].sv.position,domain)) {
+          if (this->isContainedABS(particles[i].sv.getPosition(),domain)) {
               found.push_back(&(particles[i]));
           }
       }
@@ -463,7 +465,7 @@ void HemoCellParticleField::computeGridPosition (
 void HemoCellParticleField::issueWarning(HemoCellParticle & p){
 	cout << "(HemoCell) (Delete Cells) WARNING! Particle deleted from local domain. This means the whole cell will be deleted!" << endl;
         cout << "\t Particle ID:" << p.sv.cellId << endl;
-    cout << "\t Position: " << p.sv.position[0] << ", " << p.sv.position[1] << ", " << p.sv.position[2] << "; vel.: " << p.sv.v[0] << ", " <<  p.sv.v[1] << ", " << p.sv.v[2] << "; force: " << p.sv.force[0] << ", " << p.sv.force[1] << ", " << p.sv.force[2] << endl;
+    cout << "\t Position: " << p.sv.getPosition()[0] << ", " << p.sv.getPosition()[1] << ", " << p.sv.getPosition()[2] << "; vel.: " << p.sv.getVelocity()[0] << ", " <<  p.sv.getVelocity()[1] << ", " << p.sv.getVelocity()[2] << "; force: " << p.sv.force[0] << ", " << p.sv.force[1] << ", " << p.sv.force[2] << endl;
 }
 
 int HemoCellParticleField::deleteIncompleteCells(pluint ctype, bool verbose) {
@@ -490,7 +492,7 @@ int HemoCellParticleField::deleteIncompleteCells(pluint ctype, bool verbose) {
       //issue warning
       if (verbose) {
         if (!warningIssued) {
-          if (isContainedABS(particles[particles_per_cell.at(cellid)[i]].sv.position,localDomain)) {
+          if (isContainedABS(particles[particles_per_cell.at(cellid)[i]].sv.getPosition(),localDomain)) {
                   issueWarning(particles[particles_per_cell.at(cellid)[i]]);
             warningIssued = true;
           }
@@ -532,7 +534,7 @@ int HemoCellParticleField::deleteIncompleteCells(const bool verbose) {
       //issue warning
       if (verbose) {
         if (!warningIssued) {
-          if (isContainedABS(particles[particles_per_cell.at(cellid)[i]].sv.position,localDomain)) {
+          if (isContainedABS(particles[particles_per_cell.at(cellid)[i]].sv.getPosition(),localDomain)) {
                   issueWarning(particles[particles_per_cell.at(cellid)[i]]);
             warningIssued = true;
           }
@@ -569,14 +571,14 @@ void HemoCellParticleField::advanceParticles() {
     //By lack of better place, check if it is on a boundary, if so, delete it
     plb::Box3D const box = atomicLattice->getBoundingBox();
     plb::Dot3D const& location = atomicLattice->getLocation();
-    plint x = (particle.sv.position[0]-location.x)+0.5;
-    plint y = (particle.sv.position[1]-location.y)+0.5;
-    plint z = (particle.sv.position[2]-location.z)+0.5;
+    plint x = (particle.sv.getPosition()[0]-location.x)+0.5;
+    plint y = (particle.sv.getPosition()[1]-location.y)+0.5;
+    plint z = (particle.sv.getPosition()[2]-location.z)+0.5;
 
     if ((x >= box.x0) && (x <= box.x1) &&
 	(y >= box.y0) && (y <= box.y1) &&
 	(z >= box.z0) && (z <= box.z1)) {
-      if (atomicLattice->get(x,y,z).getDynamics().isBoundary()) {
+      if (boundaryMask.isBoundary(x,y,z)) {
         particle.tag = 1;
       }
     }
@@ -620,6 +622,80 @@ void HemoCellParticleField::separateForceVectors() {
   }
 
 
+// Spread the lower 21 bits of v, so two zero bits separate every bit
+static inline uint64_t spreadMortonBits(uint64_t v) {
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffULL;
+  v = (v | v << 16) & 0x1f0000ff0000ffULL;
+  v = (v | v << 8)  & 0x100f00f00f00f00fULL;
+  v = (v | v << 4)  & 0x10c30c30c30c30c3ULL;
+  v = (v | v << 2)  & 0x1249249249249249ULL;
+  return v;
+}
+
+// Swap-and-pop removal and envelope receives leave the particles in arbitrary
+// order, so the kernels jump through lattice and particle memory. After sorting,
+// particles that are close in space (or in the same cell) are close in memory.
+// The per cell, per type and grid indices are remapped, not rebuilt.
+void HemoCellParticleField::reorderParticles(bool byCell) {
+  if (particles.size() < 2) { return; }
+
+  vector<unsigned int> order(particles.size());
+  if (byCell) {
+    for (unsigned int i = 0; i < particles.size(); i++) { order[i] = i; }
+    sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+      const HemoCellParticle::serializeValues_t & l = particles[a].sv;
+      const HemoCellParticle::serializeValues_t & r = particles[b].sv;
+      return l.cellId < r.cellId || (l.cellId == r.cellId && l.vertexId < r.vertexId);
+    });
+  } else {
+    const Dot3D & location = atomicLattice->getLocation();
+    vector<pair<uint64_t,unsigned int>> keys(particles.size());
+    for (unsigned int i = 0; i < particles.size(); i++) {
+      const hemo::Array<T,3> pos = particles[i].sv.getPosition();
+      // Envelope particles can lie just outside of the block
+      const uint64_t x = max(0, int(pos[0]-location.x+0.5));
+      const uint64_t y = max(0, int(pos[1]-location.y+0.5));
+      const uint64_t z = max(0, int(pos[2]-location.z+0.5));
+      keys[i] = {spreadMortonBits(x) << 2 | spreadMortonBits(y) << 1 | spreadMortonBits(z), i};
+    }
+    sort(keys.begin(), keys.end());
+    for (unsigned int i = 0; i < particles.size(); i++) { order[i] = keys[i].second; }
+  }
+
+  vector<unsigned int> newIndex(particles.size());
+  vector<HemoCellParticle> sorted;
+  sorted.reserve(particles.size());
+  for (unsigned int i = 0; i < order.size(); i++) {
+    sorted.push_back(particles[order[i]]);
+    newIndex[order[i]] = i;
+  }
+  particles.swap(sorted);
+
+  if (ppc_up_to_date) {
+    for (auto & pair : _particles_per_cell) {
+      for (int & index : pair.second) {
+        if (index != -1) { index = newIndex[index]; }
+      }
+    }
+  }
+  if (ppt_up_to_date) {
+    for (vector<unsigned int> & ofType : _particles_per_type) {
+      for (unsigned int & index : ofType) { index = newIndex[index]; }
+      sort(ofType.begin(), ofType.end());
+    }
+  }
+  if (pg_up_to_date) {
+    const unsigned int gridSize = atomicLattice->getNx()*atomicLattice->getNy()*atomicLattice->getNz();
+    for (unsigned int node = 0; node < gridSize; node++) {
+      for (unsigned int j = 0; j < particle_grid_size[node]; j++) {
+        particle_grid[node][j] = newIndex[particle_grid[node][j]];
+      }
+    }
+  }
+  preinlet_ppc_up_to_date = false;
+}
+
 void HemoCellParticleField::unifyForceVectors() {
   for (const hemo::Array<T,3>* mem : allocated_for_output) {
     delete mem;
@@ -683,7 +759,7 @@ void HemoCellParticleField::applyConstitutiveModel(bool forced) {
       HemoCellParticle & nParticle = particles[particle_grid[n_index][j]]; \
       if (&nParticle == &lParticle) { continue; } \
       if (lParticle.sv.cellId == nParticle.sv.cellId) { continue; } \
-      const hemo::Array<T,3> dv = lParticle.sv.position - nParticle.sv.position; \
+      const hemo::Array<T,3> dv = lParticle.sv.getPosition() - nParticle.sv.getPosition(); \
       const T distance = sqrt(dv[0]*dv[0]+dv[1]*dv[1]+dv[2]*dv[2]); \
       if (distance < r_cutoff) { \
         const hemo::Array<T, 3> rfm = r_const * (1/(distance/r_cutoff))  * (dv/distance); \
@@ -742,14 +818,47 @@ void HemoCellParticleField::applyRepulsionForce(bool forced) {
   }
 }
 
+T HemoCellParticleField::nearestCellDistance(int range) {
+  if(!pg_up_to_date) {
+    update_pg();
+  }
+  T minimum = range;
+  const int nx = atomicLattice->getNx(), ny = atomicLattice->getNy(), nz = atomicLattice->getNz();
+  Dot3D const& location = atomicLattice->getLocation();
+
+  for (const HemoCellParticle & particle : particles) {
+    const int x = particle.sv.getPosition()[0]-location.x+0.5;
+    const int y = particle.sv.getPosition()[1]-location.y+0.5;
+    const int z = particle.sv.getPosition()[2]-location.z+0.5;
+    // Pairs closer than range are always at most range grid points apart
+    for (int xx = max(x-range,0); xx <= min(x+range,nx-1); xx++) {
+      for (int yy = max(y-range,0); yy <= min(y+range,ny-1); yy++) {
+        for (int zz = max(z-range,0); zz <= min(z+range,nz-1); zz++) {
+          const int & n_index = grid_index(xx,yy,zz);
+          for (unsigned int j = 0; j < particle_grid_size[n_index]; j++) {
+            const HemoCellParticle & nParticle = particles[particle_grid[n_index][j]];
+            if (particle.sv.cellId == nParticle.sv.cellId) { continue; }
+            const hemo::Array<T,3> dv = particle.sv.getPosition() - nParticle.sv.getPosition();
+            const T distance = sqrt(dv[0]*dv[0]+dv[1]*dv[1]+dv[2]*dv[2]);
+            if (distance < minimum) {
+              minimum = distance;
+            }
+          }
+        }
+      }
+    }
+  }
+  return minimum;
+}
+
 #ifdef INTERIOR_VISCOSITY
 void HemoCellParticleField::internalGridPointsMembrane(Box3D domain) {
   // This could be done less complex I guess?
   for (const HemoCellParticle & particle : particles) { // Go over each particle
      if (!(*cellFields)[particle.sv.celltype]->doInteriorViscosity) { continue; }
 
-    for (unsigned int i = 0; i < particle.kernelCoordinates.size(); i++) {
-      const hemo::Array<T, 3> latPos = particle.kernelCoordinates[i]-(particle.sv.position-atomicLattice->getLocation());
+    for (unsigned int i = 0; i < particle.kernelSize; i++) {
+      const hemo::Array<T, 3> latPos = particle.kernelCoordinates[i]-(particle.sv.getPosition()-atomicLattice->getLocation());
       const hemo::Array<T, 3> & normalP = particle.normalDirection;
 
       if (computeLength(latPos) > (*cellFields)[particle.sv.celltype]->mechanics->cellConstants.edge_mean_eq) {continue;}
@@ -773,15 +882,25 @@ void HemoCellParticleField::internalGridPointsMembrane(Box3D domain) {
 }
 
 // For performance reason, this is only executed once every n iterations to make
-// sure that there are no higher viscosity grid points left after substantial movement
+// sure that there are no higher viscosity grid points left after substantial movement.
+//
+// A node can only change from inside to outside (or vice versa) if the membrane
+// passed over it. With the vertices displaced at most maxDisplacement since the
+// last call, such a node lies within maxDisplacement + (longest edge)/sqrt(3)
+// of a vertex. Therefore, for cells seen at the last call only the nodes in
+// that shell are classified again; the other nodes keep their classification.
+// New cells (or cells that moved too much) fall back to filling their bounding
+// box. Only nodes that entered or left a cell get their dynamics changed.
 void HemoCellParticleField::findInternalParticleGridPoints(Box3D domain) {
-  // Reset all the lattice points to the orignal relaxation parameter
-  for (const Dot3D & internalPoint : internalPoints ) {
-    atomicLattice->get(internalPoint.x,internalPoint.y,internalPoint.z);
-    atomicLattice->get(internalPoint.x,internalPoint.y,internalPoint.z).attributeDynamics(&atomicLattice->getBackgroundDynamics());
-  }
-  InteriorViscosityHelper::get(*cellFields).empty(*this);
-  
+  const Dot3D location = atomicLattice->getLocation();
+  const hemo::Array<plint,6> block = {location.x, location.x + atomicLattice->getNx()-1,
+                                      location.y, location.y + atomicLattice->getNy()-1,
+                                      location.z, location.z + atomicLattice->getNz()-1};
+
+  map<int,TrackedInterior> newInteriors;
+  map<Dot3D,pluint> interior; // All interior nodes with the celltype they are in
+  CellBVH bvh;
+
   for (const auto & pair : get_lpc()) { // Go over each cell?
     const int & cid = pair.first;
     const vector<int> & cell = get_particles_per_cell().at(cid);
@@ -792,18 +911,115 @@ void HemoCellParticleField::findInternalParticleGridPoints(Box3D domain) {
     if (!(*cellFields)[ctype]->doInteriorViscosity) {
       continue;
     }
-    
-    hemo::OctreeStructCell octCell(3, 1, 30,
-                                  (*cellFields)[ctype]->mechanics->cellConstants.triangle_list,
-                                  particles, cell);
-
-    std::set<Array<plint,3>> innerNodes;
-    octCell.findInnerNodes(atomicLattice,particles,cell,innerNodes);
-    for (const Array<plint,3> & node : innerNodes) {
-      InteriorViscosityHelper::get(*cellFields).add(*this, {node[0],node[1],node[2]},(*cellFields)[ctype]->interiorViscosityTau );
-      atomicLattice->get(node[0],node[1],node[2]).attributeDynamics((*cellFields)[ctype]->innerViscosityDynamics);
+    const CommonCellConstants & cellConstants = (*cellFields)[ctype]->mechanics->cellConstants;
+
+    bvh.build(cellConstants.triangle_list, particles, cell);
+
+    TrackedInterior & tracked = newInteriors[cid];
+    tracked.vertices.resize(cell.size());
+    for (unsigned int i = 0; i < cell.size(); i++) {
+      tracked.vertices[i] = particles[cell[i]].sv.getPosition();
+    }
+
+    // Bound on the distance a node that changed sides can have to a vertex,
+    // any point of a triangle lies within (longest edge)/sqrt(3) of a vertex
+    bool incremental = false;
+    T shell = 0;
+    hemo::Array<T,6> bbox = {tracked.vertices[0][0], tracked.vertices[0][0],
+                             tracked.vertices[0][1], tracked.vertices[0][1],
+                             tracked.vertices[0][2], tracked.vertices[0][2]};
+    for (const hemo::Array<T,3> & vertex : tracked.vertices) {
+      for (int d = 0; d < 3; d++) {
+        bbox[2*d] = min(bbox[2*d], vertex[d]);
+        bbox[2*d+1] = max(bbox[2*d+1], vertex[d]);
+      }
+    }
+    auto previous = trackedInteriors.find(cid);
+    if (previous != trackedInteriors.end() && previous->second.vertices.size() == cell.size()) {
+      T maxDisplacement = 0, maxEdge = 0;
+      for (unsigned int i = 0; i < cell.size(); i++) {
+        maxDisplacement = max(maxDisplacement, computeLength(tracked.vertices[i] - previous->second.vertices[i]));
+      }
+      for (const hemo::Array<plint,2> & edge : cellConstants.edge_list) {
+        maxEdge = max(maxEdge, computeLength(tracked.vertices[edge[0]] - tracked.vertices[edge[1]]));
+      }
+      shell = maxDisplacement + maxEdge/sqrt(3.);
+      // When the shell spans the cell there is nothing to gain, moreover a
+      // jump (periodic boundary) would leave stale nodes behind
+      T minExtent = min(min(bbox[1]-bbox[0], bbox[3]-bbox[2]), bbox[5]-bbox[4]);
+      incremental = shell < 0.5*minExtent;
+    }
+
+    if (incremental) {
+      // The previous interiors are dropped at the end, take the nodes over
+      tracked.nodes.swap(previous->second.nodes);
+      // Mark the lattice sites within the shell around the vertices
+      const hemo::Array<plint,6> region = {max(block[0],(plint)floor(bbox[0]-shell)), min(block[1],(plint)ceil(bbox[1]+shell)),
+                                           max(block[2],(plint)floor(bbox[2]-shell)), min(block[3],(plint)ceil(bbox[3]+shell)),
+                                           max(block[4],(plint)floor(bbox[4]-shell)), min(block[5],(plint)ceil(bbox[5]+shell))};
+      if (region[0] > region[1] || region[2] > region[3] || region[4] > region[5]) { continue; }
+      const plint ny = region[3]-region[2]+1, nz = region[5]-region[4]+1;
+      vector<bool> inShell((region[1]-region[0]+1)*ny*nz, false);
+      for (const hemo::Array<T,3> & vertex : tracked.vertices) {
+        for (plint x = max(region[0],(plint)ceil(vertex[0]-shell)); x <= min(region[1],(plint)floor(vertex[0]+shell)); x++) {
+          for (plint y = max(region[2],(plint)ceil(vertex[1]-shell)); y <= min(region[3],(plint)floor(vertex[1]+shell)); y++) {
+            for (plint z = max(region[4],(plint)ceil(vertex[2]-shell)); z <= min(region[5],(plint)floor(vertex[2]+shell)); z++) {
+              const hemo::Array<T,3> d = {x-vertex[0], y-vertex[1], z-vertex[2]};
+              if (d[0]*d[0]+d[1]*d[1]+d[2]*d[2] > shell*shell) { continue; }
+              inShell[((x-region[0])*ny + (y-region[2]))*nz + (z-region[4])] = true;
+            }
+          }
+        }
+      }
+
+      // Classify the shell nodes only
+      for (plint x = region[0]; x <= region[1]; x++) {
+        for (plint y = region[2]; y <= region[3]; y++) {
+          for (plint z = region[4]; z <= region[5]; z++) {
+            if (!inShell[((x-region[0])*ny + (y-region[2]))*nz + (z-region[4])]) { continue; }
+            const Dot3D node(x-location.x, y-location.y, z-location.z);
+            if (bvh.isInside({x, y, z})) {
+              tracked.nodes.insert(node);
+            } else {
+              tracked.nodes.erase(node);
+            }
+          }
+        }
+      }
+    } else {
+      bvh.forEachInnerNode(block, [&](plint x, plint y, plint z) {
+        tracked.nodes.insert(Dot3D(x-location.x, y-location.y, z-location.z));
+      });
+    }
+
+    for (const Dot3D & node : tracked.nodes) {
+      interior[node] = ctype;
     }
   }
+
+  // Reset the lattice points that are no longer inside a cell to the original relaxation parameter
+  vector<Dot3D> outside;
+  for (const Dot3D & internalPoint : internalPoints ) {
+    if (interior.find(internalPoint) == interior.end()) {
+      outside.push_back(internalPoint);
+    }
+  }
+  for (const Dot3D & node : outside) {
+    atomicLattice->get(node.x,node.y,node.z).attributeDynamics(&atomicLattice->getBackgroundDynamics());
+  }
+  InteriorViscosityHelper::get(*cellFields).remove(*this, outside);
+
+  // Only set the nodes that entered a cell (or a cell with another viscosity)
+  for (const auto & node : interior) {
+    const Dot3D & point = node.first;
+    const T tau = (*cellFields)[node.second]->interiorViscosityTau;
+    if (internalPoints.count(point) && interiorViscosityField->get(point.x,point.y,point.z) == tau) {
+      continue;
+    }
+    InteriorViscosityHelper::get(*cellFields).add(*this, point, tau);
+    atomicLattice->get(point.x,point.y,point.z).attributeDynamics((*cellFields)[node.second]->innerViscosityDynamics);
+  }
+  trackedInteriors.swap(newInteriors);
 }
 #else
 void HemoCellParticleField::findInternalParticleGridPoints(Box3D domain) {
@@ -828,21 +1044,25 @@ void HemoCellParticleField::interpolateFluidVelocity(Box3D domain) {
 
     // We have the kernels, now calculate the velocity of the particles.
     velocity = {0.0,0.0,0.0};
-    for (pluint j = 0; j < particle.kernelLocations.size(); j++) {
+    for (pluint j = 0; j < particle.kernelSize; j++) {
       // Direct access
       particle.kernelLocations[j]->computeVelocity(velocity_comp);
       velocity += (velocity_comp * particle.kernelWeights[j]);
     }
-    particle.sv.v = velocity;
+    particle.sv.setVelocity(velocity);
   }
 
 }
 
 void HemoCellParticleField::spreadParticleForce(Box3D domain) {
+  const plb::Cell<T,DESCRIPTOR> * firstNode = &atomicLattice->get(0,0,0);
+  if (spreadNodeMask.empty()) {
+    spreadNodeMask.resize(atomicLattice->getNx()*atomicLattice->getNy()*atomicLattice->getNz(),false);
+  }
   for( HemoCellParticle &particle:particles) {
 
     //Trick to allow for different kernels for different particle types.
-    (*cellFields)[particle.sv.celltype]->kernelMethod(*atomicLattice,particle);
+    (*cellFields)[particle.sv.celltype]->kernelMethod(*atomicLattice,particle,boundaryMask);
 
     // Capping force to ensure stability -> NOTE: this can introduce an error if forces are large!
 #ifdef FORCE_LIMIT
@@ -852,29 +1072,63 @@ void HemoCellParticleField::spreadParticleForce(Box3D domain) {
 #endif
 
     // Directly change the force on a node, quick-and-dirty solution.
-    for (pluint j = 0; j < particle.kernelLocations.size(); j++) {
+    for (pluint j = 0; j < particle.kernelSize; j++) {
       // Direct access
       particle.kernelLocations[j]->external.data[0] += ((particle.sv.force_repulsion[0] + particle.sv.force[0]) * particle.kernelWeights[j]);
       particle.kernelLocations[j]->external.data[1] += ((particle.sv.force_repulsion[1] + particle.sv.force[1]) * particle.kernelWeights[j]);
       particle.kernelLocations[j]->external.data[2] += ((particle.sv.force_repulsion[2] + particle.sv.force[2]) * particle.kernelWeights[j]);
+
+      // The cells of an atomic block are stored contiguously, z fastest
+      const unsigned int node = particle.kernelLocations[j] - firstNode;
+      if (!spreadNodeMask[node]) {
+        spreadNodeMask[node] = true;
+        spreadNodes.push_back(node);
+      }
     }
 
   }
 }
 
+void HemoCellParticleField::resetSpreadForce(const hemo::Array<T,3> & bodyForce) {
+  plb::Cell<T,DESCRIPTOR> * firstNode = &atomicLattice->get(0,0,0);
+  // When a large part of the block is touched a linear sweep over the mask is cheaper
+  if (spreadNodes.size() > spreadNodeMask.size()/4) {
+    for (unsigned int node = 0; node < spreadNodeMask.size(); node++) {
+      if (spreadNodeMask[node]) {
+        T * force = firstNode[node].external.data;
+        force[0] = bodyForce[0];
+        force[1] = bodyForce[1];
+        force[2] = bodyForce[2];
+      }
+    }
+    spreadNodeMask.assign(spreadNodeMask.size(),false);
+  } else {
+    for (const unsigned int node : spreadNodes) {
+      T * force = firstNode[node].external.data;
+      force[0] = bodyForce[0];
+      force[1] = bodyForce[1];
+      force[2] = bodyForce[2];
+      spreadNodeMask[node] = false;
+    }
+  }
+  spreadNodes.clear();
+}
+
 void HemoCellParticleField::populateBoundaryParticles() {
+  // Dynamics might have been defined after the cellfields were initialized
+  boundaryMask.build(*atomicLattice);
 
   for (int x = 0; x < this->atomicLattice->getNx()-1; x++) {
     for (int y = 0; y < this->atomicLattice->getNy()-1; y++) {
       for (int z = 0; z < this->atomicLattice->getNz()-1; z++) {
-        if (this->atomicLattice->get(x,y,z).getDynamics().isBoundary()) {
+        if (boundaryMask.isBoundary(x,y,z)) {
           for (int xx = x-1; xx <= x+1; xx++) {
             if (xx < 0 || xx > this->atomicLattice->getNx()-1) {continue;}
             for (int yy = y-1; yy <= y+1; yy++) {
               if (yy < 0 || yy > this->atomicLattice->getNy()-1) {continue;}
               for (int zz = z-1; zz <= z+1; zz++) {
                 if (zz < 0 || zz > this->atomicLattice->getNz()-1) {continue;}
-                if (!this->atomicLattice->get(xx,yy,zz).getDynamics().isBoundary()) {
+                if (!boundaryMask.isBoundary(xx,yy,zz)) {
                   boundaryParticles.push_back({x,y,z});       
                   goto end_inner_loop;
                 }
@@ -904,7 +1158,7 @@ void HemoCellParticleField::applyBoundaryRepulsionForce() {
           const int & index = grid_index(x,y,z);
           for (unsigned int i = 0 ; i < particle_grid_size[index] ; i++ ) {
             HemoCellParticle & lParticle = particles[particle_grid[index][i]];
-            const hemo::Array<T,3> dv = lParticle.sv.position - (b_particle + this->atomicLattice->getLocation()); 
+            const hemo::Array<T,3> dv = lParticle.sv.getPosition() - (b_particle + this->atomicLattice->getLocation()); 
             const T distance = sqrt(dv[0]*dv[0]+dv[1]*dv[1]+dv[2]*dv[2]); 
             if (distance < br_cutoff) { 
               const hemo::Array<T, 3> rfm = br_const * (1/(distance/br_cutoff))  * (dv/distance);
@@ -926,14 +1180,14 @@ void HemoCellParticleField::populateBindingSites(plb::Box3D & domain_) {
   for (int x = domain.x0; x <= domain.x1; x++) {
     for (int y = domain.y0; y <= domain.y1; y++) {
       for (int z = domain.z0; z <= domain.z1; z++) {
-        if (this->atomicLattice->get(x,y,z).getDynamics().isBoundary()) {
+        if (boundaryMask.isBoundary(x,y,z)) {
           for (int xx = x-1; xx <= x+1; xx++) {
             if (xx < 0 || xx > this->atomicLattice->getNx()-1) {continue;}
             for (int yy = y-1; yy <= y+1; yy++) {
               if (yy < 0 || yy > this->atomicLattice->getNy()-1) {continue;}
               for (int zz = z-1; zz <= z+1; zz++) {
                 if (zz < 0 || zz > this->atomicLattice->getNz()-1) {continue;}
-                if (!this->atomicLattice->get(xx,yy,zz).getDynamics().isBoundary()) {
+                if (!boundaryMask.isBoundary(xx,yy,zz)) {
                   bindingFieldHelper::get(*cellFields).add(*this, {x,y,z});
                   goto end_inner_loop;
                 }
@@ -959,42 +1213,8 @@ T HemoCellParticleField::eigenValueFromCell(plb::Cell<T,DESCRIPTOR> & cell) {
             element[iTensor] *= prefactor;
         }
 
-    Array<Array<T,3>,3> S;  // Strain-rate tensor (symmetric).
-    S[0][0] = element[0]; //s[xx];
-    S[0][1] = element[1]; //s[xy];
-    S[0][2] = element[2]; //s[xz];
-                
-    S[1][0] = element[1]; //s[yx];
-    S[1][1] = element[3]; //s[yy];
-    S[1][2] = element[4]; //s[yz];
-
-    S[2][0] = element[2]; //s[zx];
-    S[2][1] = element[4]; //s[zy];
-    S[2][2] = element[5]; //s[zz];
-    
-    Eigen::Matrix<T,3,3> A;
-    for (plint i = 0; i < 3; i++) {
-        for (plint j = 0; j < 3; j++) {
-            A(i, j) = S[i][j];
-        }
-     }
-
-    bool computeEigenvectors = false;
-    Eigen::EigenSolver<Eigen::Matrix<T,3,3> > es(A, computeEigenvectors);
-    std::vector<T> lambda(3);
-    lambda[0] = std::real(es.eigenvalues()[0]);
-    lambda[1] = std::real(es.eigenvalues()[1]);
-    lambda[2] = std::real(es.eigenvalues()[2]);
-    std::sort(lambda.begin(), lambda.end());
-                
-//    Array<Array<T,3>,3> x;  // Eigenvectors of S.
-//    Array<T,3> d;           // Eigenvalues of S.
-//    Eigen::eigenDecomposition(S, x, d);
-//    std::vector<T> lambda(3);
-//    lambda[0] = d[0];
-//    lambda[1] = d[1];
-//    lambda[2] = d[2];
- //   std::sort(lambda.begin(), lambda.end());
+    // The strain-rate tensor {xx, xy, xz, yy, yz, zz} is symmetric
+    const hemo::Array<T,3> lambda = symmetricEigenvalues(hemo::Array<T,6>(element));
     T tresca = (lambda[2]-lambda[0])/2;
     return tresca;
 }
@@ -1029,6 +1249,11 @@ void HemoCellParticleField::solidifyCells() {
   // - close enough in space to a binding site,
   // - shows a minimum tresca stress,
   // the particle is labelled to be solified.
+  if (trescaCache.empty()) {
+    trescaCache.resize(atomicLattice->getNx()*atomicLattice->getNy()*atomicLattice->getNz(),-1.);
+  }
+  // Binding sites share most of their neighbourhood, compute the stress of a node only once
+  vector<int> cachedNodes;
   for (const Dot3D & b_particle : bindingSites) {
     for (int x = b_particle.x-1; x <= b_particle.x+1; x++) {
       if (x < 0 || x > this->atomicLattice->getNx()-1) {
@@ -1049,13 +1274,22 @@ void HemoCellParticleField::solidifyCells() {
 
           for (unsigned int i = 0; i < particle_grid_size[index]; i++) {
             HemoCellParticle & lParticle = particles[particle_grid[index][i]];
-            const hemo::Array<T,3> dv = lParticle.sv.position - (b_particle + this->atomicLattice->getLocation());
+            const HemoCellField & field = *(*cellFields)[lParticle.sv.celltype];
+            if (!field.doSolidifyMechanics) {
+              continue;
+            }
+            const hemo::Array<T,3> dv = lParticle.sv.getPosition() - (b_particle + this->atomicLattice->getLocation());
             const T distance = sqrt(dv[0]*dv[0]+dv[1]*dv[1]+dv[2]*dv[2]);
-            T tresca = eigenValueFromCell(this->atomicLattice->get(x,y,z));
+            if (distance > field.solidifyDistanceThreshold) {
+              continue;
+            }
 
-            // FIXME: both user-defined constants could be extracted outside the loop.
-            if ((distance <= (*cellFields)[lParticle.sv.celltype]->mechanics->cfg["MaterialModel"]["distanceThreshold"].read<T>())
-                    && (abs(tresca/1e-7) > (*cellFields)[lParticle.sv.celltype]->mechanics->cfg["MaterialModel"]["shearThreshold"].read<T>()) ) {
+            T & tresca = trescaCache[index];
+            if (tresca < 0.) {
+              tresca = eigenValueFromCell(this->atomicLattice->get(x,y,z));
+              cachedNodes.push_back(index);
+            }
+            if (abs(tresca/1e-7) > field.solidifyShearThreshold) {
               lParticle.sv.solidify = true;
             }
           }
@@ -1063,6 +1297,9 @@ void HemoCellParticleField::solidifyCells() {
       }
     }
   }
+  for (const int & index : cachedNodes) {
+    trescaCache[index] = -1.;
+  }
 #else
   hlog << "(HemoCellParticleField) SolidifyCells called but SOLIDIFY_MECHANICS not enabled" << endl;
   exit(1);
@@ -31,6 +31,7 @@ namespace hemo {
 #include "hemoCellFields.h"
 #include "hemoCellParticleDataTransfer.h"
 #include "hemoCellParticle.h"
+#include "boundaryMask.h"
 
 #include "atomicBlock/blockLattice3D.hh"
 
@@ -62,11 +63,18 @@ public:
                                pluint type);
     virtual void advanceParticles();
     void applyRepulsionForce(bool forced = false);
+    /// Smallest distance between vertices of different cells, capped at range (lattice units)
+    T nearestCellDistance(int range);
     virtual void interpolateFluidVelocity(plb::Box3D domain);
     virtual void spreadParticleForce(plb::Box3D domain);
+    /// Set the force of the nodes written by spreadParticleForce back to bodyForce
+    void resetSpreadForce(const hemo::Array<T,3> & bodyForce);
     void separateForceVectors();
     void unifyForceVectors();
     void updateResidenceTime(unsigned int rtime);
+    /// Sort the particles on the Morton (Z-order) code of their lattice site,
+    /// or on cell and vertex id, and remap the particle index structures
+    void reorderParticles(bool byCell = false);
     
     virtual void findInternalParticleGridPoints(plb::Box3D domain);
     virtual void internalGridPointsMembrane(plb::Box3D domain);
@@ -79,6 +87,8 @@ public:
     void populateBindingSites(plb::Box3D & domain);
 
     T eigenValueFromCell(plb::Cell<T,DESCRIPTOR> & cell);
+    // Tresca stress of the lattice nodes during solidifyCells(), negative when not computed yet
+    vector<T> trescaCache;
     
     void solidifyCells();
     void prepareSolidification();
@@ -135,6 +145,8 @@ public:
     static HemoCellFields* cellFields;
     pluint atomicBlockId;
     plb::BlockLattice3D<T, DESCRIPTOR> * atomicLattice = 0;
+    // Boundary nodes of atomicLattice, use instead of getDynamics().isBoundary()
+    BoundaryMask boundaryMask;
     plb::BlockLattice3D<T, CEPAC_DESCRIPTOR> * CEPAClattice = 0;
 
     vector<plint> neighbours;
@@ -187,8 +199,18 @@ public:
   const map<int,vector<int>> & get_particles_per_cell();
   const map<int,vector<int>> & get_preinlet_particles_per_cell();
   const map<int,bool> & get_lpc();
+  /// Indices of the particles nearest to the local lattice node (x,y,z)
+  vector<unsigned int> get_particles_on_node(int x, int y, int z);
   
   set<plb::Dot3D> internalPoints; // Store found interior points
+  // Interior nodes (local coordinates) and vertex positions of each cell at the
+  // last findInternalParticleGridPoints, used to only re-test the nodes close
+  // to the membrane at the next call
+  struct TrackedInterior {
+    vector<hemo::Array<T,3>> vertices;
+    set<plb::Dot3D> nodes;
+  };
+  map<int,TrackedInterior> trackedInteriors;
   plb::ScalarField3D<T> * interiorViscosityField = 0;
   
     
@@ -200,6 +222,12 @@ public:
 public:
     plint addParticleCount = 0;
     plb::Box3D localDomain;
+    // Local indices of the fluid nodes that received a spread force since the
+    // last resetSpreadForce(), spreadNodeMask prevents duplicates
+    vector<unsigned int> spreadNodes;
+    vector<bool> spreadNodeMask;
+    // Particle envelope traffic since the last BlockTelemetry sample
+    unsigned long long bytesSent = 0, bytesReceived = 0;
     
     //These should be edited through the helper/solidifyField.h functions
     std::set<plb::Dot3D> bindingSites;
@@ -24,6 +24,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef IMMERSEDBOUNDARYMETHOD_H
 #define IMMERSEDBOUNDARYMETHOD_H
 
+#include "boundaryMask.h"
+
 #include <vector>
 
 namespace hemo {
@@ -40,14 +42,38 @@ inline T phi2 (T x) {
     return max(x,(T)0.0);
 }
 
-template<typename T>
-T phi3 (T x) ;
+/// Three point kernel of Roma et al. (1999)
+inline T phi3 (T x) {
+    x = fabs(x);
+    if (x <= 0.5) {
+      return (1.0 + sqrt(1.0 - 3.0*x*x)) / 3.0;
+    }
+    if (x <= 1.5) {
+      return (5.0 - 3.0*x - sqrt(1.0 - 3.0*(1.0 - x)*(1.0 - x))) / 6.0;
+    }
+    return 0.0;
+}
 
-template<typename T>
-T phi4 (T x) ;
+/// Four point kernel of Peskin (2002)
+inline T phi4 (T x) {
+    x = fabs(x);
+    if (x <= 1.0) {
+      return (3.0 - 2.0*x + sqrt(1.0 + 4.0*x - 4.0*x*x)) / 8.0;
+    }
+    if (x <= 2.0) {
+      return (5.0 - 2.0*x - sqrt(-7.0 + 12.0*x - 4.0*x*x)) / 8.0;
+    }
+    return 0.0;
+}
 
-template<typename T>
-T phi4c (T x) ;
+/// Four point cosine kernel
+inline T phi4c (T x) {
+    x = fabs(x);
+    if (x <= 2.0) {
+      return 0.25*(1.0 + cos(0.5*PI*x));
+    }
+    return 0.0;
+}
 
 template<typename T, template<typename U> class Descriptor>
 void interpolationCoefficients (
@@ -59,98 +85,121 @@ void interpolationCoefficientsPhi1 (
         BlockLattice3D<T,Descriptor> const& block, hemo::Array<T,3> const& position,
         std::vector<Dot3D>& cellPos, std::vector<T>& weights);
 
-inline void interpolationCoefficientsPhi2 (
-        BlockLattice3D<T,DESCRIPTOR> & block, HemoCellParticle & particle)
+/*
+ * Separable kernel covering Width nodes in every direction. The one
+ * dimensional weights are evaluated once per direction, the weight of a node
+ * is their product. Nodes with a zero weight are skipped. Nodes on a
+ * boundary are skipped and their weight is redistributed over the remaining
+ * nodes. Nodes outside the block are skipped as well, but their weight is
+ * kept in the normalization: they are covered by the neighbouring block, so
+ * the weights of all blocks together still sum to one.
+ */
+template<T (*Phi)(T), int Width>
+inline void interpolationCoefficientsSeparable (
+        BlockLattice3D<T,DESCRIPTOR> & block, HemoCellParticle & particle, BoundaryMask const& boundaryMask)
 {
-    //Clean current
-    particle.kernelWeights.clear();
-    particle.kernelWeights.reserve(8);
-    particle.kernelLocations.clear();
-    #ifdef INTERIOR_VISCOSITY
-    particle.kernelCoordinates.clear();
-    particle.kernelCoordinates.reserve(8);
-    #endif
-    
-    // Fixed kernel size
-    const plint x0=-1, x1=2; //const for nice loop unrolling
+    static_assert(unsigned(Width*Width*Width) <= HemoCellParticle::maxKernelSize, "Kernel does not fit in HemoCellParticle");
+    //Number of kernel nodes found so far
+    unsigned int size = 0;
 
     //Coordinates are relative
-    const Dot3D tmpDot = block.getLocation(); 
+    const Dot3D tmpDot = block.getLocation();
     const hemo::Array<plint,3> relLoc = {tmpDot.x, tmpDot.y, tmpDot.z};
 
     //Get position, relative
-    const hemo::Array<T,3> position_tmp = particle.sv.position;
+    const hemo::Array<T,3> position_tmp = particle.sv.getPosition();
     const hemo::Array<T,3> position = {position_tmp[0] -relLoc[0], position_tmp[1]-relLoc[1],position_tmp[2]-relLoc[2]};
 
-    //Get our reference node (0,0)
-    const hemo::Array<plint,3> center({plint(position[0] + 0.5), plint(position[1] + 0.5), plint(position[2] + 0.5)}); 
-    
     //Boundingbox of lattice
     const Box3D boundingBox = block.getBoundingBox();
-    
-    //Prealloc is better than JItalloc
-    hemo::Array<plint,3> posInBlock;
+    const plint lower[3] = {boundingBox.x0, boundingBox.y0, boundingBox.z0};
+    const plint upper[3] = {boundingBox.x1, boundingBox.y1, boundingBox.z1};
+
+    //First node of the kernel and the weights along every direction
+    plint first[3];
+    T phi[3][Width];
+    bool inside[3][Width];
+    for (int d = 0; d < 3; d++) {
+      first[d] = plint(std::floor(position[d] - 0.5*Width)) + 1;
+      for (int i = 0; i < Width; i++) {
+        const plint node = first[d] + i;
+        phi[d][i] = Phi(position[d] - node);
+        inside[d][i] = node >= lower[d] && node <= upper[d];
+      }
+    }
 
-    T phi[3];
-    T weight;
     T total_weight = 0;
-    
-    
-    for (int dx = x0; dx < x1; ++dx) {
-        for (int dy = x0; dy < x1; ++dy) {
-            for (int dz = x0; dz < x1; ++dz) {
-                posInBlock = {center[0] + dx, center[1] + dy, center[2] + dz};
-                
-                //Sanity checks, skip if outside domain or boundary
-                if (!contained_sane(posInBlock,boundingBox)) {
+    //Weight of the nodes outside of the block, only used for normalization
+    T clipped_weight = 0;
+    for (int i = 0; i < Width; ++i) {
+        if (phi[0][i] == 0.0) {
+          continue;
+        }
+        const plint x = first[0] + i;
+        for (int j = 0; j < Width; ++j) {
+            const T weight_xy = phi[0][i] * phi[1][j];
+            if (weight_xy == 0.0) {
+              continue;
+            }
+            const plint y = first[1] + j;
+            for (int k = 0; k < Width; ++k) {
+                const T weight = weight_xy * phi[2][k];
+                if (weight == 0.0) {
                   continue;
                 }
+                const plint z = first[2] + k;
 
-                phi[0] = (position[0] - posInBlock[0]); //Get absolute distance
-                phi[1] = (position[1] - posInBlock[1]);
-                phi[2] = (position[2] - posInBlock[2]);
-                weight = phi2(phi[0]) * phi2(phi[1]) * phi2(phi[2]);
-                
-                if (weight  == 0.0){
+                if (!(inside[0][i] && inside[1][j] && inside[2][k])) {
+                  clipped_weight+=weight;
                   continue;
                 }
 
-                if (block.get(posInBlock[0],posInBlock[1],posInBlock[2]).getDynamics().isBoundary()) {
+                if (boundaryMask.isBoundary(x,y,z)) {
                   continue;
-                }              
-                
+                }
+
                 total_weight+=weight;
 
-                particle.kernelWeights.push_back(weight);
-                particle.kernelLocations.push_back(&block.get(posInBlock[0],posInBlock[1],posInBlock[2]));
-		
+                particle.kernelWeights[size] = weight;
+                particle.kernelLocations[size] = &block.get(x,y,z);
+
                 #ifdef INTERIOR_VISCOSITY
-                // Or create a clone of the method?
-                particle.kernelCoordinates.push_back({posInBlock[0],posInBlock[1],posInBlock[2]});
+                particle.kernelCoordinates[size] = {x,y,z};
                 #endif
+                size++;
             }
         }
     }
-    const T weight_coeff = 1.0 / total_weight;
-    for(T & weight_ : particle.kernelWeights) { //Normalize weight to 1
-      weight_ *= weight_coeff;
+    particle.kernelSize = size;
+    const T weight_coeff = 1.0 / (total_weight + clipped_weight);
+    for (unsigned int i = 0; i < size; i++) { //Normalize weight to 1
+      particle.kernelWeights[i] *= weight_coeff;
     }
 }
 
-template<typename T, template<typename U> class Descriptor>
-void interpolationCoefficientsPhi3 (
-    
-        BlockLattice3D<T,Descriptor> const& block, hemo::Array<T,3> const& position,
-        std::vector<Dot3D>& cellPos, std::vector<T>& weights);
+inline void interpolationCoefficientsPhi2 (
+        BlockLattice3D<T,DESCRIPTOR> & block, HemoCellParticle & particle, BoundaryMask const& boundaryMask)
+{
+    interpolationCoefficientsSeparable<phi2,2>(block, particle, boundaryMask);
+}
+
+inline void interpolationCoefficientsPhi3 (
+        BlockLattice3D<T,DESCRIPTOR> & block, HemoCellParticle & particle, BoundaryMask const& boundaryMask)
+{
+    interpolationCoefficientsSeparable<phi3,3>(block, particle, boundaryMask);
+}
 
-void interpolationCoefficientsPhi4 (
-        BlockLattice3D<double,DESCRIPTOR> const& block, hemo::Array<double,3> const& position,
-        std::vector<Dot3D>& cellPos, std::vector<double>& weights);
+inline void interpolationCoefficientsPhi4 (
+        BlockLattice3D<T,DESCRIPTOR> & block, HemoCellParticle & particle, BoundaryMask const& boundaryMask)
+{
+    interpolationCoefficientsSeparable<phi4,4>(block, particle, boundaryMask);
+}
 
-template<typename T, template<typename U> class Descriptor>
-void interpolationCoefficientsPhi4c (
-        BlockLattice3D<T,Descriptor> const& block, hemo::Array<T,3> const& position,
-        std::vector<Dot3D>& cellPos, std::vector<T>& weights);
+inline void interpolationCoefficientsPhi4c (
+        BlockLattice3D<T,DESCRIPTOR> & block, HemoCellParticle & particle, BoundaryMask const& boundaryMask)
+{
+    interpolationCoefficientsSeparable<phi4c,4>(block, particle, boundaryMask);
+}
 
 /*
  * In case one of the interpolating boundary nodes is a boundary,
@@ -150,11 +150,9 @@ int main(int argc, char *argv[]) {
       hemocell.writeOutput();
 
       // Fill up the static info structure with desired data
-      CellInformationFunctionals::calculateCellVolume(&hemocell);
-      CellInformationFunctionals::calculateCellArea(&hemocell);
-      CellInformationFunctionals::calculateCellPosition(&hemocell);
-      CellInformationFunctionals::calculateCellStretch(&hemocell);
-      CellInformationFunctionals::calculateCellBoundingBox(&hemocell);
+      CellInformationFunctionals::calculateCellQuantities(&hemocell,
+        CellInformationFunctionals::VOLUME | CellInformationFunctionals::AREA | CellInformationFunctionals::POSITION |
+        CellInformationFunctionals::STRETCH | CellInformationFunctionals::BOUNDING_BOX);
 
       T volume = (CellInformationFunctionals::info_per_cell[0].volume) / pow(1e-6 / param::dx, 3);
       T surface = (CellInformationFunctionals::info_per_cell[0].area) / pow(1e-6 / param::dx, 2);
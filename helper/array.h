@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <cstddef>
 #include <array>
+#include <algorithm>
+#include <cmath>
 
 #include "constant_defaults.h"
 
@@ -319,6 +321,31 @@ namespace hemo {
     c_l = norm(a);
     b_l = std::sqrt(std::pow(c_l,2)-std::pow(a_l,2));
   }  
+
+  /*
+   * Eigenvalues, in ascending order, of the symmetric matrix
+   * {xx, xy, xz, yy, yz, zz} (the order of a plb::SymmetricTensor) using the
+   * closed form trigonometric solution of the characteristic polynomial.
+   */
+  template<typename _Tp>
+  Array<_Tp,3> symmetricEigenvalues(const Array<_Tp,6> & s) {
+    const _Tp offDiagonal = s[1]*s[1] + s[2]*s[2] + s[4]*s[4];
+    if (offDiagonal == 0) {
+      Array<_Tp,3> lambda = {s[0], s[3], s[5]};
+      std::sort(lambda.begin(), lambda.end());
+      return lambda;
+    }
+    const _Tp q = (s[0] + s[3] + s[5])/3;
+    const _Tp p = std::sqrt(((s[0]-q)*(s[0]-q) + (s[3]-q)*(s[3]-q) + (s[5]-q)*(s[5]-q) + 2*offDiagonal)/6);
+    // B = (A - qI)/p has eigenvalues 2cos(phi + 2k pi/3) with cos(3 phi) = det(B)/2
+    const _Tp b00 = (s[0]-q)/p, b01 = s[1]/p, b02 = s[2]/p;
+    const _Tp b11 = (s[3]-q)/p, b12 = s[4]/p, b22 = (s[5]-q)/p;
+    const _Tp r = (b00*(b11*b22 - b12*b12) - b01*(b01*b22 - b12*b02) + b02*(b01*b12 - b11*b02))/2;
+    const _Tp phi = r <= -1 ? _Tp(M_PI/3) : (r >= 1 ? _Tp(0) : std::acos(r)/3);
+    const _Tp largest = q + 2*p*std::cos(phi);
+    const _Tp smallest = q + 2*p*std::cos(phi + _Tp(2*M_PI/3));
+    return {smallest, 3*q - largest - smallest, largest};
+  }
 }
 
 #endif
@@ -0,0 +1,95 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "blockTelemetry.h"
+
+namespace hemo {
+
+BlockTelemetry::BlockTelemetry(HemoCell & hemocell_, const std::string & fileName) : hemocell(hemocell_) {
+  if (global::mpi().isMainProcessor()) {
+    file.open(fileName, std::ofstream::trunc);
+    if (!file.is_open()) {
+      hlog << "(BlockTelemetry) (Error) Opening " << fileName << ", no block telemetry will be written" << endl;
+    } else {
+      file << "iteration,block,process,fluid_time,particle_time,local_particles,envelope_particles,bytes_sent,bytes_received" << endl;
+    }
+  }
+}
+
+void BlockTelemetry::record() {
+  const int rank = global::mpi().getRank();
+  const vector<plint> & blocks = hemocell.lattice->getMultiBlockManagement().getLocalInfo().getBlocks();
+
+  vector<Record> local;
+  local.reserve(blocks.size());
+  vector<HemoCellParticle *> found;
+  for (const plint & bId : blocks) {
+    HemoCellParticleField & pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    BlockLattice3D<T,DESCRIPTOR> & ff = hemocell.lattice->getComponent(bId);
+
+    // The timers can be reset by the load balancer in between samples
+    const double fluidTime = ff.timer.getTime(), particleTime = pf.timer.getTime();
+    std::pair<double,double> & previous = previousTimes[bId];
+    Record record;
+    record.iteration = hemocell.iter;
+    record.block = bId;
+    record.process = rank;
+    record.fluidTime = (fluidTime >= previous.first) ? fluidTime - previous.first : fluidTime;
+    record.particleTime = (particleTime >= previous.second) ? particleTime - previous.second : particleTime;
+    previous = {fluidTime, particleTime};
+
+    found.clear();
+    pf.findParticles(pf.localDomain, found);
+    record.localParticles = found.size();
+    record.envelopeParticles = pf.particles.size() - found.size();
+    record.bytesSent = pf.bytesSent;
+    record.bytesReceived = pf.bytesReceived;
+    pf.bytesSent = pf.bytesReceived = 0;
+    local.push_back(record);
+  }
+
+  // Gather the records on the main process only
+  const int size = global::mpi().getSize();
+  int localBytes = local.size()*sizeof(Record);
+  vector<int> bytes(size), displacements(size, 0);
+  MPI_Gather(&localBytes, 1, MPI_INT, bytes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+  vector<Record> all;
+  if (rank == 0) {
+    for (int i = 1 ; i < size ; i++) {
+      displacements[i] = displacements[i-1] + bytes[i-1];
+    }
+    all.resize((displacements.back() + bytes.back())/sizeof(Record));
+  }
+  MPI_Gatherv(local.data(), localBytes, MPI_BYTE, all.data(), bytes.data(), displacements.data(), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+  if (rank != 0 || !file.is_open()) { return; }
+  for (const Record & record : all) {
+    file << record.iteration << "," << record.block << "," << record.process << ","
+         << record.fluidTime << "," << record.particleTime << ","
+         << record.localParticles << "," << record.envelopeParticles << ","
+         << record.bytesSent << "," << record.bytesReceived << "\n";
+  }
+  file.flush();
+}
+
+}
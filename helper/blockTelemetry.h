@@ -0,0 +1,77 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef HEMO_BLOCK_TELEMETRY_H
+#define HEMO_BLOCK_TELEMETRY_H
+
+namespace hemo {
+  class BlockTelemetry;
+}
+#include "hemocell.h"
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+
+namespace hemo {
+/**
+ * Time series of the cost of every atomic block, written every
+ * <verbose><blockTelemetry>N</blockTelemetry> iterations to
+ * <logDirectory>/blockTelemetry.csv by the main process. Per block and sample:
+ *
+ *   fluid_time, particle_time  seconds spent in the fluid and particle field
+ *                              data processors since the previous sample
+ *   local_particles            particles inside the bulk of the block
+ *   envelope_particles         particles in the envelope of the block
+ *   bytes_sent, bytes_received particle envelope traffic (MPI) since the
+ *                              previous sample
+ *
+ * Only the sampling iterations do any work: the local values are collected
+ * per block and gathered once on the main process.
+ */
+class BlockTelemetry {
+public:
+  BlockTelemetry(HemoCell & hemocell, const std::string & fileName);
+
+  /// Sample all blocks, collective
+  void record();
+
+private:
+  struct Record {
+    uint32_t iteration;
+    int32_t block;
+    int32_t process;
+    uint32_t localParticles;
+    uint32_t envelopeParticles;
+    double fluidTime;
+    double particleTime;
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+  };
+
+  HemoCell & hemocell;
+  std::ofstream file;
+  std::map<plint,std::pair<double,double>> previousTimes; // fluid, particle time per local block
+};
+}
+#endif
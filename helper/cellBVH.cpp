@@ -0,0 +1,204 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "cellBVH.h"
+#include "hemoCellParticle.h"
+
+namespace hemo {
+
+using namespace std;
+
+// Triangles per leaf of the hierarchy
+static const unsigned int leafSize = 4;
+
+// Edge function of the line (y,z) against the edge a->b, projected on the
+// (y,z) plane. The endpoints are taken in a fixed order, so the triangles
+// sharing an edge get exactly opposite values.
+static inline T edgeFunction(const hemo::Array<T,3> & a, const hemo::Array<T,3> & b, T y, T z, int & sign) {
+  const bool swap = b[1] < a[1] || (b[1] == a[1] && b[2] < a[2]);
+  const hemo::Array<T,3> & p = swap ? b : a;
+  const hemo::Array<T,3> & q = swap ? a : b;
+  const T e = (q[1]-p[1])*(z-p[2]) - (q[2]-p[2])*(y-p[1]);
+
+  if (e != 0) {
+    sign = e > 0 ? 1 : -1;
+  } else {
+    // On the edge: the sign for the line shifted by (eps, eps^2), 0 for a degenerate edge
+    const T tie = (q[2] != p[2]) ? -(q[2]-p[2]) : (q[1]-p[1]);
+    sign = tie > 0 ? 1 : (tie < 0 ? -1 : 0);
+  }
+  if (swap) {
+    sign = -sign;
+    return -e;
+  }
+  return e;
+}
+
+void CellBVH::build(const vector<hemo::Array<plint,3>> & triangles,
+                    const vector<HemoCellParticle> & particles, const vector<int> & cell) {
+  positions.resize(cell.size());
+  for (unsigned int i = 0; i < cell.size(); i++) {
+    positions[i] = particles[cell[i]].sv.getPosition();
+  }
+  build(triangles, positions);
+}
+
+void CellBVH::build(const vector<hemo::Array<plint,3>> & triangles, const vector<hemo::Array<T,3>> & vertices) {
+  nodes.clear();
+  crossings.clear();
+  if (vertices.empty() || triangles.empty()) {
+    bBox = {0, -1, 0, -1, 0, -1};
+    order.clear();
+    corners.clear();
+    return;
+  }
+
+  bBox = {vertices[0][0], vertices[0][0], vertices[0][1], vertices[0][1], vertices[0][2], vertices[0][2]};
+  for (const hemo::Array<T,3> & vertex : vertices) {
+    for (int d = 0; d < 3; d++) {
+      bBox[2*d] = min(bBox[2*d], vertex[d]);
+      bBox[2*d+1] = max(bBox[2*d+1], vertex[d]);
+    }
+  }
+
+  const unsigned int n = triangles.size();
+  order.resize(n);
+  bounds.resize(n);
+  for (unsigned int t = 0; t < n; t++) {
+    order[t] = t;
+    const hemo::Array<T,3> & v0 = vertices[triangles[t][0]];
+    const hemo::Array<T,3> & v1 = vertices[triangles[t][1]];
+    const hemo::Array<T,3> & v2 = vertices[triangles[t][2]];
+    bounds[t] = {min(min(v0[1],v1[1]),v2[1]), max(max(v0[1],v1[1]),v2[1]),
+                 min(min(v0[2],v1[2]),v2[2]), max(max(v0[2],v1[2]),v2[2])};
+  }
+
+  nodes.push_back({0, 0, 0, 0, 0, n});
+  subdivide(0);
+
+  // Store the vertices in leaf order, so a leaf is a contiguous piece of memory
+  corners.resize(3*n);
+  for (unsigned int i = 0; i < n; i++) {
+    for (int k = 0; k < 3; k++) {
+      corners[3*i+k] = vertices[triangles[order[i]][k]];
+    }
+  }
+}
+
+void CellBVH::subdivide(unsigned int id) {
+  const unsigned int first = nodes[id].first;
+  const unsigned int count = nodes[id].count;
+
+  hemo::Array<T,4> box = bounds[order[first]];
+  hemo::Array<T,4> centers = {box[0]+box[1], box[0]+box[1], box[2]+box[3], box[2]+box[3]};
+  for (unsigned int i = first+1; i < first+count; i++) {
+    const hemo::Array<T,4> & b = bounds[order[i]];
+    box[0] = min(box[0], b[0]);
+    box[1] = max(box[1], b[1]);
+    box[2] = min(box[2], b[2]);
+    box[3] = max(box[3], b[3]);
+    centers[0] = min(centers[0], b[0]+b[1]);
+    centers[1] = max(centers[1], b[0]+b[1]);
+    centers[2] = min(centers[2], b[2]+b[3]);
+    centers[3] = max(centers[3], b[2]+b[3]);
+  }
+  nodes[id].yMin = box[0];
+  nodes[id].yMax = box[1];
+  nodes[id].zMin = box[2];
+  nodes[id].zMax = box[3];
+
+  if (count <= leafSize) {
+    return;
+  }
+
+  // Median split along the longest extent of the triangle centers
+  const int axis = (centers[1]-centers[0] >= centers[3]-centers[2]) ? 0 : 2;
+  const unsigned int half = count/2;
+  nth_element(order.begin()+first, order.begin()+first+half, order.begin()+first+count,
+              [this, axis](unsigned int a, unsigned int b) {
+                return bounds[a][axis]+bounds[a][axis+1] < bounds[b][axis]+bounds[b][axis+1];
+              });
+
+  const unsigned int left = nodes.size();
+  nodes.push_back({0, 0, 0, 0, first, half});
+  nodes.push_back({0, 0, 0, 0, first+half, count-half});
+  nodes[id].first = left;
+  nodes[id].count = 0;
+  subdivide(left);
+  subdivide(left+1);
+}
+
+void CellBVH::findCrossings(plint y_, plint z_) const {
+  crossings.clear();
+  if (nodes.empty()) { return; }
+  const T y = y_, z = z_;
+
+  // The median split keeps the depth logarithmic in the number of triangles
+  unsigned int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+  while (top) {
+    const Node & node = nodes[stack[--top]];
+    if (y < node.yMin || y > node.yMax || z < node.zMin || z > node.zMax) {
+      continue;
+    }
+    if (!node.count) {
+      stack[top++] = node.first;
+      stack[top++] = node.first+1;
+      continue;
+    }
+    for (unsigned int i = node.first; i < node.first+node.count; i++) {
+      const hemo::Array<T,3> & v0 = corners[3*i];
+      const hemo::Array<T,3> & v1 = corners[3*i+1];
+      const hemo::Array<T,3> & v2 = corners[3*i+2];
+      int s0, s1, s2;
+      const T w0 = edgeFunction(v1, v2, y, z, s0);
+      const T w1 = edgeFunction(v2, v0, y, z, s1);
+      const T w2 = edgeFunction(v0, v1, y, z, s2);
+      if (!s0 || s0 != s1 || s0 != s2) {
+        continue;
+      }
+      const T area = w0 + w1 + w2;
+      if (area == 0) {
+        continue;
+      }
+      crossings.push_back((w0*v0[0] + w1*v1[0] + w2*v2[0])/area);
+    }
+  }
+  sort(crossings.begin(), crossings.end());
+}
+
+bool CellBVH::isInside(const hemo::Array<plint,3> & latticeSite) const {
+  if (latticeSite[0] < bBox[0] || latticeSite[0] > bBox[1]) {
+    return false;
+  }
+  findCrossings(latticeSite[1], latticeSite[2]);
+  unsigned int passed = 0;
+  while (passed < crossings.size() && crossings[passed] < latticeSite[0]) {
+    passed++;
+  }
+  // A site on the membrane is outside, as is one past the last crossing of
+  // an open (odd) crossing list
+  return passed%2 && passed < crossings.size() && crossings[passed] != latticeSite[0];
+}
+}
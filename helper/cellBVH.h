@@ -0,0 +1,115 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef HEMO_CELL_BVH_H
+#define HEMO_CELL_BVH_H
+
+#include "array.h"
+
+#include <vector>
+
+namespace hemo {
+  class HemoCellParticle;
+
+/**
+ * Finds the lattice sites inside the membrane of a single cell.
+ *
+ * The triangles are stored in a flat bounding volume hierarchy over their
+ * projection on the (y,z) plane. For every (y,z) line of the bounding box the
+ * hierarchy yields the triangles the line passes through, the sorted x
+ * coordinates of the crossings then classify all sites on the line at once
+ * (even-odd rule). This replaces one ray cast per lattice site.
+ *
+ * A line through an edge or a vertex is handled by symbolically shifting it
+ * by (eps, eps^2) in (y,z), so it crosses exactly one of the triangles sharing
+ * the edge and the parity stays correct for closed meshes. A site exactly on
+ * a crossing is outside.
+ *
+ * All storage is kept between builds, reuse a single object for many cells.
+ */
+class CellBVH {
+public:
+  /// Build the hierarchy over the triangles of a cell, the triangles index into cell
+  void build(const std::vector<hemo::Array<plint,3>> & triangles,
+             const std::vector<HemoCellParticle> & particles, const std::vector<int> & cell);
+  /// Build the hierarchy over the triangles of a mesh, the triangles index into vertices
+  void build(const std::vector<hemo::Array<plint,3>> & triangles, const std::vector<hemo::Array<T,3>> & vertices);
+
+  /// Bounding box of the vertices {x0,x1,y0,y1,z0,z1}
+  const hemo::Array<T,6> & getBoundingBox() const { return bBox; }
+
+  /// Even-odd test of a single (global) lattice site
+  bool isInside(const hemo::Array<plint,3> & latticeSite) const;
+
+  /// Call inside(x,y,z) for every lattice site of region {x0,x1,y0,y1,z0,z1}
+  /// (inclusive, global coordinates) that lies inside the cell
+  template<typename Function>
+  void forEachInnerNode(const hemo::Array<plint,6> & region, Function inside) const {
+    const plint x0 = std::max(region[0], (plint)std::ceil(bBox[0]));
+    const plint x1 = std::min(region[1], (plint)std::floor(bBox[1]));
+    const plint y0 = std::max(region[2], (plint)std::ceil(bBox[2]));
+    const plint y1 = std::min(region[3], (plint)std::floor(bBox[3]));
+    const plint z0 = std::max(region[4], (plint)std::ceil(bBox[4]));
+    const plint z1 = std::min(region[5], (plint)std::floor(bBox[5]));
+    if (x0 > x1) { return; }
+
+    for (plint y = y0; y <= y1; y++) {
+      for (plint z = z0; z <= z1; z++) {
+        findCrossings(y, z);
+        // Walk along the line, a site is inside after an odd number of
+        // crossings, unless it lies exactly on the next one
+        unsigned int passed = 0;
+        for (plint x = x0; x <= x1; x++) {
+          while (passed < crossings.size() && crossings[passed] < x) {
+            passed++;
+          }
+          if (passed == crossings.size()) { break; }
+          if (passed%2 && crossings[passed] != x) {
+            inside(x, y, z);
+          }
+        }
+      }
+    }
+  }
+
+private:
+  struct Node {
+    T yMin, yMax, zMin, zMax;
+    unsigned int first; // First triangle of a leaf, left child of an inner node (right is first+1)
+    unsigned int count; // Number of triangles of a leaf, 0 for an inner node
+  };
+
+  void subdivide(unsigned int node);
+  /// Fill crossings with the sorted x coordinates where the line (y,z) passes the membrane
+  void findCrossings(plint y, plint z) const;
+
+  hemo::Array<T,6> bBox;
+  std::vector<Node> nodes;
+  std::vector<unsigned int> order;          // Triangle indices in leaf order
+  std::vector<hemo::Array<T,4>> bounds;     // Projected bounds of a triangle {y0,y1,z0,z1}
+  std::vector<hemo::Array<T,3>> corners;    // Vertices of the triangles in leaf order, three per triangle
+  std::vector<hemo::Array<T,3>> positions;  // Vertices gathered from the particles
+  mutable std::vector<T> crossings;
+};
+}
+#endif
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "cellInfo.h"
 #include "hemocell.h"
 #include "hemoCellParticleField.h"
+#include "convexHull.h"
 
 namespace hemo {
 
@@ -31,295 +32,128 @@ namespace hemo {
   info_per_cell.clear();
 }
 void CellInformationFunctionals::calculate_vol_pos_area(HemoCell* hemocell) {
-  calculateCellArea(hemocell);
-  calculateCellVolume(hemocell);
-  calculateCellPosition(hemocell);
+  calculateCellQuantities(hemocell, VOLUME | POSITION | AREA);
 }
 
-void CellInformationFunctionals::CellVolume::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
-  HemoCellParticleField* pf = dynamic_cast<HemoCellParticleField*>(blocks[0]);
-
-  for (const auto & pair : pf->get_lpc()) {
-    T volume = 0.;
-    const int & cid = pair.first;
-    const vector<int> & cell = pf->get_particles_per_cell().at(cid);
-    const pluint ctype = pf->particles[cell[0]].sv.celltype;
-    for (hemo::Array<plint,3> triangle : (*hemocell->cellfields)[ctype]->mechanics->cellConstants.triangle_list) {
-      const hemo::Array<T,3> & v0 = pf->particles[cell[triangle[0]]].sv.position;
-      const hemo::Array<T,3> & v1 = pf->particles[cell[triangle[1]]].sv.position;
-      const hemo::Array<T,3> & v2 = pf->particles[cell[triangle[2]]].sv.position;
-      
-      //Volume
-      const T v210 = v2[0]*v1[1]*v0[2];
-      const T v120 = v1[0]*v2[1]*v0[2];
-      const T v201 = v2[0]*v0[1]*v1[2];
-      const T v021 = v0[0]*v2[1]*v1[2];
-      const T v102 = v1[0]*v0[1]*v2[2];
-      const T v012 = v0[0]*v1[1]*v2[2];
-      volume += (1.0/6.0)*(-v210+v120+v201-v021-v102+v012);
-    }
-    info_per_cell[cid].volume = volume;
-  }
-}
-void CellInformationFunctionals::CellArea::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
-  HemoCellParticleField* pf = dynamic_cast<HemoCellParticleField*>(blocks[0]);
-  
-  for (const auto & pair : pf->get_lpc()) {
-    T total_area = 0.;
-    const int & cid = pair.first;
-    const vector<int> & cell = pf->get_particles_per_cell().at(cid);
-    const pluint ctype = pf->particles[cell[0]].sv.celltype;
-    for (hemo::Array<plint,3> triangle : (*hemocell->cellfields)[ctype]->mechanics->cellConstants.triangle_list) {
-      const hemo::Array<T,3> & v0 = pf->particles[cell[triangle[0]]].sv.position;
-      const hemo::Array<T,3> & v1 = pf->particles[cell[triangle[1]]].sv.position;
-      const hemo::Array<T,3> & v2 = pf->particles[cell[triangle[2]]].sv.position;
-
-      total_area += computeTriangleArea(v0,v1,v2);  
-    }
-    info_per_cell[cid].area = total_area;
-  }
-}
-void CellInformationFunctionals::CellPosition::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
-  HemoCellParticleField* pf = dynamic_cast<HemoCellParticleField*>(blocks[0]);
-  
-  for (const auto & pair : pf->get_lpc()) {
-    hemo::Array<T,3> position = {0.,0.,0.};
-    const int & cid = pair.first;
-    const vector<int> & cell = pf->get_particles_per_cell().at(cid);
-    unsigned int size = 0;
-    for (const int pid : cell ) {
-      if (pid == -1) { continue; }
-      size++;
-      position += pf->particles[pid].sv.position;
-    }
-    if ( info_per_cell.find(cid) == info_per_cell.end() || !info_per_cell[cid].centerLocal) {
-      info_per_cell[cid].position = position/T(size);
-      info_per_cell[cid].centerLocal = pf->isContainedABS(info_per_cell[cid].position,pf->localDomain);
-    } else {
-     
-    }
-  }
-}
-void CellInformationFunctionals::CellStretch::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
-  HemoCellParticleField* pf = dynamic_cast<HemoCellParticleField*>(blocks[0]);
-  
-  for (const auto & pair : pf->get_lpc()) {
-    T max_stretch = 0.;
-    const int & cid = pair.first;
-    const vector<int> & cell = pf->get_particles_per_cell().at(cid);
-    for (unsigned int i = 0 ; i < cell.size() - 1 ; i++ ) {
-      for (unsigned int j = i + 1 ; j < cell.size() ; j ++) {
-        if (cell[i] == -1 || cell[j] == -1) {continue;}
-        T distance = sqrt( pow(pf->particles[cell[i]].sv.position[0]-pf->particles[cell[j]].sv.position[0],2) +
-                                pow(pf->particles[cell[i]].sv.position[1]-pf->particles[cell[j]].sv.position[1],2) +
-                                pow(pf->particles[cell[i]].sv.position[2]-pf->particles[cell[j]].sv.position[2],2));
-        max_stretch = max_stretch < distance ? distance : max_stretch;
-      }
-    }
-    info_per_cell[cid].stretch = max_stretch;
-  }
-}
-void CellInformationFunctionals::CellBoundingBox::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
-  HemoCellParticleField* pf = dynamic_cast<HemoCellParticleField*>(blocks[0]);
-  
-  for (const auto & pair : pf->get_lpc()) {
-    hemo::Array<T,6> bbox;
-    const int & cid = pair.first;
-    const vector<int> & cell = pf->get_particles_per_cell().at(cid);
-    HemoCellParticle * particle = &pf->particles[cell[0]];
-    
-    bbox[0] = particle->sv.position[0];
-    bbox[1] = particle->sv.position[0];
-    bbox[2] = particle->sv.position[1];
-    bbox[3] = particle->sv.position[1];
-    bbox[4] = particle->sv.position[2];
-    bbox[5] = particle->sv.position[2];
-    
-    for (const int pid : cell ) {
-      particle = &pf->particles[pid];
-      bbox[0] = bbox[0] > particle->sv.position[0] ? particle->sv.position[0] : bbox[0];
-      bbox[1] = bbox[1] < particle->sv.position[0] ? particle->sv.position[0] : bbox[1];
-      bbox[2] = bbox[2] > particle->sv.position[1] ? particle->sv.position[1] : bbox[2];
-      bbox[3] = bbox[3] < particle->sv.position[1] ? particle->sv.position[1] : bbox[3];
-      bbox[4] = bbox[4] > particle->sv.position[2] ? particle->sv.position[2] : bbox[4];
-      bbox[5] = bbox[5] < particle->sv.position[2] ? particle->sv.position[2] : bbox[5];
-    
-      }
-    info_per_cell[cid].bbox = bbox;
-  }
-}
-void CellInformationFunctionals::CellAtomicBlock::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
-  HemoCellParticleField* pf = dynamic_cast<HemoCellParticleField*>(blocks[0]);
-  
-  for (const auto & pair : pf->get_lpc()) {
-    const int & cid = pair.first;
-
-    info_per_cell[cid].blockId = pf->atomicBlockId;
-  }
-}
-void CellInformationFunctionals::CellType::processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks) {
-  HemoCellParticleField* pf = dynamic_cast<HemoCellParticleField*>(blocks[0]);
-  
-  for (const auto & pair : pf->get_lpc()) {
-    const int & cid = pair.first;
-
-    info_per_cell[cid].cellType = pf->particles[pf->get_particles_per_cell().at(cid)[0]].sv.celltype;
+// The largest distance between two vertices of the cell, see pointSetDiameter
+T CellInformationFunctionals::cellStretch(const vector<HemoCellParticle> & particles, const vector<int> & cell) {
+  vector<hemo::Array<T,3>> positions;
+  positions.reserve(cell.size());
+  for (const int pid : cell) {
+    positions.push_back(particles[pid].sv.getPosition());
   }
+  return pointSetDiameter(positions);
 }
 
-void CellInformationFunctionals::allCellInformation::processGenericBlocks(plb::Box3D domain, std::vector<plb::AtomicBlock3D*> blocks) {
+void CellInformationFunctionals::CellQuantities::processGenericBlocks(plb::Box3D domain, std::vector<plb::AtomicBlock3D*> blocks) {
   HemoCellParticleField* pf = dynamic_cast<HemoCellParticleField*>(blocks[0]);
   const map<int,vector<int>> & ppc = pf->get_particles_per_cell();
-  
-  
+
   for (const auto & pair : pf->get_lpc()) {
     const int & cid = pair.first;
     hemo::Array<T,6> bbox;
     hemo::Array<T,3> position = {0.,0.,0.};
     hemo::Array<T,3> velocity = {0.,0.,0.};
-    T max_stretch = 0., distance = 0.;
     T total_area = 0., volume = 0.;
     
     if (ppc.find(cid) == ppc.end()) { continue; }
     const vector<int> & cell = ppc.at(cid);
-    if (cell[0] == -1) { continue;}
+    if (find(cell.begin(), cell.end(), -1) != cell.end()) {
+      cout << "(CellInfoFunctional) Warning, incomplete cell detected, removing from output" << endl;
+      continue;
+    }
     
-    HemoCellParticle * particle = &pf->particles[cell[0]];
     const pluint ctype = pf->particles[cell[0]].sv.celltype;
-
-    //Bounding box init
-    bbox[0] = particle->sv.position[0];
-    bbox[1] = particle->sv.position[0];
-    bbox[2] = particle->sv.position[1];
-    bbox[3] = particle->sv.position[1];
-    bbox[4] = particle->sv.position[2];
-    bbox[5] = particle->sv.position[2];
-    
-    for (unsigned int i = 0 ; i < cell.size() ; i++ ) {
-      if (cell[i] == -1) { 
-        cout << "(CellInfoFunctional) Warning, incomplete cell detected, removing from output" << endl;
-        goto ignore_cell;
+    // Once the center of a cell is local to a block, the position (and the
+    // block it is on) of that block are kept
+    const bool owner = info_per_cell.find(cid) == info_per_cell.end() || !info_per_cell[cid].centerLocal;
+    CellInformation & cinfo = info_per_cell[cid];
+
+    if (quantities & (POSITION | VELOCITY | BOUNDING_BOX)) {
+      const hemo::Array<T,3> first = pf->particles[cell[0]].sv.getPosition();
+      bbox = {first[0], first[0], first[1], first[1], first[2], first[2]};
+
+      for (const int pid : cell) {
+        const HemoCellParticle & particle = pf->particles[pid];
+        const hemo::Array<T,3> vertex = particle.sv.getPosition();
+        position += vertex;
+        velocity += particle.sv.getVelocity();
+        for (int d = 0; d < 3; d++) {
+          bbox[2*d] = bbox[2*d] > vertex[d] ? vertex[d] : bbox[2*d];
+          bbox[2*d+1] = bbox[2*d+1] < vertex[d] ? vertex[d] : bbox[2*d+1];
+        }
       }
-      particle = &pf->particles[cell[i]];
-      
-      //Bounding Box
-      bbox[0] = bbox[0] > particle->sv.position[0] ? particle->sv.position[0] : bbox[0];
-      bbox[1] = bbox[1] < particle->sv.position[0] ? particle->sv.position[0] : bbox[1];
-      bbox[2] = bbox[2] > particle->sv.position[1] ? particle->sv.position[1] : bbox[2];
-      bbox[3] = bbox[3] < particle->sv.position[1] ? particle->sv.position[1] : bbox[3];
-      bbox[4] = bbox[4] > particle->sv.position[2] ? particle->sv.position[2] : bbox[4];
-      bbox[5] = bbox[5] < particle->sv.position[2] ? particle->sv.position[2] : bbox[5];
-      
-      //position
-      position += particle->sv.position;
-      
-      //velocity
-      velocity += particle->sv.v;
-      
-      //Cell stretch (max)
-      for (unsigned int j = i + 1 ; j < cell.size() ; j ++) {
-        if (cell[j] == -1) {goto ignore_cell;}
-        HemoCellParticle * particle2 = &pf->particles[cell[j]];
-        distance = sqrt( pow(particle->sv.position[0]-particle2->sv.position[0],2) +
-                                pow(particle->sv.position[1]-particle2->sv.position[1],2) +
-                                pow(particle->sv.position[2]-particle2->sv.position[2],2));
-        max_stretch = max_stretch < distance ? distance : max_stretch;
-      }
-
     }
 
-    for (hemo::Array<plint,3> triangle : (*hemocell->cellfields)[ctype]->mechanics->cellConstants.triangle_list) {
-      const hemo::Array<T,3> & v0 = pf->particles[cell[triangle[0]]].sv.position;
-      const hemo::Array<T,3> & v1 = pf->particles[cell[triangle[1]]].sv.position;
-      const hemo::Array<T,3> & v2 = pf->particles[cell[triangle[2]]].sv.position;
-
-      //area
-      total_area += computeTriangleArea(v0,v1,v2);  
-      
-      //Volume
-      const T v210 = v2[0]*v1[1]*v0[2];
-      const T v120 = v1[0]*v2[1]*v0[2];
-      const T v201 = v2[0]*v0[1]*v1[2];
-      const T v021 = v0[0]*v2[1]*v1[2];
-      const T v102 = v1[0]*v0[1]*v2[2];
-      const T v012 = v0[0]*v1[1]*v2[2];
-      volume += (1.0/6.0)*(-v210+v120+v201-v021-v102+v012);
+    if (quantities & (VOLUME | AREA)) {
+      for (const hemo::Array<plint,3> & triangle : (*hemocell->cellfields)[ctype]->mechanics->cellConstants.triangle_list) {
+        const hemo::Array<T,3> v0 = pf->particles[cell[triangle[0]]].sv.getPosition();
+        const hemo::Array<T,3> v1 = pf->particles[cell[triangle[1]]].sv.getPosition();
+        const hemo::Array<T,3> v2 = pf->particles[cell[triangle[2]]].sv.getPosition();
+
+        //area
+        total_area += computeTriangleArea(v0,v1,v2);  
+        
+        //Volume
+        const T v210 = v2[0]*v1[1]*v0[2];
+        const T v120 = v1[0]*v2[1]*v0[2];
+        const T v201 = v2[0]*v0[1]*v1[2];
+        const T v021 = v0[0]*v2[1]*v1[2];
+        const T v102 = v1[0]*v0[1]*v2[2];
+        const T v012 = v0[0]*v1[1]*v2[2];
+        volume += (1.0/6.0)*(-v210+v120+v201-v021-v102+v012);
+      }
     }
     
-    info_per_cell[cid].volume = volume;
-    info_per_cell[cid].area = total_area;
-    info_per_cell[cid].position = position/T(cell.size());
-    info_per_cell[cid].velocity = velocity/T(cell.size());
-    //It could be local on another block on the same processor
-    if (!info_per_cell[cid].centerLocal) {
-      info_per_cell[cid].centerLocal = pf->isContainedABS(info_per_cell[cid].position,pf->localDomain);
+    if (quantities & VOLUME) { cinfo.volume = volume; }
+    if (quantities & AREA) { cinfo.area = total_area; }
+    if ((quantities & POSITION) && owner) {
+      cinfo.position = position/T(cell.size());
+      //It could be local on another block on the same processor
+      cinfo.centerLocal = pf->isContainedABS(cinfo.position,pf->localDomain);
     }
+    if (quantities & VELOCITY) { cinfo.velocity = velocity/T(cell.size()); }
+    if (quantities & STRETCH) { cinfo.stretch = cellStretch(pf->particles, cell); }
+    if (quantities & BOUNDING_BOX) { cinfo.bbox = bbox; }
 
-    info_per_cell[cid].stretch = max_stretch;
-    info_per_cell[cid].blockId = pf->atomicBlockId;
-    info_per_cell[cid].cellType = pf->particles[pf->get_particles_per_cell().at(cid)[0]].sv.celltype;
-    info_per_cell[cid].bbox = bbox;    
-    info_per_cell[cid].base_cell_id = hemocell->cellfields->base_cell_id(cid);
-ignore_cell:;
+    if (owner) { cinfo.blockId = pf->atomicBlockId; }
+    cinfo.cellType = ctype;
+    cinfo.base_cell_id = hemocell->cellfields->base_cell_id(cid);
   }
-
 }
 
-void CellInformationFunctionals::calculateCellVolume(HemoCell * hemocell_) {
-  hemocell = hemocell_;
+void CellInformationFunctionals::calculateCellQuantities(HemoCell * hemocell, unsigned int quantities) {
   hemocell->cellfields->syncEnvelopes();
   hemocell->cellfields->deleteIncompleteCells(false);
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(hemocell->cellfields->immersedParticles);
-  applyProcessingFunctional(new CellVolume(),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
+  applyProcessingFunctional(new CellQuantities(hemocell,info_per_cell,quantities),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
 }
-void CellInformationFunctionals::calculateCellArea(HemoCell * hemocell_) {
-  hemocell = hemocell_;
-  hemocell->cellfields->syncEnvelopes();
-  hemocell->cellfields->deleteIncompleteCells(false);
-  vector<MultiBlock3D*> wrapper;
-  wrapper.push_back(hemocell->cellfields->immersedParticles);
-  applyProcessingFunctional(new CellArea(),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
+
+void CellInformationFunctionals::calculateCellVolume(HemoCell * hemocell) {
+  calculateCellQuantities(hemocell, VOLUME);
 }
-void CellInformationFunctionals::calculateCellPosition(HemoCell * hemocell_) {
-  hemocell = hemocell_;
-  hemocell->cellfields->syncEnvelopes();
-  hemocell->cellfields->deleteIncompleteCells(false);
-  vector<MultiBlock3D*> wrapper;
-  wrapper.push_back(hemocell->cellfields->immersedParticles);
-  applyProcessingFunctional(new CellPosition(),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
+void CellInformationFunctionals::calculateCellArea(HemoCell * hemocell) {
+  calculateCellQuantities(hemocell, AREA);
 }
-void CellInformationFunctionals::calculateCellStretch(HemoCell * hemocell_) {
-  hemocell = hemocell_;
-  hemocell->cellfields->syncEnvelopes();
-  hemocell->cellfields->deleteIncompleteCells(false);
-  vector<MultiBlock3D*> wrapper;
-  wrapper.push_back(hemocell->cellfields->immersedParticles);
-  applyProcessingFunctional(new CellStretch(),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
+void CellInformationFunctionals::calculateCellPosition(HemoCell * hemocell) {
+  calculateCellQuantities(hemocell, POSITION);
 }
-void CellInformationFunctionals::calculateCellBoundingBox(HemoCell * hemocell_) {
-  hemocell = hemocell_;
-  hemocell->cellfields->syncEnvelopes();
-  hemocell->cellfields->deleteIncompleteCells(false);
-  vector<MultiBlock3D*> wrapper;
-  wrapper.push_back(hemocell->cellfields->immersedParticles);
-  applyProcessingFunctional(new CellBoundingBox(),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
+void CellInformationFunctionals::calculateCellStretch(HemoCell * hemocell) {
+  calculateCellQuantities(hemocell, STRETCH);
 }
-void CellInformationFunctionals::calculateCellAtomicBlock(HemoCell* hemocell_) {
-  hemocell = hemocell_;
-  hemocell->cellfields->syncEnvelopes();
-  hemocell->cellfields->deleteIncompleteCells(false);
-  vector<MultiBlock3D*> wrapper;
-  wrapper.push_back(hemocell->cellfields->immersedParticles);
-  applyProcessingFunctional(new CellAtomicBlock(),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
+void CellInformationFunctionals::calculateCellBoundingBox(HemoCell * hemocell) {
+  calculateCellQuantities(hemocell, BOUNDING_BOX);
 }
-void CellInformationFunctionals::calculateCellType(HemoCell* hemocell_) {
-  hemocell = hemocell_;
-  hemocell->cellfields->syncEnvelopes();
-  hemocell->cellfields->deleteIncompleteCells(false);
-  vector<MultiBlock3D*> wrapper;
-  wrapper.push_back(hemocell->cellfields->immersedParticles);
-  applyProcessingFunctional(new CellType(),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
+void CellInformationFunctionals::calculateCellVelocity(HemoCell * hemocell) {
+  calculateCellQuantities(hemocell, VELOCITY);
+}
+// The block id and cell type are filled in by every pass
+void CellInformationFunctionals::calculateCellAtomicBlock(HemoCell* hemocell) {
+  calculateCellQuantities(hemocell, 0);
+}
+void CellInformationFunctionals::calculateCellType(HemoCell* hemocell) {
+  calculateCellQuantities(hemocell, 0);
 }
 pluint CellInformationFunctionals::getTotalNumberOfCells(HemoCell* hemocell) {
   info_per_cell.clear(); //TODO thread safe n such
@@ -343,8 +177,7 @@ pluint CellInformationFunctionals::getTotalNumberOfCells(HemoCell* hemocell) {
 }
 pluint CellInformationFunctionals::getNumberOfCellsFromType(HemoCell* hemocell, string type) {
   info_per_cell.clear(); //TODO thread safe n such
-  calculateCellPosition(hemocell); 
-  calculateCellType(hemocell);
+  calculateCellPosition(hemocell); // Fills in the cell type as well
   pluint localCells = 0;
   for (const auto & pair : info_per_cell) {
     const CellInformation & cinfo = pair.second;
@@ -364,30 +197,18 @@ pluint CellInformationFunctionals::getNumberOfCellsFromType(HemoCell* hemocell,
   return total;
 }
 
-void CellInformationFunctionals::calculateCellInformation(HemoCell * hemocell, map<int, CellInformation> & ret) {
+void CellInformationFunctionals::calculateCellInformation(HemoCell * hemocell, map<int, CellInformation> & ret, unsigned int quantities) {
   // Make it saver by not using static objects in functional;
   vector<MultiBlock3D*> wrapper;
   wrapper.push_back(hemocell->cellfields->immersedParticles);
   
   hemocell->cellfields->syncEnvelopes();
 
-  applyProcessingFunctional(new allCellInformation(hemocell,ret),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
+  applyProcessingFunctional(new CellQuantities(hemocell,ret,quantities),hemocell->cellfields->immersedParticles->getBoundingBox(),wrapper);
 }
 
-
-
-CellInformationFunctionals::CellVolume * CellInformationFunctionals::CellVolume::clone() const { return new CellInformationFunctionals::CellVolume(*this);}
-CellInformationFunctionals::CellArea * CellInformationFunctionals::CellArea::clone() const { return new CellInformationFunctionals::CellArea(*this);}
-CellInformationFunctionals::CellPosition * CellInformationFunctionals::CellPosition::clone() const { return new CellInformationFunctionals::CellPosition(*this);}
-CellInformationFunctionals::CellStretch * CellInformationFunctionals::CellStretch::clone() const { return new CellInformationFunctionals::CellStretch(*this);}
-CellInformationFunctionals::CellBoundingBox * CellInformationFunctionals::CellBoundingBox::clone() const { return new CellInformationFunctionals::CellBoundingBox(*this);}
-CellInformationFunctionals::CellAtomicBlock * CellInformationFunctionals::CellAtomicBlock::clone() const { return new CellInformationFunctionals::CellAtomicBlock(*this);}
-CellInformationFunctionals::CellType * CellInformationFunctionals::CellType::clone() const { return new CellInformationFunctionals::CellType(*this);}
-CellInformationFunctionals::allCellInformation * CellInformationFunctionals::allCellInformation::clone() const { return new CellInformationFunctionals::allCellInformation(*this);}
-
-
+CellInformationFunctionals::CellQuantities * CellInformationFunctionals::CellQuantities::clone() const { return new CellInformationFunctionals::CellQuantities(*this);}
 
 map<int,CellInformation> CellInformationFunctionals::info_per_cell = map<int,CellInformation>();
-HemoCell * CellInformationFunctionals::hemocell = 0;
 
-}
\ No newline at end of file
+}
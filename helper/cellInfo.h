@@ -31,9 +31,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /* THIS CLASS IS NOT THREAD SAFE!*/
 /* Calculate and store Cell-Specific Information
  * 
- * call the static members for the information you need 
- * (eg. CellInformationFunctionals::getCellVolume(hemocell))
- * then the information will be available in  the map:
+ * Request the quantities you need in a single pass, combined with |
+ * (eg. CellInformationFunctionals::calculateCellInformation(&hemocell, info,
+ *  CellInformationFunctionals::VOLUME | CellInformationFunctionals::POSITION))
+ * The block id, cell type and base cell id are always filled in.
+ *
+ * The legacy static members (eg. CellInformationFunctionals::calculateCellVolume(hemocell))
+ * store their results in the map:
  *  CellInformationFunctionals::info_per_cell
  * Clean the old cell results afterwards with 
  *  CellInformationFunctionals::clear_list()
@@ -55,56 +59,38 @@ struct CellInformation {
 };
 
 class CellInformationFunctionals {
-  // Legacy interface, remove at some point
-  static HemoCell * hemocell;
-  
-  class CellVolume: public HemoCellFunctional {
-  void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
-    CellVolume * clone() const;
-  };
-  class CellArea: public HemoCellFunctional {
-  void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
-    CellArea * clone() const;
-  };
-  class CellPosition: public HemoCellFunctional {
-  void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
-    CellPosition * clone() const;
-  };
-  class CellStretch: public HemoCellFunctional {
-  void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
-    CellStretch * clone() const;
-  };
-  class CellBoundingBox: public HemoCellFunctional {
-  void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
-    CellBoundingBox * clone() const;
-  };
-  class CellAtomicBlock: public HemoCellFunctional {
-  void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
-    CellAtomicBlock * clone() const;
-  };
-  class CellType: public HemoCellFunctional {
-  void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
-    CellType * clone() const;
+public:
+  /// Quantities that can be requested from calculateCellInformation
+  enum Quantity : unsigned int {
+    POSITION     = 1 << 0,
+    VELOCITY     = 1 << 1,
+    VOLUME       = 1 << 2,
+    AREA         = 1 << 3,
+    STRETCH      = 1 << 4,
+    BOUNDING_BOX = 1 << 5,
+    ALL          = (1 << 6) - 1
   };
-  //end legacy interface
-  
-  class allCellInformation: public HemoCellFunctional {
+
+private:
+  class CellQuantities: public HemoCellFunctional {
     HemoCell * hemocell;
     map<int,CellInformation> & info_per_cell;
+    unsigned int quantities;
   public:
-    allCellInformation(HemoCell * hemocell_, map<int,CellInformation> & info_per_cell_) :
-    hemocell(hemocell_), info_per_cell(info_per_cell_) {}
+    CellQuantities(HemoCell * hemocell_, map<int,CellInformation> & info_per_cell_, unsigned int quantities_) :
+    hemocell(hemocell_), info_per_cell(info_per_cell_), quantities(quantities_) {}
   private:
     void processGenericBlocks(plb::Box3D, std::vector<plb::AtomicBlock3D*>);
-    allCellInformation * clone() const;
+    CellQuantities * clone() const;
   };
   
-  
 public:
   // Legacy interface, should become private at some point.
   static map<int,CellInformation> info_per_cell;
   static void clear_list();
-  static void calculate_vol_pos_area(HemoCell *); /*This excludes Stretch, since it is compute intensive!*/
+  /// Calculate the requested quantities (Quantity flags) of the complete cells in one pass
+  static void calculateCellQuantities(HemoCell *, unsigned int quantities);
+  static void calculate_vol_pos_area(HemoCell *); /*This excludes Stretch*/
   static void calculateCellVolume(HemoCell *);
   static void calculateCellArea(HemoCell *);
   static void calculateCellPosition(HemoCell *);
@@ -117,9 +103,11 @@ public:
   //Interface that should be used, less error prone at the cost of some extra computation and memory usage 
   static pluint getTotalNumberOfCells(HemoCell *);
   static pluint getNumberOfCellsFromType(HemoCell *, string type);
-  /// Calculate all possible macroscopic information and return it within the reference.
-  static void calculateCellInformation(HemoCell *, map<int, CellInformation> &);
-  
+  /// Calculate the requested macroscopic information (Quantity flags) in a single pass and return it within the reference.
+  static void calculateCellInformation(HemoCell *, map<int, CellInformation> &, unsigned int quantities = ALL);
+
+  /// Largest distance between two vertices of a cell
+  static T cellStretch(const std::vector<HemoCellParticle> & particles, const std::vector<int> & cell);
 };
 }
 #endif
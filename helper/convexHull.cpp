@@ -0,0 +1,288 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab
+in the University of Amsterdam. Any questions or remarks regarding this library
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "convexHull.h"
+
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+
+namespace hemo {
+
+using namespace std;
+
+namespace {
+
+struct HullFace {
+  unsigned int v[3];
+  hemo::Array<T,3> normal; // Outward, unit length
+  T offset;                // normal*x on the plane of the face
+  bool alive;
+  unsigned int stamp;      // Last point that saw this face
+  vector<unsigned int> conflicts; // Points in front of the face
+};
+
+class HullBuilder {
+public:
+  HullBuilder(const vector<hemo::Array<T,3>> & points_, const hemo::Array<T,3> & interior_, T eps_)
+    : points(points_), interior(interior_), eps(eps_), pointFaces(points_.size()), pointStamp(points_.size(), 0) {}
+
+  bool inFront(const HullFace & face, unsigned int p) const {
+    return dot(face.normal, points[p]) - face.offset > eps;
+  }
+
+  // Adds the face (a,b,c), oriented away from the interior point
+  unsigned int addFace(unsigned int a, unsigned int b, unsigned int c) {
+    HullFace face;
+    hemo::Array<T,3> normal = crossProduct(points[b] - points[a], points[c] - points[a]);
+    if (dot(normal, interior - points[a]) > 0) {
+      swap(b, c);
+      normal = -1.*normal;
+    }
+    face.v[0] = a; face.v[1] = b; face.v[2] = c;
+    face.normal = normal/norm(normal);
+    face.offset = dot(face.normal, points[a]);
+    face.alive = true;
+    face.stamp = 0;
+    faces.push_back(face);
+    const unsigned int f = faces.size() - 1;
+    for (int e = 0; e < 3; e++) {
+      edges[edgeKey(faces[f].v[e], faces[f].v[(e+1)%3])] = f;
+    }
+    return f;
+  }
+
+  void addConflict(unsigned int f, unsigned int p) {
+    faces[f].conflicts.push_back(p);
+    pointFaces[p].push_back(f);
+  }
+
+  // Replaces the faces point p lies in front of by a cone from the horizon to p
+  void addPoint(unsigned int p) {
+    const unsigned int stamp = p + 1;
+    vector<unsigned int> visible;
+    for (const unsigned int f : pointFaces[p]) {
+      if (faces[f].alive) {
+        faces[f].stamp = stamp;
+        visible.push_back(f);
+      }
+    }
+    if (visible.empty()) { return; }
+
+    struct Horizon { unsigned int a, b, inside, outside; };
+    vector<Horizon> horizon;
+    for (const unsigned int f : visible) {
+      for (int e = 0; e < 3; e++) {
+        const unsigned int a = faces[f].v[e], b = faces[f].v[(e+1)%3];
+        const unsigned int neighbour = edges.at(edgeKey(b, a));
+        if (faces[neighbour].stamp != stamp) {
+          horizon.push_back({a, b, f, neighbour});
+        }
+      }
+    }
+
+    for (const unsigned int f : visible) {
+      faces[f].alive = false;
+      for (int e = 0; e < 3; e++) {
+        edges.erase(edgeKey(faces[f].v[e], faces[f].v[(e+1)%3]));
+      }
+    }
+
+    for (const Horizon & edge : horizon) {
+      const unsigned int f = addFace(edge.a, edge.b, p);
+      const unsigned int faceStamp = f + 1;
+      // A point in front of the new face was in front of one of the faces that share its horizon edge
+      for (const unsigned int candidates : {edge.inside, edge.outside}) {
+        for (const unsigned int q : faces[candidates].conflicts) {
+          if (q == p || pointStamp[q] == faceStamp) { continue; }
+          pointStamp[q] = faceStamp;
+          if (inFront(faces[f], q)) { addConflict(f, q); }
+        }
+      }
+    }
+
+    for (const unsigned int f : visible) {
+      vector<unsigned int>().swap(faces[f].conflicts);
+    }
+    vector<unsigned int>().swap(pointFaces[p]);
+  }
+
+  const vector<hemo::Array<T,3>> & points;
+  const hemo::Array<T,3> interior;
+  const T eps;
+  vector<HullFace> faces;
+  vector<vector<unsigned int>> pointFaces;
+  vector<unsigned int> pointStamp;
+  unordered_map<uint64_t,unsigned int> edges; // Directed edge to the face it bounds
+
+private:
+  static uint64_t edgeKey(unsigned int a, unsigned int b) { return uint64_t(a) << 32 | b; }
+};
+
+}
+
+vector<unsigned int> convexHullVertices(const vector<hemo::Array<T,3>> & points) {
+  vector<unsigned int> all(points.size());
+  for (unsigned int i = 0; i < points.size(); i++) { all[i] = i; }
+  if (points.size() < 4) { return all; }
+
+  hemo::Array<T,3> low = points[0], high = points[0];
+  for (const hemo::Array<T,3> & point : points) {
+    for (int d = 0; d < 3; d++) {
+      low[d] = min(low[d], point[d]);
+      high[d] = max(high[d], point[d]);
+    }
+  }
+  const T eps = 1e-10*max(max(high[0]-low[0], high[1]-low[1]), high[2]-low[2]);
+
+  // Initial tetrahedron: the points farthest from each other, from their line and from their plane
+  unsigned int t[4] = {0, 0, 0, 0};
+  for (unsigned int i = 0; i < points.size(); i++) {
+    if (points[i][0] < points[t[0]][0]) { t[0] = i; }
+  }
+  T best = 0;
+  for (unsigned int i = 0; i < points.size(); i++) {
+    const T d = norm(points[i] - points[t[0]]);
+    if (d > best) { best = d; t[1] = i; }
+  }
+  if (best <= eps) { return all; }
+  const hemo::Array<T,3> axis = (points[t[1]] - points[t[0]])/best;
+  best = 0;
+  for (unsigned int i = 0; i < points.size(); i++) {
+    const T d = norm(crossProduct(points[i] - points[t[0]], axis));
+    if (d > best) { best = d; t[2] = i; }
+  }
+  if (best <= eps) { return all; }
+  hemo::Array<T,3> normal = crossProduct(points[t[1]] - points[t[0]], points[t[2]] - points[t[0]]);
+  normal = normal/norm(normal);
+  best = 0;
+  for (unsigned int i = 0; i < points.size(); i++) {
+    const T d = fabs(dot(points[i] - points[t[0]], normal));
+    if (d > best) { best = d; t[3] = i; }
+  }
+  if (best <= eps) { return all; }
+
+  const hemo::Array<T,3> interior = (points[t[0]] + points[t[1]] + points[t[2]] + points[t[3]])*0.25;
+  HullBuilder hull(points, interior, eps);
+  const unsigned int first[4] = {hull.addFace(t[0], t[1], t[2]), hull.addFace(t[0], t[1], t[3]),
+                                 hull.addFace(t[0], t[2], t[3]), hull.addFace(t[1], t[2], t[3])};
+  for (unsigned int i = 0; i < points.size(); i++) {
+    for (const unsigned int f : first) {
+      if (hull.inFront(hull.faces[f], i)) { hull.addConflict(f, i); }
+    }
+  }
+
+  // The expected cost only holds for a random insertion order, the fixed seed
+  // keeps the result reproducible
+  vector<unsigned int> order;
+  for (unsigned int i = 0; i < points.size(); i++) {
+    if (i != t[0] && i != t[1] && i != t[2] && i != t[3]) { order.push_back(i); }
+  }
+  shuffle(order.begin(), order.end(), mt19937(1));
+  for (const unsigned int p : order) {
+    hull.addPoint(p);
+  }
+
+  vector<char> onHull(points.size(), 0);
+  for (const HullFace & face : hull.faces) {
+    if (!face.alive) { continue; }
+    for (int v = 0; v < 3; v++) { onHull[face.v[v]] = 1; }
+  }
+  vector<unsigned int> vertices;
+  for (unsigned int i = 0; i < points.size(); i++) {
+    if (onHull[i]) { vertices.push_back(i); }
+  }
+  return vertices;
+}
+
+// The farthest pair of hull vertices along 13 directions (axes, face and body
+// diagonals), improved by hopping to the farthest vertex, gives a lower bound L
+// close to the diameter. Two vertices can only be further apart than L if the
+// sum of their distances to a center exceeds L, so with the vertices sorted on
+// that distance only a few pairs around the tips remain to be checked.
+T pointSetDiameter(const vector<hemo::Array<T,3>> & points) {
+  static const T directions[13][3] = {{1,0,0}, {0,1,0}, {0,0,1}, {1,1,0}, {1,-1,0}, {1,0,1}, {1,0,-1},
+                                      {0,1,1}, {0,1,-1}, {1,1,1}, {1,1,-1}, {1,-1,1}, {-1,1,1}};
+  if (points.size() < 2) { return 0.; }
+  const vector<unsigned int> hull = convexHullVertices(points);
+
+  auto distance2 = [&](unsigned int a, unsigned int b) {
+    const hemo::Array<T,3> d = points[a] - points[b];
+    return d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+  };
+
+  unsigned int low[13], high[13];
+  T lowest[13], highest[13];
+  for (int k = 0; k < 13; k++) {
+    const hemo::Array<T,3> & x = points[hull[0]];
+    low[k] = high[k] = hull[0];
+    lowest[k] = highest[k] = x[0]*directions[k][0] + x[1]*directions[k][1] + x[2]*directions[k][2];
+  }
+  for (const unsigned int i : hull) {
+    const hemo::Array<T,3> & x = points[i];
+    for (int k = 0; k < 13; k++) {
+      const T projection = x[0]*directions[k][0] + x[1]*directions[k][1] + x[2]*directions[k][2];
+      if (projection < lowest[k]) { lowest[k] = projection; low[k] = i; }
+      if (projection > highest[k]) { highest[k] = projection; high[k] = i; }
+    }
+  }
+
+  unsigned int a = low[0], b = high[0];
+  T best = distance2(a, b);
+  for (int k = 1; k < 13; k++) {
+    const T d2 = distance2(low[k], high[k]);
+    if (d2 > best) { best = d2; a = low[k]; b = high[k]; }
+  }
+  for (int hop = 0; hop < 8; hop++) {
+    unsigned int farthest = b;
+    for (const unsigned int i : hull) {
+      const T d2 = distance2(b, i);
+      if (d2 > best) { best = d2; farthest = i; }
+    }
+    if (farthest == b) { break; }
+    a = b;
+    b = farthest;
+  }
+
+  const hemo::Array<T,3> center = (points[a] + points[b])*0.5;
+  vector<pair<T,unsigned int>> radius;
+  radius.reserve(hull.size());
+  for (const unsigned int i : hull) {
+    radius.push_back({computeLength(points[i] - center), i});
+  }
+  sort(radius.begin(), radius.end(), [](const pair<T,unsigned int> & l, const pair<T,unsigned int> & r) { return l.first > r.first; });
+
+  T bound = sqrt(best);
+  for (unsigned int i = 0; i < radius.size() && radius[i].first + radius[0].first > bound; i++) {
+    for (unsigned int j = i + 1; j < radius.size() && radius[i].first + radius[j].first > bound; j++) {
+      const T d2 = distance2(radius[i].second, radius[j].second);
+      if (d2 > best) {
+        best = d2;
+        bound = sqrt(best);
+      }
+    }
+  }
+  return sqrt(best);
+}
+
+}
@@ -0,0 +1,49 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab
+in the University of Amsterdam. Any questions or remarks regarding this library
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef HEMO_CONVEX_HULL_H
+#define HEMO_CONVEX_HULL_H
+
+#include "array.h"
+
+#include <vector>
+
+namespace hemo {
+
+/**
+ * Indices of the points that are a vertex of their convex hull.
+ *
+ * The hull is built with the randomized incremental algorithm, every point
+ * keeps the faces it lies in front of, so adding a point only visits the faces
+ * it replaces (expected O(n log n)). Points within a relative distance of 1e-10
+ * of the hull are not a vertex. When the points span no volume all of them are
+ * returned.
+ */
+std::vector<unsigned int> convexHullVertices(const std::vector<hemo::Array<T,3>> & points);
+
+/// Largest distance between two of the points, searched over the vertices of
+/// their convex hull only
+T pointSetDiameter(const std::vector<hemo::Array<T,3>> & points);
+
+}
+#endif
@@ -152,7 +152,7 @@ FluidStatistics FluidInfo::calculateForceStatistics(HemoCell* hemocell) {
 
   plb::setExternalVector(*hemocell->lattice, (*hemocell->lattice).getBoundingBox(),
           DESCRIPTOR<T>::ExternalField::forceBeginsAt,
-          plb::Array<T, DESCRIPTOR<T>::d>(0.0, 0.0, 0.0));
+          plb::Array<T, DESCRIPTOR<T>::d>(hemocell->bodyForce[0], hemocell->bodyForce[1], hemocell->bodyForce[2]));
   
   return result;
 }
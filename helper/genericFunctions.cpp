@@ -135,27 +135,65 @@ void printHeader()
 #include "palabos3D.hh"
 
 namespace hemo {
-void boundaryFromFlagMatrix(plb::MultiBlockLattice3D<T,DESCRIPTOR> * fluid, plb::MultiScalarField3D<int> * flagMatrix, bool partOfpreInlet) {
-  plb::Box3D domain2 = flagMatrix->getBoundingBox();
-  for (int x  = domain2.x0-1 ; x <= domain2.x1+1 ; x++) {
-   for (int y  = domain2.y0-1 ; y <= domain2.y1+1 ; y++) {
-    for (int z  = domain2.z0-1 ; z <= domain2.z1+1 ; z++) {
-      if ((x == domain2.x0-1 || y == domain2.y0-1 || z == domain2.z0-1 || x == domain2.x1+1 || y == domain2.y1+1 || z == domain2.z1+1) && !partOfpreInlet ) {
-        defineDynamics(*fluid,x,y,z,new plb::BounceBack<T,DESCRIPTOR>(1.));
+BounceBackFromFlagMatrix::BounceBackFromFlagMatrix() : bounceBack(new plb::BounceBack<T,DESCRIPTOR>(1.)) { }
+
+BounceBackFromFlagMatrix::BounceBackFromFlagMatrix(const BounceBackFromFlagMatrix & rhs) : bounceBack(rhs.bounceBack->clone()) { }
+
+BounceBackFromFlagMatrix::~BounceBackFromFlagMatrix() {
+  delete bounceBack;
+}
+
+void BounceBackFromFlagMatrix::process(plb::Box3D domain, plb::BlockLattice3D<T,DESCRIPTOR> &lattice, plb::ScalarField3D<int> &flags) {
+  const plb::Dot3D offset = plb::computeRelativeDisplacement(lattice, flags);
+  for (plb::plint x = domain.x0; x <= domain.x1; x++) {
+    for (plb::plint y = domain.y0; y <= domain.y1; y++) {
+      for (plb::plint z = domain.z0; z <= domain.z1; z++) {
+        if (flags.get(x+offset.x,y+offset.y,z+offset.z) == 0 && !lattice.get(x,y,z).getDynamics().isBoundary()) {
+          lattice.attributeDynamics(x,y,z,bounceBack->clone());
+        }
       }
     }
-   }
   }
-  
-  for (int x  = domain2.x0 ; x <= domain2.x1 ; x++) {
-   for (int y  = domain2.y0 ; y <= domain2.y1 ; y++) {
-    for (int z  = domain2.z0 ; z <= domain2.z1 ; z++) {
-      if (flagMatrix->get(x,y,z) == 0 && !partOfpreInlet) {
-        defineDynamics(*fluid,x,y,z,new plb::BounceBack<T,DESCRIPTOR>(1.));
-      }
+}
+
+BounceBackFromFlagMatrix *BounceBackFromFlagMatrix::clone() const {
+  return new BounceBackFromFlagMatrix(*this);
+}
+
+void BounceBackFromFlagMatrix::getTypeOfModification(std::vector<plb::modif::ModifT> &modified) const {
+  modified[0] = plb::modif::dataStructure;
+  modified[1] = plb::modif::nothing;
+}
+
+plb::BlockDomain::DomainT BounceBackFromFlagMatrix::appliesTo() const {
+  return plb::BlockDomain::bulk;
+}
+
+void boundaryFromFlagMatrix(plb::MultiBlockLattice3D<T,DESCRIPTOR> * fluid, plb::MultiScalarField3D<int> * flagMatrix, bool partOfpreInlet) {
+  if (partOfpreInlet) {
+    return;
+  }
+  const plb::Box3D domain = flagMatrix->getBoundingBox();
+
+  // The layer around the flag matrix, only exists when the lattice is larger
+  const plb::Box3D layers[6] = {
+    plb::Box3D(domain.x0-1,domain.x0-1,domain.y0-1,domain.y1+1,domain.z0-1,domain.z1+1),
+    plb::Box3D(domain.x1+1,domain.x1+1,domain.y0-1,domain.y1+1,domain.z0-1,domain.z1+1),
+    plb::Box3D(domain.x0,domain.x1,domain.y0-1,domain.y0-1,domain.z0-1,domain.z1+1),
+    plb::Box3D(domain.x0,domain.x1,domain.y1+1,domain.y1+1,domain.z0-1,domain.z1+1),
+    plb::Box3D(domain.x0,domain.x1,domain.y0,domain.y1,domain.z0-1,domain.z0-1),
+    plb::Box3D(domain.x0,domain.x1,domain.y0,domain.y1,domain.z1+1,domain.z1+1)
+  };
+  for (const plb::Box3D & layer : layers) {
+    plb::Box3D inLattice;
+    if (plb::intersect(layer, fluid->getBoundingBox(), inLattice)) {
+      defineDynamics(*fluid,inLattice,new plb::BounceBack<T,DESCRIPTOR>(1.));
     }
-   }
   }
+
+  // All solid nodes at once, per atomic block
+  applyProcessingFunctional(new BounceBackFromFlagMatrix(), domain, *fluid, *flagMatrix);
 }
 
+
 }
\ No newline at end of file
@@ -90,9 +90,30 @@ void printHeader();
 }
 #include "multiBlock/multiBlockLattice3D.h"
 #include "multiBlock/multiDataField3D.h"
+#include "atomicBlock/dataProcessingFunctional3D.h"
 #include "constant_defaults.h"
 namespace hemo {
+/// Bounce back on all solid nodes (flag 0) and on the layer around the flag matrix
 void boundaryFromFlagMatrix(plb::MultiBlockLattice3D<T,DESCRIPTOR> * fluid, plb::MultiScalarField3D<int> * flagMatrix, bool); 
+
+/// Attributes a clone of one BounceBack to every solid node of an atomic block that is not a boundary yet
+class BounceBackFromFlagMatrix : public plb::BoxProcessingFunctional3D_LS<T,DESCRIPTOR,int> {
+public:
+    BounceBackFromFlagMatrix();
+    BounceBackFromFlagMatrix(const BounceBackFromFlagMatrix & rhs);
+    ~BounceBackFromFlagMatrix();
+
+    virtual void process(plb::Box3D domain, plb::BlockLattice3D<T,DESCRIPTOR> &lattice, plb::ScalarField3D<int> &flags);
+
+    virtual BounceBackFromFlagMatrix *clone() const;
+
+    virtual void getTypeOfModification(std::vector<plb::modif::ModifT> &modified) const;
+
+    virtual plb::BlockDomain::DomainT appliesTo() const;
+
+private:
+    plb::Dynamics<T,DESCRIPTOR> * bounceBack;
+};
 inline std::ostream& operator<<(std::ostream& stream, const plb::Box3D& box) {
     return stream << "Box3D: " << box.x0 << " "<<box.x1<<" "<<box.y0<<" "<<box.y1<< " "<<box.z0<<" "<<box.z1<<endl;
 }
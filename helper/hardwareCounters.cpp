@@ -0,0 +1,96 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "hardwareCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace hemo {
+
+int HardwareCounters::fd[HardwareCounters::NUMBER_OF_COUNTERS] = {-1, -1, -1};
+
+const char * HardwareCounters::name(int counter) {
+  static const char * names[NUMBER_OF_COUNTERS] = {"cycles", "instructions", "llcMisses"};
+  return names[counter];
+}
+
+#ifdef __linux__
+bool HardwareCounters::open() {
+  if (isOpen()) { return true; }
+  static const uint64_t configs[NUMBER_OF_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+
+  for (int i = 0 ; i < NUMBER_OF_COUNTERS ; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[i];
+    attr.disabled = (i == 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, (i == 0) ? -1 : fd[0], 0);
+    if (fd[i] < 0) {
+      close();
+      return false;
+    }
+  }
+  ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+}
+
+void HardwareCounters::read(Values & values) {
+  // nr, time_enabled, time_running, value[nr]
+  uint64_t buffer[3 + NUMBER_OF_COUNTERS];
+  if (!isOpen() || ::read(fd[0], buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer) || buffer[2] == 0) {
+    values.fill(0);
+    return;
+  }
+  const double scale = (double)buffer[1]/buffer[2];
+  for (int i = 0 ; i < NUMBER_OF_COUNTERS ; i++) {
+    values[i] = buffer[3 + i]*scale;
+  }
+}
+
+void HardwareCounters::close() {
+  for (int i = NUMBER_OF_COUNTERS - 1 ; i >= 0 ; i--) {
+    if (fd[i] >= 0) { ::close(fd[i]); }
+    fd[i] = -1;
+  }
+}
+#else
+bool HardwareCounters::open() { return false; }
+void HardwareCounters::read(Values & values) { values.fill(0); }
+void HardwareCounters::close() {}
+#endif
+
+}
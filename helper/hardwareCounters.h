@@ -0,0 +1,56 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HARDWARE_COUNTERS_H
+#define HARDWARE_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+
+namespace hemo {
+/**
+ * Hardware performance counters of the calling process, read through the
+ * Linux perf_event_open interface as a single group: cycles, instructions and
+ * last level cache misses. The values are scaled for multiplexing.
+ *
+ * open() returns false when the counters are not available (no Linux, a
+ * restrictive perf_event_paranoid, no PMU in a virtual machine), read() then
+ * returns zeros.
+ */
+class HardwareCounters {
+public:
+  enum Counter { CYCLES, INSTRUCTIONS, LLC_MISSES, NUMBER_OF_COUNTERS };
+  typedef std::array<uint64_t,NUMBER_OF_COUNTERS> Values;
+
+  static bool open();
+  static bool isOpen() { return fd[0] >= 0; }
+  static void read(Values & values);
+  static void close();
+  static const char * name(int counter);
+
+private:
+  static int fd[NUMBER_OF_COUNTERS];
+};
+}
+#endif /* HARDWARE_COUNTERS_H */
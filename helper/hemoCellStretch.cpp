@@ -45,7 +45,7 @@ void HemoCellStretch::FindForcedLsps::processGenericBlocks(Box3D domain, std::ve
   HemoCellParticle * tmp;
   for (unsigned int i = 0 ; i <  found.size() - 1 ; i++) {
     for (unsigned int j = 1 ; j < found.size() - i ; j++) {
-      if (found[j-1]->sv.position[0] > found[j]->sv.position[0]) {
+      if (found[j-1]->sv.getPosition()[0] > found[j]->sv.getPosition()[0]) {
         tmp = found[j-1];
         found[j-1] = found[j];
         found[j] = tmp;
@@ -0,0 +1,286 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab
+in the University of Amsterdam. Any questions or remarks regarding this library
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "inflowRecording.h"
+#include "hemoCellParticle.h"
+
+#include <hdf5_hl.h>
+#include <climits>
+#include <iostream>
+
+#define INFLOW_PARTICLE_CHUNK 65536
+#define INFLOW_FRAME_CHUNK 1024
+
+namespace hemo {
+
+static hid_t nativeTypeOfT() {
+  return sizeof(T) == sizeof(double) ? H5T_NATIVE_DOUBLE : H5T_NATIVE_FLOAT;
+}
+
+// Dataset with an unlimited first dimension, compressed the same way as the particle output
+static hid_t createExtendibleDataset(hid_t file, const char * name, hid_t type, int rank, const hsize_t * chunk) {
+  hsize_t dims[2] = {0, rank > 1 ? chunk[1] : 0};
+  hsize_t maxDims[2] = {H5S_UNLIMITED, rank > 1 ? chunk[1] : 0};
+  hid_t sid = H5Screate_simple(rank,dims,maxDims);
+  hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(plist_id,rank,chunk);
+  H5Pset_deflate(plist_id,7);
+  hid_t did = H5Dcreate2(file,name,type,sid,H5P_DEFAULT,plist_id,H5P_DEFAULT);
+  H5Pclose(plist_id);
+  H5Sclose(sid);
+  return did;
+}
+
+static void appendToDataset(hid_t did, hid_t type, int rank, hsize_t start, const hsize_t * count, const void * data) {
+  if (count[0] == 0) { return; }
+  hsize_t dims[2] = {start + count[0], rank > 1 ? count[1] : 0};
+  hsize_t offset[2] = {start, 0};
+  H5Dset_extent(did,dims);
+  hid_t fileSpace = H5Dget_space(did);
+  H5Sselect_hyperslab(fileSpace,H5S_SELECT_SET,offset,NULL,count,NULL);
+  hid_t memSpace = H5Screate_simple(rank,count,NULL);
+  H5Dwrite(did,type,memSpace,fileSpace,H5P_DEFAULT,data);
+  H5Sclose(memSpace);
+  H5Sclose(fileSpace);
+}
+
+static void readFromDataset(hid_t did, hid_t type, int rank, const hsize_t * offset, const hsize_t * count, void * data) {
+  if (count[0] == 0) { return; }
+  hid_t fileSpace = H5Dget_space(did);
+  H5Sselect_hyperslab(fileSpace,H5S_SELECT_SET,offset,NULL,count,NULL);
+  hid_t memSpace = H5Screate_simple(rank,count,NULL);
+  H5Dread(did,type,memSpace,fileSpace,H5P_DEFAULT,data);
+  H5Sclose(memSpace);
+  H5Sclose(fileSpace);
+}
+
+InflowRecorder::InflowRecorder(const std::string & fileName, const std::vector<plb::Box3D> & velocityBoxes)
+  : minCellId(LLONG_MAX), maxCellId(LLONG_MIN)
+{
+  file = H5Fcreate(fileName.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  if (file < 0) {
+    std::cout << "(InflowRecorder) (Error) Cannot create " << fileName << ", exiting ..." << std::endl;
+    exit(1);
+  }
+
+  std::vector<long> boxes;
+  for (const plb::Box3D & box : velocityBoxes) {
+    boxes.insert(boxes.end(),{(long)box.x0,(long)box.x1,(long)box.y0,(long)box.y1,(long)box.z0,(long)box.z1});
+    velocitySize += 3*box.nCells();
+  }
+  int nBoxes = velocityBoxes.size();
+  H5LTset_attribute_int(file, "/", "numberOfVelocityBoxes", &nBoxes, 1);
+  if (nBoxes) {
+    H5LTset_attribute_long(file, "/", "velocityBoxes", &boxes[0], boxes.size());
+  }
+
+  hsize_t frameChunk[1] = {INFLOW_FRAME_CHUNK};
+  hsize_t particleChunk[1] = {INFLOW_PARTICLE_CHUNK};
+  iterationSet = createExtendibleDataset(file,"iteration",H5T_NATIVE_UINT,1,frameChunk);
+  countSet = createExtendibleDataset(file,"particleCount",H5T_NATIVE_ULLONG,1,frameChunk);
+  particleSet = createExtendibleDataset(file,"particles",H5T_NATIVE_UCHAR,1,particleChunk);
+  if (velocitySize) {
+    hsize_t velocityChunk[2] = {1, velocitySize};
+    velocitySet = createExtendibleDataset(file,"velocity",nativeTypeOfT(),2,velocityChunk);
+  } else {
+    velocitySet = -1;
+  }
+}
+
+InflowRecorder::~InflowRecorder() {
+  // Range of the recorded cell ids, used to give replayed cells unique ids
+  H5LTset_attribute_long_long(file, "/", "minCellId", &minCellId, 1);
+  H5LTset_attribute_long_long(file, "/", "maxCellId", &maxCellId, 1);
+  H5Dclose(iterationSet);
+  H5Dclose(countSet);
+  H5Dclose(particleSet);
+  if (velocitySet >= 0) {
+    H5Dclose(velocitySet);
+  }
+  H5Fclose(file);
+}
+
+void InflowRecorder::writeFrame(unsigned int iteration, const std::vector<char> & particles, const std::vector<T> & velocity) {
+  const size_t particleSize = sizeof(HemoCellParticle::serializeValues_t);
+  for (size_t pos = 0 ; pos + particleSize <= particles.size() ; pos += particleSize) {
+    const HemoCellParticle::serializeValues_t * sv = (const HemoCellParticle::serializeValues_t *)&particles[pos];
+    minCellId = std::min(minCellId,(long long)sv->cellId);
+    maxCellId = std::max(maxCellId,(long long)sv->cellId);
+  }
+
+  hsize_t one[1] = {1};
+  appendToDataset(iterationSet,H5T_NATIVE_UINT,1,frames,one,&iteration);
+  unsigned long long count = particles.size()/particleSize;
+  appendToDataset(countSet,H5T_NATIVE_ULLONG,1,frames,one,&count);
+  hsize_t bytes[1] = {particles.size()};
+  appendToDataset(particleSet,H5T_NATIVE_UCHAR,1,particleBytes,bytes,particles.data());
+  particleBytes += particles.size();
+  if (velocitySet >= 0) {
+    if (velocity.size() != velocitySize) {
+      std::cout << "(InflowRecorder) (Error) Velocity slab does not match the recorded inlet nodes, exiting ..." << std::endl;
+      exit(1);
+    }
+    hsize_t row[2] = {1, velocitySize};
+    appendToDataset(velocitySet,nativeTypeOfT(),2,frames,row,velocity.data());
+  }
+  frames++;
+}
+
+void InflowRecorder::writeIndex(const std::string & fileName, const std::vector<int> & parts,
+                                int direction, int preinletLength, const plb::Box3D & fluidInlet, int numberOfCells) {
+  hid_t file = H5Fcreate((fileName + ".h5").c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  if (file < 0) {
+    std::cout << "(InflowRecorder) (Error) Cannot create " << fileName << ".h5, exiting ..." << std::endl;
+    exit(1);
+  }
+  int nParts = parts.size();
+  int particleSize = sizeof(HemoCellParticle::serializeValues_t);
+  long inlet[6] = {(long)fluidInlet.x0,(long)fluidInlet.x1,(long)fluidInlet.y0,(long)fluidInlet.y1,(long)fluidInlet.z0,(long)fluidInlet.z1};
+  H5LTset_attribute_int(file, "/", "numberOfParts", &nParts, 1);
+  if (nParts) {
+    H5LTset_attribute_int(file, "/", "parts", &parts[0], nParts);
+  }
+  H5LTset_attribute_int(file, "/", "direction", &direction, 1);
+  H5LTset_attribute_int(file, "/", "preinletLength", &preinletLength, 1);
+  H5LTset_attribute_int(file, "/", "particleSize", &particleSize, 1);
+  H5LTset_attribute_int(file, "/", "numberOfCells", &numberOfCells, 1);
+  H5LTset_attribute_long(file, "/", "fluidInlet", inlet, 6);
+  H5Fclose(file);
+}
+
+InflowReplay::InflowReplay(const std::string & fileName) {
+  hid_t index = H5Fopen((fileName + ".h5").c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (index < 0) {
+    std::cout << "(InflowReplay) (Error) Cannot open recording " << fileName << ".h5, exiting ..." << std::endl;
+    exit(1);
+  }
+  int nParts = 0, particleSize = 0;
+  H5LTget_attribute_int(index, "/", "numberOfParts", &nParts);
+  H5LTget_attribute_int(index, "/", "particleSize", &particleSize);
+  H5LTget_attribute_int(index, "/", "direction", &direction);
+  H5LTget_attribute_int(index, "/", "preinletLength", &preinletLength);
+  H5LTget_attribute_int(index, "/", "numberOfCells", &numberOfCells);
+  std::vector<int> ranks(nParts);
+  if (nParts) {
+    H5LTget_attribute_int(index, "/", "parts", &ranks[0]);
+  }
+  H5Fclose(index);
+
+  if (particleSize != (int)sizeof(HemoCellParticle::serializeValues_t)) {
+    std::cout << "(InflowReplay) (Error) " << fileName << " was recorded with a different particle layout (precision or material integration), exiting ..." << std::endl;
+    exit(1);
+  }
+
+  frames = nParts ? ULLONG_MAX : 0;
+  for (int rank : ranks) {
+    Part part;
+    std::string partName = fileName + "." + std::to_string(rank) + ".h5";
+    part.file = H5Fopen(partName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (part.file < 0) {
+      std::cout << "(InflowReplay) (Error) Cannot open recording part " << partName << ", exiting ..." << std::endl;
+      exit(1);
+    }
+
+    int nBoxes = 0;
+    H5LTget_attribute_int(part.file, "/", "numberOfVelocityBoxes", &nBoxes);
+    std::vector<long> boxes(6*nBoxes);
+    if (nBoxes) {
+      H5LTget_attribute_long(part.file, "/", "velocityBoxes", &boxes[0]);
+    }
+    part.velocitySize = 0;
+    for (int b = 0 ; b < nBoxes ; b++) {
+      part.velocityBoxes.push_back(plb::Box3D(boxes[6*b],boxes[6*b+1],boxes[6*b+2],boxes[6*b+3],boxes[6*b+4],boxes[6*b+5]));
+      part.velocitySize += 3*part.velocityBoxes.back().nCells();
+    }
+
+    long long partMin, partMax;
+    H5LTget_attribute_long_long(part.file, "/", "minCellId", &partMin);
+    H5LTget_attribute_long_long(part.file, "/", "maxCellId", &partMax);
+    if (partMin <= partMax) {
+      if (minCellId > maxCellId) {
+        minCellId = partMin;
+        maxCellId = partMax;
+      } else {
+        minCellId = std::min(minCellId,partMin);
+        maxCellId = std::max(maxCellId,partMax);
+      }
+    }
+
+    // The particle counts form the index of the particle stream
+    hid_t countSet = H5Dopen2(part.file,"particleCount",H5P_DEFAULT);
+    hid_t countSpace = H5Dget_space(countSet);
+    hsize_t partFrames;
+    H5Sget_simple_extent_dims(countSpace,&partFrames,NULL);
+    std::vector<unsigned long long> counts(partFrames);
+    if (partFrames) {
+      H5Dread(countSet,H5T_NATIVE_ULLONG,H5S_ALL,H5S_ALL,H5P_DEFAULT,&counts[0]);
+    }
+    H5Sclose(countSpace);
+    H5Dclose(countSet);
+    part.particleStart.resize(partFrames+1,0);
+    for (hsize_t f = 0 ; f < partFrames ; f++) {
+      part.particleStart[f+1] = part.particleStart[f] + counts[f];
+    }
+    frames = std::min(frames,partFrames);
+
+    part.particleSet = H5Dopen2(part.file,"particles",H5P_DEFAULT);
+    part.velocitySet = part.velocitySize ? H5Dopen2(part.file,"velocity",H5P_DEFAULT) : -1;
+    parts.push_back(part);
+  }
+
+  if (frames == 0) {
+    std::cout << "(InflowReplay) (Error) " << fileName << " does not contain any frames, exiting ..." << std::endl;
+    exit(1);
+  }
+}
+
+InflowReplay::~InflowReplay() {
+  for (Part & part : parts) {
+    H5Dclose(part.particleSet);
+    if (part.velocitySet >= 0) {
+      H5Dclose(part.velocitySet);
+    }
+    H5Fclose(part.file);
+  }
+}
+
+void InflowReplay::readParticles(hsize_t frame, std::vector<char> & particles) const {
+  const hsize_t particleSize = sizeof(HemoCellParticle::serializeValues_t);
+  for (const Part & part : parts) {
+    hsize_t offset[1] = {part.particleStart[frame]*particleSize};
+    hsize_t count[1] = {(part.particleStart[frame+1] - part.particleStart[frame])*particleSize};
+    size_t start = particles.size();
+    particles.resize(start + count[0]);
+    readFromDataset(part.particleSet,H5T_NATIVE_UCHAR,1,offset,count,particles.data() + start);
+  }
+}
+
+void InflowReplay::readVelocity(size_t p, hsize_t frame, std::vector<T> & velocity) const {
+  const Part & part = parts[p];
+  velocity.resize(part.velocitySize);
+  hsize_t offset[2] = {frame, 0};
+  hsize_t count[2] = {1, part.velocitySize};
+  readFromDataset(part.velocitySet,nativeTypeOfT(),2,offset,count,velocity.data());
+}
+
+}
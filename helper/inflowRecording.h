@@ -0,0 +1,107 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab
+in the University of Amsterdam. Any questions or remarks regarding this library
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef HEMO_INFLOW_RECORDING_H
+#define HEMO_INFLOW_RECORDING_H
+
+#include "constant_defaults.h"
+#include "core/geometry3D.h"
+
+#include <string>
+#include <vector>
+
+#include <hdf5.h>
+
+/*
+ * A recorded inflow consists of an index file <name>.h5 and one part file
+ * <name>.<rank>.h5 for every pre-inlet rank that sends particles or inlet
+ * velocities to the main domain. The index holds the attributes of the
+ * pre-inlet (direction, length, inlet plane, ...) and the ranks of the parts.
+ *
+ * Every part stores one frame per call of PreInlet::applyPreInlet() in
+ * chunked, deflate compressed datasets that grow with the recording:
+ *
+ *   iteration      [frames]            time stamp of the frame
+ *   particleCount  [frames]            number of particles in the frame
+ *   particles      [sum(particleCount)*particleSize]
+ *                                      the serialized particles as they are
+ *                                      sent to the main domain
+ *   velocity       [frames][3*nodes]   the velocity of the nodes of
+ *                                      velocityBoxes (x, y, z, z fastest)
+ *
+ * The particleCount dataset doubles as the index of the particle stream.
+ */
+namespace hemo {
+
+class InflowRecorder {
+public:
+  InflowRecorder(const std::string & fileName, const std::vector<plb::Box3D> & velocityBoxes);
+  ~InflowRecorder();
+
+  void writeFrame(unsigned int iteration, const std::vector<char> & particles, const std::vector<T> & velocity);
+
+  /// Write the index of a recording, only called by a single process
+  static void writeIndex(const std::string & fileName, const std::vector<int> & parts,
+                         int direction, int preinletLength, const plb::Box3D & fluidInlet, int numberOfCells);
+
+private:
+  hid_t file;
+  hid_t iterationSet, countSet, particleSet, velocitySet;
+  hsize_t frames = 0;
+  hsize_t particleBytes = 0;
+  hsize_t velocitySize = 0;
+  long long minCellId, maxCellId;
+};
+
+class InflowReplay {
+public:
+  explicit InflowReplay(const std::string & fileName);
+  ~InflowReplay();
+
+  hsize_t getNumberOfFrames() const { return frames; }
+  size_t getNumberOfParts() const { return parts.size(); }
+  const std::vector<plb::Box3D> & getVelocityBoxes(size_t part) const { return parts[part].velocityBoxes; }
+
+  /// Append the particles of all parts in a frame to particles
+  void readParticles(hsize_t frame, std::vector<char> & particles) const;
+  /// Read the velocity of the nodes in the velocity boxes of a part
+  void readVelocity(size_t part, hsize_t frame, std::vector<T> & velocity) const;
+
+  int direction = 0;
+  int preinletLength = 0;
+  int numberOfCells = 0;
+  long long minCellId = 0, maxCellId = -1;
+
+private:
+  struct Part {
+    hid_t file, particleSet, velocitySet;
+    std::vector<plb::Box3D> velocityBoxes;
+    hsize_t velocitySize;
+    std::vector<hsize_t> particleStart; // Index of the first particle of a frame, size frames+1
+  };
+  std::vector<Part> parts;
+  hsize_t frames = 0;
+};
+
+}
+#endif
@@ -29,7 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace hemo {
   InteriorViscosityHelper::InteriorViscosityHelper(HemoCellFields & cellFields_) : cellFields(cellFields_) {
     //Create viscosity field with same properties as fluid field underlying the particleField.
-    if(cellFields.hemocell.preInlet){
+    if(cellFields.hemocell.preinlet_lattice){
       preinlet_multiInteriorViscosityField = new plb::MultiScalarField3D<T>(
             MultiBlockManagement3D (
                 *cellFields.hemocell.preinlet_lattice->getSparseBlockStructure().clone(),
@@ -98,12 +98,12 @@ namespace hemo {
     if (global::mpi().isMainProcessor()) {
         renameFileToDotOld(outDir + "internalViscosity.dat");
         renameFileToDotOld(outDir + "internalViscosity.plb");
-        if(cellFields.hemocell.preInlet){
+        if(cellFields.hemocell.preinlet_lattice){
           renameFileToDotOld(outDir + "PRE_internalViscosity.dat");
           renameFileToDotOld(outDir + "PRE_internalViscosity.plb");
         }
     }
-    if(cellFields.hemocell.preInlet){
+    if(cellFields.hemocell.preinlet_lattice){
       plb::parallelIO::save(*preinlet_multiInteriorViscosityField, outDir + "PRE_internalViscosity", true);
     }
     plb::parallelIO::save(*domain_multiInteriorViscosityField, outDir + "internalViscosity", true);
@@ -121,7 +121,7 @@ namespace hemo {
       pcout << "(internalViscosityField) Error restoring internalViscosity fields from checkpoint, they do not seem to exist" << endl;
       exit(1);
     }
-    if(cellFields.hemocell.preInlet){
+    if(cellFields.hemocell.preinlet_lattice){
       std::string file_dat = outDir + "PRE_internalViscosity.dat";
       std::string file_plb = outDir + "PRE_internalViscosity.plb";
       if(!(file_exists(file_dat) && file_exists(file_plb))) {
@@ -130,7 +130,7 @@ namespace hemo {
       }
     }
     plb::parallelIO::load(outDir + "internalViscosity",*get(cellFields).domain_multiInteriorViscosityField,true);
-    if(cellFields.hemocell.preInlet){
+    if(cellFields.hemocell.preinlet_lattice){
       plb::parallelIO::load(outDir + "PRE_internalViscosity",*get(cellFields).preinlet_multiInteriorViscosityField,true);
     }
     get(cellFields).refillBindingSites();
@@ -166,7 +166,7 @@ namespace hemo {
   }
   
   void InteriorViscosityHelper::refillBindingSites() {
-    if(cellFields.hemocell.preInlet){
+    if(cellFields.hemocell.preinlet_lattice){
       for (const plint & bId : cellFields.preinlet_immersedParticles->getLocalInfo().getBlocks()) {
         HemoCellParticleField & pf = cellFields.preinlet_immersedParticles->getComponent(bId);
         ScalarField3D<T> & bf = *pf.interiorViscosityField;
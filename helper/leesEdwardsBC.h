@@ -23,15 +23,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 /*
-Lees-Edwards boundary condition class which makes use of two data processors
+Lees-Edwards boundary condition class which makes use of a data processor
 for calculating and writing of the populations according to the Lees-Edwards algorithm.
 
-Populations are read and writen between two static 2D arrays (topPopulations & bottomPopulations).
+The populations streaming across the sheared boundary are interpolated from the
+nodes of the same (top or bottom) plane, shifted by the current Lees-Edwards
+displacement. These nodes can be owned by other blocks and processes, therefore
+every process first gathers the shifted part of the plane it needs in compact
+flat buffers (LeesEdwardsPlanes), after which every block updates its own nodes.
 The memory address for the current Lees-Edwards displacement is shared with the hemoCell class.
 
-The 2D arrays and Lees-Edwards displacement are static in order to guarantee data consistency
-after subdivision of the code over the individual lattice blocks.
-
 The velocity in the system comes from setting the macroscopic velocity in the boundary nodes
 
 NOTE: currently the Lees-Edwards algorithm works only in one direction (z-direction)
@@ -46,244 +47,280 @@ NOTE: currently the Lees-Edwards algorithm works only in one direction (z-direct
 #include "palabos3D.h"
 #include "palabos3D.hh"
 
+// MPI tag of the exchange of the shifted planes
+#define LEES_EDWARDS_TAG 70
+// Number of populations that stream across the sheared boundary
+#define LEES_EDWARDS_NPOP 5
+
 namespace hemo
 {
 
-/*  Calculate the streaming of the populations according to the Lees-Edwards algorithm
-    Inherits from data processing functional which handles the subdivision of the code
-    onto individual lattice blocks
-*/
+/* Populations crossing the boundary, the value of target[i] is interpolated
+   from source[i] of the shifted nodes
+ */
+static const plint LEtopSource[LEES_EDWARDS_NPOP] = {3, 16, 8, 6, 18};
+static const plint LEtopTarget[LEES_EDWARDS_NPOP] = {3, 6, 8, 16, 18};
+static const plint LEbottomSource[LEES_EDWARDS_NPOP] = {15, 9, 12, 7, 17};
+static const plint LEbottomTarget[LEES_EDWARDS_NPOP] = {7, 9, 12, 15, 17};
+
+/* Source populations of the top and bottom planes, shared by all the (cloned)
+   data processors of one Lees-Edwards boundary
+ */
 template <typename T, template <typename U> class Descriptor>
-class LeesEdwardsBCGetPopulations : public plb::BoxProcessingFunctional3D_L<T, Descriptor>
+class LeesEdwardsPlanes
 {
 public:
-    plint nx; // dimension in x direction
-    plint nz; // dimension in z direction
-    double * LEcurrentDisplacement; // Current Lees-Edwards displacement
-    std::vector<std::vector<std::vector<T>>> * topPopulations; // Data structure containing the top populations
-    std::vector<std::vector<std::vector<T>>> * bottomPopulations; // Data structure containing the bottom populations
-    T topVelocity; // Macroscopic top velocity
-    T bottomVelocity; // Macroscopic bottom velocity
-
-    LeesEdwardsBCGetPopulations(plint nx, plint nz, T topVelocity, T bottomVelocity, double * LEcurrentDisplacement,
-            std::vector<std::vector<std::vector<T>>> * topPopulations,
-            std::vector<std::vector<std::vector<T>>> * bottomPopulations)
-    {
-        this->nx = nx;
-        this->nz = nz;
-        this->LEcurrentDisplacement = LEcurrentDisplacement;
-        this->topVelocity = topVelocity;
-        this->bottomVelocity = bottomVelocity;
-        this->topPopulations = topPopulations;
-        this->bottomPopulations = bottomPopulations;
-    }
-
-    /* Convert Palabos array to vector
-
-     * @param populations Palabos array containing lattice node populations
-     * @return vector containing lattice node populations
+    /* The shifted part of the plane a local block reads from, flat in (x, y, population).
+       x is the unwrapped global coordinate, it can lie outside [0, nx)
      */
-    std::vector<T> populationsArrayToVector(plb::Array<T, Descriptor<T>::q> populations) {
-        std::vector<T> pop(Descriptor<T>::q);
-        for(plint i = 0; i < Descriptor<T>::q; i++) {
-            pop[i] = populations[i];
+    struct Window {
+        plint x0, x1, y0, y1;
+        std::vector<T> populations;
+
+        inline plint index(plint x, plint y) const {
+            return ((x - x0) * (y1 - y0 + 1) + (y - y0)) * LEES_EDWARDS_NPOP;
         }
-        return pop;
-    }
+    };
 
-    /* Non-negative modulo (-a % b gives a negative number in C++)
-     */
-    plint modNonNegative(plint a, plint b)
-    {
-        return (a % b + b) % b;
-    }
+    plb::MultiBlockLattice3D<T, Descriptor> * lattice;
+    plint nx;
+    plint nz;
+    double * LEcurrentDisplacement;
+    std::map<std::pair<plint, plint>, Window> top, bottom; // Per local block, keyed by the global (x0, y0) of its bulk
 
-    /* Process function containg the code to be executed onto the individual lattice block.
-       Set macroscopic velocity
-       Calculate new populations according to the Lees-Edwards algorithm
+    plint localBlocks = 0; // Number of blocks on this process
+    plint processed = 0;   // Number of blocks processed in the current iteration
 
-     * @param domain Domain on which to execute code
-     * @param lattice individual block lattice
+    /* Fill the windows of all local blocks, must be called once per iteration
+       before any block writes its plane. Every process walks the blocks of both
+       planes in the same order, so the messages need no further description.
      */
-    virtual void process(plb::Box3D domain, plb::BlockLattice3D<T, Descriptor> &lattice)
+    void exchange()
     {
-        Dot3D absoluteOffset = lattice.getLocation(); // Location of this block lattice {x, y, z}
+        const double displacement = *LEcurrentDisplacement;
+        const int rank = global::mpi().getRank();
+        const plb::SparseBlockStructure3D & blockStructure = lattice->getSparseBlockStructure();
+        const plb::ThreadAttribution & threads = lattice->getMultiBlockManagement().getThreadAttribution();
 
-        // The portion of the population streamed from node S1 or S2 is determined by the overlap with the reference node
-        double gfrac = std::fmod((*this->LEcurrentDisplacement), 1.0); 
-        plint globalX, globalY;
-	plint globalZ0 = absoluteOffset.z + domain.z0;
-	plint globalZ1 = absoluteOffset.z + domain.z1;
-        Cell<T, Descriptor> curCell;
-        Cell<T, Descriptor> s1Cell;
-        Cell<T, Descriptor> s2Cell;
-
-        // Variables for setting the macroscopic velocity
-        T rhoBar;
-        plb::Array<T, Descriptor<T>::d> j;
+        struct Transfer { Window * window; plint x0, x1, y0, y1; };
+        std::map<int, std::vector<T>> sendBuffers;
+        std::map<int, std::vector<Transfer>> recvTransfers;
+        std::map<int, plint> recvSizes;
 
-        if (globalZ1 == this->nz - 1) // Top
+        for (int plane = 0; plane < 2; plane++)
         {
-            for (plint iX = domain.x0; iX <= domain.x1; ++iX)
+            const bool isTop = (plane == 0);
+            const plint * source = isTop ? LEtopSource : LEbottomSource;
+            const double shift = isTop ? displacement : -displacement;
+
+            for (const auto & consumer : blockStructure.getBulks())
             {
-                globalX = absoluteOffset.x + iX;
-                for (plint iY = domain.y0; iY <= domain.y1; ++iY)
+                const plb::Box3D & cb = consumer.second;
+                if (isTop ? (cb.z1 != nz - 1) : (cb.z0 != 0)) { continue; }
+                const int consumerRank = threads.getMpiProcess(consumer.first);
+                const plint w0 = cb.x0 + (plint)std::floor(shift);
+                const plint w1 = cb.x1 + (plint)std::ceil(shift);
+
+                Window * window = 0;
+                if (consumerRank == rank) {
+                    window = &(isTop ? top : bottom)[std::make_pair(cb.x0, cb.y0)];
+                    window->x0 = w0; window->x1 = w1;
+                    window->y0 = cb.y0; window->y1 = cb.y1;
+                    window->populations.resize((w1 - w0 + 1) * (cb.y1 - cb.y0 + 1) * LEES_EDWARDS_NPOP);
+                }
+
+                for (const auto & producer : blockStructure.getBulks())
                 {
-                    globalY = absoluteOffset.y + iY;
-                    curCell = lattice.get(iX, iY, domain.z1);
-
-                    // Set macroscopic velocity
-                    curCell.getDynamics().computeRhoBarJ(curCell, rhoBar, j);
-                    curCell.getDynamics().collideExternal(curCell, rhoBar, plb::Array<T,3>(this->topVelocity, 0.0, 0.0), T(), lattice.getInternalStatistics());
-                    (*this->topPopulations)[globalX][globalY] = populationsArrayToVector(curCell.getRawPopulations());
-
-                    // Determine reference nodes coordinates according to the current displacement
-                    plint s1 = domain.x0 + (plint)modNonNegative(std::ceil((*this->LEcurrentDisplacement) + globalX), this->nx);
-                    plint s2 = domain.x0 + (plint)modNonNegative(std::floor((*this->LEcurrentDisplacement) + globalX), this->nx);
-
-                    // Get the nodes
-                    s1Cell = lattice.get(s1, iY, domain.z1);
-                    s2Cell = lattice.get(s2, iY, domain.z1);
-
-                    // Write resulting LE stream to data structure
-                    (*this->topPopulations)[globalX][globalY][3] = gfrac * s1Cell[3] + (1 - gfrac) * s2Cell[3];
-                    (*this->topPopulations)[globalX][globalY][6] = gfrac * s1Cell[16] + (1 - gfrac) * s2Cell[16];
-                    (*this->topPopulations)[globalX][globalY][8] = gfrac * s1Cell[8] + (1 - gfrac) * s2Cell[8];
-                    (*this->topPopulations)[globalX][globalY][16] = gfrac * s1Cell[6] + (1 - gfrac) * s2Cell[6];
-                    (*this->topPopulations)[globalX][globalY][18] = gfrac * s1Cell[18] + (1 - gfrac) * s2Cell[18];
+                    const plb::Box3D & pb = producer.second;
+                    if (isTop ? (pb.z1 != nz - 1) : (pb.z0 != 0)) { continue; }
+                    const int producerRank = threads.getMpiProcess(producer.first);
+                    if (producerRank != rank && consumerRank != rank) { continue; }
+                    const plint y0 = std::max(cb.y0, pb.y0);
+                    const plint y1 = std::min(cb.y1, pb.y1);
+                    if (y0 > y1) { continue; }
+
+                    // The window can wrap around the periodic x direction
+                    for (plint wrap = -1; wrap <= 1; wrap++)
+                    {
+                        const plint x0 = std::max(w0, pb.x0 + wrap * nx);
+                        const plint x1 = std::min(w1, pb.x1 + wrap * nx);
+                        if (x0 > x1) { continue; }
+
+                        if (producerRank == rank) {
+                            plb::BlockLattice3D<T, Descriptor> & block = lattice->getComponent(producer.first);
+                            const Dot3D loc = block.getLocation();
+                            const plint z = (isTop ? nz - 1 : 0) - loc.z;
+                            std::vector<T> * sendBuffer = (consumerRank == rank) ? 0 : &sendBuffers[consumerRank];
+                            for (plint x = x0; x <= x1; x++) {
+                                for (plint y = y0; y <= y1; y++) {
+                                    const Cell<T, Descriptor> & cell = block.get(x - wrap * nx - loc.x, y - loc.y, z);
+                                    if (sendBuffer) {
+                                        for (plint i = 0; i < LEES_EDWARDS_NPOP; i++) {
+                                            sendBuffer->push_back(cell[source[i]]);
+                                        }
+                                    } else {
+                                        T * dest = &window->populations[window->index(x, y)];
+                                        for (plint i = 0; i < LEES_EDWARDS_NPOP; i++) {
+                                            dest[i] = cell[source[i]];
+                                        }
+                                    }
+                                }
+                            }
+                        } else {
+                            recvTransfers[producerRank].push_back({window, x0, x1, y0, y1});
+                            recvSizes[producerRank] += (x1 - x0 + 1) * (y1 - y0 + 1) * LEES_EDWARDS_NPOP;
+                        }
+                    }
                 }
             }
         }
-        if (globalZ0 == 0) // Bottom
-        {
-            for (plint iX = domain.x0; iX <= domain.x1; ++iX)
-            {
-                globalX = absoluteOffset.x + iX;
-                for (plint iY = domain.y0; iY <= domain.y1; ++iY)
-                {
-                    globalY = absoluteOffset.y + iY;
-                    curCell = lattice.get(iX, iY, domain.z0);
-
-                    // Set macroscopic velocity
-                    curCell.getDynamics().computeRhoBarJ(curCell, rhoBar, j);
-                    curCell.getDynamics().collideExternal(curCell, rhoBar, plb::Array<T,3>(this->bottomVelocity, 0.0, 0.0), T(), lattice.getInternalStatistics());
-                    (*this->bottomPopulations)[globalX][globalY] = populationsArrayToVector(curCell.getRawPopulations());
-
-                    // Determine reference nodes coordinates according to the current displacement
-                    plint s1 = domain.x0 + (plint)modNonNegative(std::floor(-(*this->LEcurrentDisplacement) + globalX), this->nx);
-                    plint s2 = domain.x0 + (plint)modNonNegative(std::ceil(-(*this->LEcurrentDisplacement) + globalX), this->nx);
-
-                    // Get the nodes
-                    s1Cell = lattice.get(s1, iY, domain.z0);
-                    s2Cell = lattice.get(s2, iY, domain.z0);
-
-                    // Write resulting LE stream to data structure
-                    (*this->bottomPopulations)[globalX][globalY][7] = gfrac * s1Cell[15] + (1 - gfrac) * s2Cell[15];
-                    (*this->bottomPopulations)[globalX][globalY][9] = gfrac * s1Cell[9] + (1 - gfrac) * s2Cell[9];
-                    (*this->bottomPopulations)[globalX][globalY][12] = gfrac * s1Cell[12] + (1 - gfrac) * s2Cell[12];
-                    (*this->bottomPopulations)[globalX][globalY][15] = gfrac * s1Cell[7] + (1 - gfrac) * s2Cell[7];
-                    (*this->bottomPopulations)[globalX][globalY][17] = gfrac * s1Cell[17] + (1 - gfrac) * s2Cell[17];
+
+        std::map<int, std::vector<T>> recvBuffers;
+        std::vector<MPI_Request> requests;
+        requests.reserve(recvSizes.size() + sendBuffers.size());
+        for (const auto & peer : recvSizes) {
+            std::vector<T> & buffer = recvBuffers[peer.first];
+            buffer.resize(peer.second);
+            requests.push_back(MPI_Request());
+            MPI_Irecv(buffer.data(), buffer.size() * sizeof(T), MPI_CHAR, peer.first, LEES_EDWARDS_TAG, MPI_COMM_WORLD, &requests.back());
+        }
+        for (auto & peer : sendBuffers) {
+            requests.push_back(MPI_Request());
+            MPI_Isend(peer.second.data(), peer.second.size() * sizeof(T), MPI_CHAR, peer.first, LEES_EDWARDS_TAG, MPI_COMM_WORLD, &requests.back());
+        }
+        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+        for (const auto & peer : recvTransfers) {
+            const T * value = recvBuffers[peer.first].data();
+            for (const Transfer & transfer : peer.second) {
+                for (plint x = transfer.x0; x <= transfer.x1; x++) {
+                    for (plint y = transfer.y0; y <= transfer.y1; y++) {
+                        T * dest = &transfer.window->populations[transfer.window->index(x, y)];
+                        for (plint i = 0; i < LEES_EDWARDS_NPOP; i++) {
+                            dest[i] = *value++;
+                        }
+                    }
                 }
             }
         }
-        // cout << global::mpi().getRank() << " " << bottomPopulations[5][5][10] << endl;
-    }
-
-    // Clone class to individual lattice blocks
-    virtual LeesEdwardsBCGetPopulations<T, Descriptor> *clone() const
-    {
-        return new LeesEdwardsBCGetPopulations<T, Descriptor>(*this);
-    }
-
-    // Return the type of data that is modified
-    virtual void getTypeOfModification(std::vector<plb::modif::ModifT> &modified) const
-    {
-        modified[0] = modif::nothing;
-    }
-
-    // Only need the bulk of the domain
-    virtual plb::BlockDomain::DomainT appliesTo() const
-    {
-        return BlockDomain::bulk;
     }
 };
 
-/*  Write the streaming of the populations according to the Lees-Edwards algorithm
+/*  Calculate and write the streaming of the populations according to the Lees-Edwards algorithm
     Inherits from data processing functional which handles the subdivision of the code
     onto individual lattice blocks
 */
 template <typename T, template <typename U> class Descriptor>
-class LeesEdwardsBCSetPopulations : public plb::BoxProcessingFunctional3D_L<T, Descriptor>
+class LeesEdwardsBCProcessor : public plb::BoxProcessingFunctional3D_L<T, Descriptor>
 {
 public:
     plint nz; // dimension in z direction
-    std::vector<std::vector<std::vector<T>>> * topPopulations; // Data structure containing the top populations
-    std::vector<std::vector<std::vector<T>>> * bottomPopulations; // Data structure containing the bottom populations
+    double * LEcurrentDisplacement; // Current Lees-Edwards displacement
+    LeesEdwardsPlanes<T, Descriptor> * planes; // Shifted source populations
+    T topVelocity; // Macroscopic top velocity
+    T bottomVelocity; // Macroscopic bottom velocity
 
-    LeesEdwardsBCSetPopulations(plint nz,
-            std::vector<std::vector<std::vector<T>>> * topPopulations,
-            std::vector<std::vector<std::vector<T>>> * bottomPopulations) {
+    LeesEdwardsBCProcessor(plint nz, T topVelocity, T bottomVelocity, double * LEcurrentDisplacement,
+            LeesEdwardsPlanes<T, Descriptor> * planes)
+    {
         this->nz = nz;
-        this->topPopulations = topPopulations;
-        this->bottomPopulations = bottomPopulations;
+        this->LEcurrentDisplacement = LEcurrentDisplacement;
+        this->topVelocity = topVelocity;
+        this->bottomVelocity = bottomVelocity;
+        this->planes = planes;
     }
 
-    /* Convert vector to Palabos array
+    /* Set the macroscopic velocity of the boundary nodes and replace the
+       populations crossing the boundary with the interpolated shifted ones
 
-     * @param populations vector containing lattice node populations
-     * @return Palabos array containing lattice node populations
+     * @param lattice individual block lattice
+     * @param iX, iY, iZ local coordinates of the node
+     * @param velocity macroscopic velocity of the boundary
+     * @param window shifted source populations of this block
+     * @param s1, s2 global x coordinates of the reference nodes
+     * @param target populations that are replaced
      */
-    plb::Array<T, Descriptor<T>::q> populationsVectorToArray(std::vector<T> populations)
+    void updateNode(plb::BlockLattice3D<T, Descriptor> &lattice, plint iX, plint iY, plint iZ, T velocity,
+            const typename LeesEdwardsPlanes<T, Descriptor>::Window & window, plint globalY, plint s1, plint s2,
+            const plint * target)
     {
-        plb::Array<T, Descriptor<T>::q> pop;
-        for (plint i = 0; i < DESCRIPTOR<T>::q; i++)
-        {
-            pop[i] = populations[i];
+        // The portion of the population streamed from node S1 or S2 is determined by the overlap with the reference node
+        const double gfrac = std::fmod((*this->LEcurrentDisplacement), 1.0);
+        T rhoBar;
+        plb::Array<T, Descriptor<T>::d> j;
+
+        Cell<T, Descriptor> & cell = lattice.get(iX, iY, iZ);
+        Cell<T, Descriptor> curCell = cell;
+        curCell.getDynamics().computeRhoBarJ(curCell, rhoBar, j);
+        curCell.getDynamics().collideExternal(curCell, rhoBar, plb::Array<T,3>(velocity, 0.0, 0.0), T(), lattice.getInternalStatistics());
+
+        const T * s1Pop = &window.populations[window.index(s1, globalY)];
+        const T * s2Pop = &window.populations[window.index(s2, globalY)];
+        for (plint i = 0; i < LEES_EDWARDS_NPOP; i++) {
+            curCell[target[i]] = gfrac * s1Pop[i] + (1 - gfrac) * s2Pop[i];
+        }
+        for (plint i = 0; i < Descriptor<T>::q; i++) {
+            cell[i] = curCell[i];
         }
-        return pop;
     }
 
     /* Process function containg the code to be executed onto the individual lattice block.
-       Write new populations to lattice.
+       The first block of an iteration gathers the shifted planes for all local blocks.
 
      * @param domain Domain on which to execute code
      * @param lattice individual block lattice
      */
     virtual void process(plb::Box3D domain, plb::BlockLattice3D<T, Descriptor> &lattice)
     {
-        Dot3D absoluteOffset = lattice.getLocation(); // Location of this block lattice {x, y, z}
+        if (planes->processed == 0) {
+            planes->exchange();
+        }
+        planes->processed = (planes->processed + 1) % planes->localBlocks;
 
+        Dot3D absoluteOffset = lattice.getLocation(); // Location of this block lattice {x, y, z}
+        const std::pair<plint, plint> blockKey(absoluteOffset.x + domain.x0, absoluteOffset.y + domain.y0);
+        plint globalX, globalY;
         plint globalZ0 = absoluteOffset.z + domain.z0;
         plint globalZ1 = absoluteOffset.z + domain.z1;
-        plint globalX, globalY;
-        plb::Array<T, Descriptor<T>::q> populations;
 
-        if (globalZ1 == this->nz - 1) { // Top
-            for (plint iX = domain.x0; iX <= domain.x1; ++iX) {
+        if (globalZ1 == this->nz - 1) // Top
+        {
+            const typename LeesEdwardsPlanes<T, Descriptor>::Window & window = planes->top.at(blockKey);
+            for (plint iX = domain.x0; iX <= domain.x1; ++iX)
+            {
                 globalX = absoluteOffset.x + iX;
-                for (plint iY = domain.y0; iY <= domain.y1; ++iY) {
+                // Determine reference nodes coordinates according to the current displacement
+                plint s1 = (plint)std::ceil((*this->LEcurrentDisplacement) + globalX);
+                plint s2 = (plint)std::floor((*this->LEcurrentDisplacement) + globalX);
+                for (plint iY = domain.y0; iY <= domain.y1; ++iY)
+                {
                     globalY = absoluteOffset.y + iY;
-                    populations = populationsVectorToArray((*this->topPopulations)[globalX][globalY]);
-                    lattice.get(iX, iY, domain.z1).setPopulations(populations);
+                    updateNode(lattice, iX, iY, domain.z1, this->topVelocity, window, globalY, s1, s2, LEtopTarget);
                 }
             }
         }
-        if (globalZ0 == 0) { // Bottom
-            for (plint iX = domain.x0; iX <= domain.x1; ++iX) {
+        if (globalZ0 == 0) // Bottom
+        {
+            const typename LeesEdwardsPlanes<T, Descriptor>::Window & window = planes->bottom.at(blockKey);
+            for (plint iX = domain.x0; iX <= domain.x1; ++iX)
+            {
                 globalX = absoluteOffset.x + iX;
-                for (plint iY = domain.y0; iY <= domain.y1; ++iY) {
+                // Determine reference nodes coordinates according to the current displacement
+                plint s1 = (plint)std::floor(-(*this->LEcurrentDisplacement) + globalX);
+                plint s2 = (plint)std::ceil(-(*this->LEcurrentDisplacement) + globalX);
+                for (plint iY = domain.y0; iY <= domain.y1; ++iY)
+                {
                     globalY = absoluteOffset.y + iY;
-                    populations = populationsVectorToArray((*this->bottomPopulations)[globalX][globalY]);
-                    lattice.get(iX, iY, domain.z0).setPopulations(populations);
+                    updateNode(lattice, iX, iY, domain.z0, this->bottomVelocity, window, globalY, s1, s2, LEbottomTarget);
                 }
             }
         }
     }
 
     // Clone class to individual lattice blocks
-    virtual LeesEdwardsBCSetPopulations<T, Descriptor> *clone() const
+    virtual LeesEdwardsBCProcessor<T, Descriptor> *clone() const
     {
-        return new LeesEdwardsBCSetPopulations<T, Descriptor>(*this);
+        return new LeesEdwardsBCProcessor<T, Descriptor>(*this);
     }
 
     // Return the type of data that is modified
@@ -300,7 +337,7 @@ public:
 };
 
 
-/* Lees-Edwards boundary conditions base class responsible for the setup and initialization of the data processors
+/* Lees-Edwards boundary conditions base class responsible for the setup and initialization of the data processor
  */
 template<typename T, template<class U> class Descriptor>
 class LeesEdwardsBC
@@ -312,17 +349,18 @@ public:
     plint nz;      // Dimension in z direction
     // int direction; // TODO direction of the LE boundary x = 0, y = 1, z = 2
     double LEdisplacement; // Displacement per timestep
-    static double LEcurrentDisplacement; // Current total displacement
+    double LEcurrentDisplacement = 0.; // Current total displacement
     T dt; // Timestep size
     T topVelocity; // Macroscopic velocity top boundary layer
     T bottomVelocity; // Macroscopic velocity bottom boundary layer
-    plint dataProcessorLevel; // level of operation of the Lees-Edwards data processors
+    plint dataProcessorLevel; // level of operation of the Lees-Edwards data processor
 
-    static std::vector<std::vector<std::vector<T>>> topPopulations; // Data structure containing the top populations
-    static std::vector<std::vector<std::vector<T>>> bottomPopulations; // Data structure containing the bottom populations
+    LeesEdwardsPlanes<T, Descriptor> planes; // Shifted source populations of the top and bottom plane
 
-    LeesEdwardsBC(plb::MultiBlockLattice3D<T, Descriptor> &lattice, T shearRate, T dt, double ** hemoCellLEcurrentDisplacement, plint dataProcessorLevel = 1) : lattice(lattice) {
-        this->lattice = lattice;
+    /* Lees-Edwards boundary on the z-planes of hemocell.lattice, this also
+       enables the matching shift of particles crossing the boundary
+     */
+    LeesEdwardsBC(HemoCell & hemocell, T shearRate, T dt, plint dataProcessorLevel = 1) : lattice(*hemocell.lattice) {
         this->nx = lattice.getNx();
         this->ny = lattice.getNy();
         this->nz = lattice.getNz();
@@ -332,7 +370,11 @@ public:
         this->topVelocity = -vHalf;
         this->bottomVelocity = vHalf;
         this->dataProcessorLevel = dataProcessorLevel;
-        *hemoCellLEcurrentDisplacement = &LEcurrentDisplacement; // Let the hemocell LE displacement point to this memory address
+
+        // Let the hemocell LE displacement point to this memory address
+        hemocell.leesEdwardsBC = true;
+        hemocell.LEcurrentDisplacement = &LEcurrentDisplacement;
+        hemocell.LEvelocityShift = bottomVelocity - topVelocity;
     }
 
     void initialize()
@@ -340,18 +382,18 @@ public:
         // Uses the default periodicity because otherwise a form of bounceback boundary will be initialized per default
         this->lattice.periodicity().toggleAll(true);
 
-        this->topPopulations.resize(this->nx, std::vector<std::vector<T>>(this->ny, std::vector<T>(Descriptor<T>::q)));
-        this->bottomPopulations.resize(this->nx, std::vector<std::vector<T>>(this->ny, std::vector<T>(Descriptor<T>::q)));
+        planes.lattice = &this->lattice;
+        planes.nx = this->nx;
+        planes.nz = this->nz;
+        planes.LEcurrentDisplacement = &LEcurrentDisplacement;
+        planes.localBlocks = this->lattice.getLocalInfo().getBlocks().size();
+        planes.processed = 0;
 
-        // set data processors        
+        // set data processor
         integrateProcessingFunctional(
-            new LeesEdwardsBCGetPopulations<T, DESCRIPTOR>(this->nx, this->nz, this->topVelocity, this->bottomVelocity, &LEcurrentDisplacement, &topPopulations, &bottomPopulations),
+            new LeesEdwardsBCProcessor<T, Descriptor>(this->nz, this->topVelocity, this->bottomVelocity, &LEcurrentDisplacement, &planes),
             this->lattice.getBoundingBox(), this->lattice, this->dataProcessorLevel);
-
-        integrateProcessingFunctional(
-            new LeesEdwardsBCSetPopulations<T, DESCRIPTOR>(this->nz, &topPopulations, &bottomPopulations),
-            this->lattice.getBoundingBox(), this->lattice, this->dataProcessorLevel + 1);
-        }
+    }
 
     /* Update the current Lees-Edwards displacement
 
@@ -363,21 +405,6 @@ public:
     }
 };
 
-#ifndef LEBC_STATICS
-#define LEBC_STATICS
-// Initialize static variables
-// Lees-Edwards displacement
-template <typename T, template <typename U> class Descriptor>
-double LeesEdwardsBC<T, Descriptor>::LEcurrentDisplacement;
-// Top populations data storage for separate writing and reading across different data processors
-template <typename T, template <typename U> class Descriptor>
-std::vector<std::vector<std::vector<T>>> LeesEdwardsBC<T, Descriptor>::topPopulations;
-// Bottom populations data storage for separate writing and reading across different data processors
-template <typename T, template <typename U> class Descriptor>
-std::vector<std::vector<std::vector<T>>> LeesEdwardsBC<T, Descriptor>::bottomPopulations;
-#else
-#endif
-
 }; // namespace hemo
 
 #endif
@@ -35,7 +35,7 @@ void LoadBalancer::reloadCheckpoint() {
   delete hemocell.documentXML;
   string outDir = global::directories().getOutputDir();
   try {  
-    outDir = (*hemocell.cfg)["parameters"]["checkpointDirectory"].read<string>() + "/";
+    outDir = hemocell.cfg->get<string>("parameters/checkpointDirectory") + "/";
     if (outDir[0] != '/') {
           outDir = "./" + outDir;
     }
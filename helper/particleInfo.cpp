@@ -34,13 +34,13 @@ void GatherParticleVelocity::processGenericBlocks(Box3D domain, std::vector<Atom
     
     if (localParticles.size() > 0) {
       //initial value
-      hemo::Array<T,3> vel_vec = localParticles[0]->sv.v;
+      hemo::Array<T,3> vel_vec = localParticles[0]->sv.getVelocity();
       T vel = sqrt(vel_vec[0]*vel_vec[0]+vel_vec[1]*vel_vec[1]+vel_vec[2]*vel_vec[2]);
       T min=vel,max=vel,avg=0.;
 
 
       for (const HemoCellParticle * particle : localParticles) {
-        vel_vec = particle->sv.v;
+        vel_vec = particle->sv.getVelocity();
         vel = sqrt(vel_vec[0]*vel_vec[0]+vel_vec[1]*vel_vec[1]+vel_vec[2]*vel_vec[2]);
         min = min > vel ? vel : min;
         max = max < vel ? vel : max;
@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "boundaryCondition/boundaryInstantiator3D.h"
 #include "hemoCellFields.h"
+#include "inflowRecording.h"
 
 namespace hemo {
   struct Box3D_simple {
@@ -242,6 +243,38 @@ void PreInlet::initializePreInletParticleBoundary() {
 }
 
 
+/*
+ * Persistent channels for the number of bytes each peer sends every
+ * iteration. The particle data itself has a variable size and follows on a
+ * separate tag once the count is known.
+ */
+void PreInlet::createParticleChannels() {
+  const vector<int> & peers = partOfpreInlet ? my_send_blocks : my_recv_blocks;
+  particleCounts.assign(peers.size(),0);
+  particleBuffers.assign(peers.size(),vector<char>());
+  particleCountRequests.assign(peers.size(),MPI_REQUEST_NULL);
+  particleDataRequests.assign(peers.size(),MPI_REQUEST_NULL);
+
+  for (size_t i = 0 ; i < peers.size() ; i++) {
+    if (partOfpreInlet) {
+      MPI_Send_init(&particleCounts[i],1,MPI_UNSIGNED_LONG_LONG,peers[i],PREINLET_PARTICLE_COUNT_TAG,MPI_COMM_WORLD,&particleCountRequests[i]);
+    } else {
+      MPI_Recv_init(&particleCounts[i],1,MPI_UNSIGNED_LONG_LONG,peers[i],PREINLET_PARTICLE_COUNT_TAG,MPI_COMM_WORLD,&particleCountRequests[i]);
+    }
+  }
+  particleChannelsCreated = true;
+}
+
+PreInlet::~PreInlet() {
+  for (MPI_Request & request : particleCountRequests) {
+    if (request != MPI_REQUEST_NULL) {
+      MPI_Request_free(&request);
+    }
+  }
+  delete recorder;
+  delete replay;
+}
+
 /*
  * Transmit cells (RBC, PLT, ...) located within the periodic pre-inlet to
  * their corresponding location in the main simulation lattice. Cells are only
@@ -249,158 +282,428 @@ void PreInlet::initializePreInletParticleBoundary() {
  * between the pre-inlet and the main domain. All other ranks return early.
  *
  * The communication only happens in a single direction, where cells are only
- * send from the pre-inlet towards the main simulation domain.
+ * send from the pre-inlet towards the main simulation domain. Every sending
+ * rank packs all its communicating blocks into a single message per receiver.
+ * The exchange is only posted here, so it can progress until the next
+ * iteration, finishPreInletParticleBoundary() completes it before the forces
+ * are spread.
  */
-void PreInlet::applyPreInletParticleBoundary() {
-  global.statistics.getCurrent()["applyPreInletParticleBoundary"].start();
-  if (!partOfpreInlet) {
-    hemocell->cellfields->syncEnvelopes();
-    hemocell->cellfields->deleteIncompleteCells(false);
-  }
-  vector<MPI_Request> requests;
-  vector<vector<char>> buffers;
-  MPI_Barrier(MPI_COMM_WORLD);
+void PreInlet::startPreInletParticleBoundary() {
+  // Every domain rank takes part, the finish synchronises all envelopes
+  if (partOfpreInlet && my_send_blocks.empty()) {
+    return;
+  }
+  global.statistics.getCurrent()["startPreInletParticleBoundary"].start();
+  if (!particleChannelsCreated) {
+    createParticleChannels();
+  }
+
   if (partOfpreInlet) {
-    if (particleSendMpi.find(global::mpi().getRank()) != particleSendMpi.end()) {
-      for (plint bid : communicating_blocks) {
-        buffers.push_back(vector<char>());
-        Box3D domain = fluidInlet;
+    // The buffers of the previous iteration can only be reused once they are sent
+    if (particleExchangePending) {
+      MPI_Waitall(particleCountRequests.size(),particleCountRequests.data(),MPI_STATUSES_IGNORE);
+      MPI_Waitall(particleDataRequests.size(),particleDataRequests.data(),MPI_STATUSES_IGNORE);
+    }
 
-        switch (direction) {
-          case Direction::Xneg:
-            domain.x0 = domain.x0 - preinlet_length;
-            domain.x1 = domain.x0 + inflow_length;
-            break;
-          case Direction::Yneg:
-            domain.y0 = domain.y0 - preinlet_length;
-            domain.y1 = domain.y0 + inflow_length;
-            break;
-          case Direction::Zneg:
-            domain.z0 = domain.z0 - preinlet_length;
-            domain.z1 = domain.z0 + inflow_length;
-            break;
-          case Direction::Xpos:
-            domain.x1 = domain.x1 + preinlet_length;
-            domain.x0 = domain.x1 - inflow_length;
-            break;
-          case Direction::Ypos:
-            domain.y1 = domain.y1 + preinlet_length;
-            domain.y0 = domain.y1 - inflow_length;
-            break;
-          case Direction::Zpos:
-            domain.z1 = domain.z1 + preinlet_length;
-            domain.z0 = domain.z1 - inflow_length;
-            break;
-        }
+    Box3D domain = fluidInlet;
+    switch (direction) {
+      case Direction::Xneg:
+        domain.x0 = domain.x0 - preinlet_length;
+        domain.x1 = domain.x0 + inflow_length;
+        break;
+      case Direction::Yneg:
+        domain.y0 = domain.y0 - preinlet_length;
+        domain.y1 = domain.y0 + inflow_length;
+        break;
+      case Direction::Zneg:
+        domain.z0 = domain.z0 - preinlet_length;
+        domain.z1 = domain.z0 + inflow_length;
+        break;
+      case Direction::Xpos:
+        domain.x1 = domain.x1 + preinlet_length;
+        domain.x0 = domain.x1 - inflow_length;
+        break;
+      case Direction::Ypos:
+        domain.y1 = domain.y1 + preinlet_length;
+        domain.y0 = domain.y1 - inflow_length;
+        break;
+      case Direction::Zpos:
+        domain.z1 = domain.z1 + preinlet_length;
+        domain.z0 = domain.z1 - inflow_length;
+        break;
+    }
+
+    // All receivers get the same particles, so pack them once
+    vector<char> & buffer = particleBuffers[0];
+    buffer.clear();
+    vector<char> blockBuffer;
+    for (plint bid : communicating_blocks) {
+      Dot3D shift = hemocell->cellfields->immersedParticles->getComponent(bid).getLocation();
+      hemocell->cellfields->immersedParticles->getComponent(bid).particleDataTransfer.send_preinlet(domain.shift(-shift.x,-shift.y,-shift.z),blockBuffer,modif::hemocell);
+      buffer.insert(buffer.end(),blockBuffer.begin(),blockBuffer.end());
+    }
+
+    for (size_t i = 0 ; i < my_send_blocks.size() ; i++) {
+      particleCounts[i] = buffer.size();
+      MPI_Start(&particleCountRequests[i]);
+      MPI_Isend(buffer.data(),buffer.size(),MPI_CHAR,my_send_blocks[i],PREINLET_PARTICLE_TAG,MPI_COMM_WORLD,&particleDataRequests[i]);
+    }
+  } else {
+    MPI_Startall(particleCountRequests.size(),particleCountRequests.data());
+  }
+  particleExchangePending = true;
+  global.statistics.getCurrent().stop();
+}
+
+void PreInlet::finishPreInletParticleBoundary() {
+  // The pre-inlet side completes its sends when the next exchange is started
+  if (!particleExchangePending || partOfpreInlet) {
+    return;
+  }
+  global.statistics.getCurrent()["finishPreInletParticleBoundary"].start();
+  particleExchangePending = false;
+
+  for (size_t i = 0 ; i < my_recv_blocks.size() ; i++) {
+    MPI_Wait(&particleCountRequests[i],MPI_STATUS_IGNORE);
+    particleBuffers[i].resize(particleCounts[i]);
+    MPI_Irecv(particleBuffers[i].data(),particleCounts[i],MPI_CHAR,my_recv_blocks[i],PREINLET_PARTICLE_TAG,MPI_COMM_WORLD,&particleDataRequests[i]);
+  }
 
-        Dot3D shift = hemocell->cellfields->immersedParticles->getComponent(bid).getLocation();
-        domain = domain.shift(-shift.x,-shift.y,-shift.z);
-        hemocell->cellfields->immersedParticles->getComponent(bid).particleDataTransfer.send_preinlet(domain,buffers.back(),modif::hemocell);
+  MPI_Waitall(particleDataRequests.size(),particleDataRequests.data(),MPI_STATUSES_IGNORE);
+  insertPreInletParticles(particleBuffers,getParticleOffset());
+  global.statistics.getCurrent().stop();
+}
+
+Dot3D PreInlet::getParticleOffset() const {
+  Dot3D offset(0,0,0);
+  switch (direction) {
+    case Direction::Xneg:
+      offset.x = preinlet_length;
+      break;
+    case Direction::Yneg:
+      offset.y = preinlet_length;
+      break;
+    case Direction::Zneg:
+      offset.z = preinlet_length;
+      break;
+    case Direction::Xpos:
+      offset.x = -preinlet_length;
+      break;
+    case Direction::Ypos:
+      offset.y = -preinlet_length;
+      break;
+    case Direction::Zpos:
+      offset.z = -preinlet_length;
+      break;
+  }
+  return offset;
+}
 
-        for (auto & pid : my_send_blocks) {
-          requests.push_back(MPI_Request());
-          MPI_Isend(&buffers.back()[0],buffers.back().size(),MPI_CHAR,pid,0,MPI_COMM_WORLD,&requests.back());
+/*
+ * Collective over the ranks of the main domain. Cells that are only partly
+ * received yet (they are still crossing the inlet) are deleted before the
+ * received particles are inserted, so their stale vertices advected in the
+ * main domain are replaced by the ones from the pre-inlet. Once a cell is
+ * complete the main domain owns it and received duplicates are skipped.
+ */
+void PreInlet::insertPreInletParticles(vector<vector<char>> & buffers, Dot3D offset) {
+  hemocell->cellfields->syncEnvelopes();
+  hemocell->cellfields->deleteIncompleteCells(false);
+
+  const hemo::Array<T,3> realOffset({(T)offset.x,(T)offset.y,(T)offset.z});
+  const size_t particleSize = sizeof(HemoCellParticle::serializeValues_t);
+
+  // Route every received particle only to the local blocks whose bounding box
+  // (including the envelope) contains its position in the main domain
+  const vector<plint> & localBlocks = hemocell->cellfields->immersedParticles->getLocalInfo().getBlocks();
+  vector<vector<char>> blockBuffers(localBlocks.size());
+  for (const vector<char> & buffer : buffers) {
+    for (size_t pos = 0 ; pos + particleSize <= buffer.size() ; pos += particleSize) {
+      const HemoCellParticle::serializeValues_t * sv = (const HemoCellParticle::serializeValues_t *)&buffer[pos];
+      const hemo::Array<T,3> position = sv->getPosition() + realOffset;
+      for (size_t b = 0 ; b < localBlocks.size() ; b++) {
+        HemoCellParticleField & pf = hemocell->cellfields->immersedParticles->getComponent(localBlocks[b]);
+        if (pf.isContainedABS(position,pf.getBoundingBox())) {
+          blockBuffers[b].insert(blockBuffers[b].end(),buffer.begin()+pos,buffer.begin()+pos+particleSize);
         }
       }
     }
-    MPI_Waitall(requests.size(),&requests[0],MPI_STATUSES_IGNORE);
-  } else {
-    for (size_t i = 0 ; i < my_recv_blocks.size() ; i++) {
-      MPI_Status status;
-      int count;
-      MPI_Probe(MPI_ANY_SOURCE,0,MPI_COMM_WORLD,&status);
-      MPI_Get_count(&status,MPI_CHAR,&count);
-      buffers.push_back(vector<char>(count));
-      MPI_Recv(&buffers.back()[0],count,MPI_CHAR,status.MPI_SOURCE,0,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
-      Dot3D offset(0,0,0);
-
-      switch (direction) {
-        case Direction::Xneg:
-          offset.x = preinlet_length;
-          break;
-        case Direction::Yneg:
-          offset.y = preinlet_length;
-          break;
-        case Direction::Zneg:
-          offset.z = preinlet_length;
-          break;
-        case Direction::Xpos:
-          offset.x = -preinlet_length;
-          break;
-        case Direction::Ypos:
-          offset.y = -preinlet_length;
-          break;
-        case Direction::Zpos:
-          offset.z = -preinlet_length;
-          break;
+  }
+
+  for (size_t b = 0 ; b < localBlocks.size() ; b++) {
+    if (blockBuffers[b].empty()) { continue; }
+    HemoCellParticleField & pf = hemocell->cellfields->immersedParticles->getComponent(localBlocks[b]);
+    pf.particleDataTransfer.receivePreInlet(&blockBuffers[b][0],blockBuffers[b].size(),modif::hemocell,offset);
+    pf.invalidate_ppc();
+    pf.invalidate_lpc();
+    pf.invalidate_pg();
+  }
+}
+
+void PreInlet::applyPreInlet() {
+  if (isReplaying()) {
+    replayInflowFrame();
+    return;
+  }
+  startPreInletParticleBoundary();
+  applyPreInletVelocityBoundary();
+  if (!recordFileName.empty()) {
+    recordInflowFrame();
+  }
+}
+
+/*
+ * Store what the pre-inlet sends to the main domain this iteration. The first
+ * call is collective, as the ranks that record have to be known to write the
+ * index of the recording.
+ */
+void PreInlet::recordInflowFrame() {
+  global.statistics.getCurrent()["recordInflow"].start();
+  const int rank = global::mpi().getRank();
+  if (!recordingInitialized) {
+    if (partOfpreInlet && !velocityPlanCreated) {
+      createVelocityCommunicationPlan();
+    }
+    int records = (partOfpreInlet && (!my_send_blocks.empty() || !velocitySendPlan.empty())) ? 1 : 0;
+    vector<int> allRecords(global::mpi().getSize());
+    MPI_Allgather(&records,1,MPI_INT,allRecords.data(),1,MPI_INT,MPI_COMM_WORLD);
+    vector<int> parts;
+    for (size_t i = 0 ; i < allRecords.size() ; i++) {
+      if (allRecords[i]) { parts.push_back(i); }
+    }
+    if (global::mpi().isMainProcessor()) {
+      InflowRecorder::writeIndex(recordFileName,parts,direction,preinlet_length,fluidInlet,hemocell->cellfields->number_of_cells);
+    }
+    if (records) {
+      vector<Box3D> velocityBoxes;
+      for (const auto & peer : velocitySendPlan) {
+        for (const VelocityTransfer & transfer : peer.second) {
+          velocityBoxes.push_back(transfer.box);
+        }
       }
-      // NOTE: Reading into all blocks should be OK as long as a single block
-      // or adjacent blocks are considered. For blocks that are sparse and/or
-      // spatially "far away", additional checks should be added to avoid
-      // excess extracting of cells that are not present in the current block.
-      for (int bId : hemocell->cellfields->immersedParticles->getLocalInfo().getBlocks()) {
-        hemocell->cellfields->immersedParticles->getComponent(bId).particleDataTransfer.receivePreInlet(&buffers.back()[0],buffers.back().size(),modif::hemocell,offset);
-        hemocell->cellfields->immersedParticles->getComponent(bId).invalidate_ppc();
-        hemocell->cellfields->immersedParticles->getComponent(bId).invalidate_lpc();
-        hemocell->cellfields->immersedParticles->getComponent(bId).invalidate_pg();
+      recorder = new InflowRecorder(recordFileName + "." + to_string(rank) + ".h5",velocityBoxes);
+    }
+    hlog << "(PreInlet) Recording inflow to " << recordFileName << ".h5 from " << parts.size() << " pre-inlet processes" << endl;
+    recordingInitialized = true;
+  }
+
+  if (recorder) {
+    // Same order as the boxes: the velocity plan per peer, in map order
+    vector<T> velocity;
+    for (const auto & peer : velocitySendPlan) {
+      const vector<T> & buffer = velocitySendBuffers[peer.first];
+      velocity.insert(velocity.end(),buffer.begin(),buffer.end());
+    }
+    static const vector<char> noParticles;
+    const vector<char> & particles = (my_send_blocks.empty() || particleBuffers.empty()) ? noParticles : particleBuffers[0];
+    recorder->writeFrame(hemocell->iter,particles,velocity);
+  }
+  global.statistics.getCurrent().stop();
+}
+
+/*
+ * Take the place of the pre-inlet with a recording. Frame iter%frames is used,
+ * so a restart from a checkpoint continues the replay where it was. Every loop
+ * over the recording gives its cells a new range of ids, outside of the cells
+ * loaded in the main domain, so they are not mistaken for cells of the previous
+ * loop. The ranges only move up, ids are never reused: the simulation stops
+ * when they would pass INT_MAX. Cells from the end and start of the recording
+ * can overlap once at the seam of the loop, so record a long enough stream.
+ */
+void PreInlet::replayInflowFrame() {
+  global.statistics.getCurrent()["replayInflow"].start();
+  const int rank = global::mpi().getRank();
+
+  bool needsVelocity = false;
+  for (plint bId : hemocell->lattice->getLocalInfo().getBlocks()) {
+    if (doesIntersect(fluidInlet,hemocell->lattice->getMultiBlockManagement().getBulk(bId))) {
+      needsVelocity = true;
+    }
+  }
+  const bool needsParticles = particleReceiveMpi.find(rank) != particleReceiveMpi.end() && particleReceiveMpi[rank];
+
+  if (!replay && (needsVelocity || needsParticles)) {
+    replay = new InflowReplay(replayFileName);
+    if (replay->direction != direction) {
+      cout << "(PreInlet) (Error) The inflow recording " << replayFileName << " has a different inflow direction, exiting ..." << endl;
+      exit(1);
+    }
+  }
+
+  if (needsVelocity) {
+    const hsize_t frame = hemocell->iter % replay->getNumberOfFrames();
+    vector<T> velocity;
+    for (size_t p = 0 ; p < replay->getNumberOfParts() ; p++) {
+      if (replay->getVelocityBoxes(p).empty()) { continue; }
+      replay->readVelocity(p,frame,velocity);
+      plint boxStart = 0;
+      for (const Box3D & box : replay->getVelocityBoxes(p)) {
+        for (plint bId : hemocell->lattice->getLocalInfo().getBlocks()) {
+          Box3D overlap;
+          if (!intersect(box,hemocell->lattice->getMultiBlockManagement().getBulk(bId),overlap)) { continue; }
+          BlockLattice3D<T,DESCRIPTOR> & block = hemocell->lattice->getComponent(bId);
+          const Dot3D & loc = block.getLocation();
+          for (int x = overlap.x0 ; x <= overlap.x1 ; x++) {
+           for (int y = overlap.y0 ; y <= overlap.y1 ; y++) {
+            for (int z = overlap.z0 ; z <= overlap.z1 ; z++) {
+              const plint i = boxStart + 3*(((x-box.x0)*box.getNy() + (y-box.y0))*box.getNz() + (z-box.z0));
+              Box3D point(x-loc.x,x-loc.x,y-loc.y,y-loc.y,z-loc.z,z-loc.z);
+              setBoundaryVelocity(block,point,plb::Array<T,3>(velocity[i],velocity[i+1],velocity[i+2]));
+            }
+           }
+          }
+        }
+        boxStart += 3*box.nCells();
       }
     }
   }
-  MPI_Barrier(MPI_COMM_WORLD);
+
+  // The insertion is collective over the main domain, ranks without
+  // particles of the recording insert an empty buffer
+  vector<vector<char>> buffers(1);
+  if (needsParticles) {
+    const hsize_t frames = replay->getNumberOfFrames();
+    replay->readParticles(hemocell->iter % frames,buffers[0]);
+
+    const long long base = hemocell->cellfields->number_of_cells;
+    const long long stride = std::max(1LL,replay->maxCellId - replay->minCellId + 1);
+    const long long loop = hemocell->iter / frames;
+    if (replayLoop < 0) {
+      // First frame of this run, continue the numbering of a restart
+      replayIdBase = base + loop*stride;
+    } else if (loop != replayLoop) {
+      replayIdBase += (loop - replayLoop)*stride;
+    }
+    replayLoop = loop;
+    // Stay above the cells of the main domain when there are more of them
+    if (replayIdBase < base) {
+      replayIdBase = base;
+    }
+    if (replayIdBase + stride - 1 > INT_MAX) {
+      cout << "(PreInlet) (Error) The cell ids of loop " << loop << " over the inflow recording would pass INT_MAX, record a shorter stream or replay fewer loops, exiting ..." << endl;
+      exit(1);
+    }
+    const long long shift = replayIdBase - replay->minCellId;
+
+    const Dot3D offset = getParticleOffset();
+    const hemo::Array<T,3> realOffset({(T)offset.x,(T)offset.y,(T)offset.z});
+    const size_t particleSize = sizeof(HemoCellParticle::serializeValues_t);
+    for (size_t pos = 0 ; pos + particleSize <= buffers[0].size() ; pos += particleSize) {
+      HemoCellParticle::serializeValues_t * sv = (HemoCellParticle::serializeValues_t *)&buffers[0][pos];
+      sv->shiftPosition(realOffset);
+      sv->cellId += shift;
+    }
+  }
+  insertPreInletParticles(buffers,Dot3D(0,0,0));
   global.statistics.getCurrent().stop();
 }
 
+/*
+ * Every pre-inlet block whose bulk overlaps the inlet plane sends the velocity
+ * of that overlap to the domain blocks that contain it. The plan is derived
+ * from the (globally known) block structures of both lattices, so both sides
+ * agree on the order of the nodes and only one message per rank pair is
+ * needed each iteration.
+ */
+void PreInlet::createVelocityCommunicationPlan() {
+  velocitySendPlan.clear();
+  velocityRecvPlan.clear();
+
+  const int rank = global::mpi().getRank();
+  const SparseBlockStructure3D & preinletBlocks = hemocell->preinlet_lattice_management->getSparseBlockStructure();
+  const SparseBlockStructure3D & domainBlocks = hemocell->domain_lattice_management->getSparseBlockStructure();
+  const ThreadAttribution & preinletThreads = hemocell->preinlet_lattice_management->getThreadAttribution();
+  const ThreadAttribution & domainThreads = hemocell->domain_lattice_management->getThreadAttribution();
+
+  Box3D inletPart, overlap;
+  for (const auto & preinletBulk : preinletBlocks.getBulks()) {
+    if (!intersect(fluidInlet,preinletBulk.second,inletPart)) { continue; }
+    const int source = preinletThreads.getMpiProcess(preinletBulk.first);
+
+    for (const auto & domainBulk : domainBlocks.getBulks()) {
+      if (!intersect(inletPart,domainBulk.second,overlap)) { continue; }
+      const int dest = domainThreads.getMpiProcess(domainBulk.first);
+
+      if (hemocell->partOfpreInlet && source == rank) {
+        velocitySendPlan[dest].push_back({preinletBulk.first,overlap});
+      }
+      if (!hemocell->partOfpreInlet && dest == rank) {
+        velocityRecvPlan[source].push_back({domainBulk.first,overlap});
+      }
+    }
+  }
+
+  for (const auto & peer : velocitySendPlan) {
+    plint size = 0;
+    for (const VelocityTransfer & transfer : peer.second) { size += transfer.box.nCells(); }
+    velocitySendBuffers[peer.first].resize(3*size);
+  }
+  for (const auto & peer : velocityRecvPlan) {
+    plint size = 0;
+    for (const VelocityTransfer & transfer : peer.second) { size += transfer.box.nCells(); }
+    velocityRecvBuffers[peer.first].resize(3*size);
+  }
+  velocityPlanCreated = true;
+}
+
 void PreInlet::applyPreInletVelocityBoundary() {
   global.statistics.getCurrent()["applyPreInletVelocityBoundary"].start();
-  MPI_Barrier(MPI_COMM_WORLD);
-
-  Box3D & domain = fluidInlet;
-  Box3D result;
-  int z_o = domain.getNz();
-  int y_o = domain.getNy();
-  int tag;
+  if (!velocityPlanCreated) {
+    createVelocityCommunicationPlan();
+  }
 
-  plb::Array<T,3> receiver;
-  plb::Array<T,3> vel;
-  std::vector<plb::Array<T,3>> buffer;
   std::vector<MPI_Request> requests;
+  requests.reserve(velocitySendPlan.size() + velocityRecvPlan.size());
 
-  for (int bId : hemocell->lattice->getLocalInfo().getBlocks()) {
-    Box3D bulk = hemocell->lattice->getMultiBlockManagement().getBulk(bId);
-    if (!intersect(domain,bulk,result)) { continue; }
-
-    const Dot3D & loc = hemocell->lattice->getComponent(bId).getLocation();
-    result = result.shift(-loc.x,-loc.y,-loc.z);
-
-    for (int x  = result.x0 ; x <= result.x1 ; x++) {
-     for (int y  = result.y0 ; y <= result.y1 ; y++) {
-      for (int z  = result.z0 ; z <= result.z1 ; z++) {
-        tag = ((z_o * ((z + loc.z) - domain.z0)) + ( y + loc.y ) - domain.y0) * y_o + x + loc.x - domain.x0;
-        if (!hemocell->lattice->get(x,y,z).getDynamics().isBoundary()) {
-          if (hemocell->partOfpreInlet) {
-            hemocell->lattice->getComponent(bId).get(x,y,z).computeVelocity(vel);
-            int dest = hemocell->domain_lattice_management->getThreadAttribution().getMpiProcess(hemocell->domain_lattice_management->getSparseBlockStructure().locate(x+loc.x,y+loc.y,z+loc.z));
-
-            // send velocity from preInlet boundary
-            buffer.push_back(vel);
-            requests.push_back(MPI_Request());
-            MPI_Isend(&buffer.back()[0],3*sizeof(T),MPI_CHAR,dest,tag,MPI_COMM_WORLD,&requests.back());
-          } else {
-            Box3D point(x,x,y,y,z,z);
-            int source = hemocell->preinlet_lattice_management->getThreadAttribution().getMpiProcess(hemocell->preinlet_lattice_management->getSparseBlockStructure().locate(x+loc.x,y+loc.y,z+loc.z));
+  // Post the receives first, so the slabs can be delivered directly
+  for (auto & peer : velocityRecvBuffers) {
+    requests.push_back(MPI_Request());
+    MPI_Irecv(&peer.second[0],peer.second.size()*sizeof(T),MPI_CHAR,peer.first,PREINLET_VELOCITY_TAG,MPI_COMM_WORLD,&requests.back());
+  }
 
-            // receive velocity from preInlet
-            MPI_Recv(&receiver,3*sizeof(T),MPI_CHAR,source,tag,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+  plb::Array<T,3> vel;
+  for (auto & peer : velocitySendPlan) {
+    std::vector<T> & buffer = velocitySendBuffers[peer.first];
+    plint i = 0;
+    for (const VelocityTransfer & transfer : peer.second) {
+      BlockLattice3D<T,DESCRIPTOR> & block = hemocell->lattice->getComponent(transfer.blockId);
+      const Dot3D & loc = block.getLocation();
+      for (int x = transfer.box.x0 ; x <= transfer.box.x1 ; x++) {
+       for (int y = transfer.box.y0 ; y <= transfer.box.y1 ; y++) {
+        for (int z = transfer.box.z0 ; z <= transfer.box.z1 ; z++) {
+          block.get(x-loc.x,y-loc.y,z-loc.z).computeVelocity(vel);
+          buffer[i++] = vel[0];
+          buffer[i++] = vel[1];
+          buffer[i++] = vel[2];
+        }
+       }
+      }
+    }
+    requests.push_back(MPI_Request());
+    MPI_Isend(&buffer[0],buffer.size()*sizeof(T),MPI_CHAR,peer.first,PREINLET_VELOCITY_TAG,MPI_COMM_WORLD,&requests.back());
+  }
 
-            // update velocity lattice main domain
-            setBoundaryVelocity(hemocell->lattice->getComponent(bId),point,receiver);
-          }
+  MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+  // update velocity lattice main domain, only the velocity boundary nodes
+  // store the velocity, so the solid nodes in the slab can be passed as well
+  for (auto & peer : velocityRecvPlan) {
+    const std::vector<T> & buffer = velocityRecvBuffers[peer.first];
+    plint i = 0;
+    for (const VelocityTransfer & transfer : peer.second) {
+      BlockLattice3D<T,DESCRIPTOR> & block = hemocell->lattice->getComponent(transfer.blockId);
+      const Dot3D & loc = block.getLocation();
+      for (int x = transfer.box.x0 ; x <= transfer.box.x1 ; x++) {
+       for (int y = transfer.box.y0 ; y <= transfer.box.y1 ; y++) {
+        for (int z = transfer.box.z0 ; z <= transfer.box.z1 ; z++) {
+          Box3D point(x-loc.x,x-loc.x,y-loc.y,y-loc.y,z-loc.z,z-loc.z);
+          setBoundaryVelocity(block,point,plb::Array<T,3>(buffer[i],buffer[i+1],buffer[i+2]));
+          i += 3;
         }
+       }
       }
-     }
     }
   }
-  MPI_Waitall(requests.size(), &requests[0], MPI_STATUS_IGNORE);
   global.statistics.getCurrent().stop();
 }
 
@@ -492,7 +795,7 @@ void PreInlet::preInletFromSlice(Direction direction_, Box3D boundary) {
       break;
   }
 
-  inflow_length = (*hemocell->cfg)["domain"]["particleEnvelope"].read<int>();
+  inflow_length = hemocell->cfg->get<int>("domain/particleEnvelope");
   Box3D preInletDomain;
   bool foundPreInlet = false;
   vector<MultiBlock3D*> wrapper;
@@ -626,7 +929,7 @@ void PreInlet::autoPreinletFromBoundary(Direction dir_) {
     fluidDomain.z1 = fluidDomain.z0;
   }
 
-  inflow_length = (*hemocell->cfg)["domain"]["particleEnvelope"].read<int>();
+  inflow_length = hemocell->cfg->get<int>("domain/particleEnvelope");
   Box3D preInletDomain;
   bool foundPreInlet = false;
   vector<MultiBlock3D*> wrapper;
@@ -700,10 +1003,28 @@ void PreInlet::autoPreinletFromBoundary(Direction dir_) {
   }
 }
 
+// Optional <record> or <replay> of the inflow, see recordInflow() and replayInflow()
+void PreInlet::readInflowRecordingConfig() {
+  try {
+    recordFileName = hemocell->cfg->get<string>("preInlet/record");
+  } catch (const std::invalid_argument& e) { }
+  try {
+    replayFileName = hemocell->cfg->get<string>("preInlet/replay");
+  } catch (const std::invalid_argument& e) { }
+  if (!recordFileName.empty() && !replayFileName.empty()) {
+    hlog << "(PreInlet) (Error) Cannot record and replay the inflow at the same time, exiting ..." << endl;
+    exit(1);
+  }
+  if (isReplaying()) {
+    hlog << "(PreInlet) Replaying the inflow from " << replayFileName << ".h5, no pre-inlet is simulated" << endl;
+  }
+}
+
 PreInlet::PreInlet(HemoCell * hemocell_, plb::MultiScalarField3D<int> * flagMatrix_) {
   hemocell = hemocell_;
   flagMatrix = flagMatrix_;
-  preinlet_length = (*hemocell->cfg)["preInlet"]["parameters"]["lengthN"].read<int>();
+  preinlet_length = hemocell->cfg->get<int>("preInlet/parameters/lengthN");
+  readInflowRecordingConfig();
 }
 
 PreInlet::PreInlet(HemoCell * hemocell_, plb::MultiBlockManagement3D & management) {
@@ -717,7 +1038,8 @@ PreInlet::PreInlet(HemoCell * hemocell_, plb::MultiBlockManagement3D & managemen
   wrapper.push_back(hemocell->lattice);
   wrapper.push_back(flagMatrix);
   applyProcessingFunctional(new FillFlagMatrix(),hemocell->lattice->getBoundingBox(),wrapper);
-  preinlet_length = (*hemocell->cfg)["preInlet"]["parameters"]["lengthN"].read<int>();
+  preinlet_length = hemocell->cfg->get<int>("preInlet/parameters/lengthN");
+  readInflowRecordingConfig();
 }
 
 void PreInlet::CreateDrivingForceFunctional::processGenericBlocks(plb::Box3D domain, std::vector<plb::AtomicBlock3D*> blocks) {
@@ -751,7 +1073,7 @@ void PreInlet::calculateDrivingForce() {
 
   map<int,plint> areas;
   plint fluidArea = 0;
-  double re = (*hemocell->cfg)["preInlet"]["parameters"]["Re"].read<T>();
+  double re = hemocell->cfg->get<T>("preInlet/parameters/Re");
 
   if (partOfpreInlet) {
 
@@ -810,7 +1132,7 @@ double PreInlet::average(vector<double> values) {
 bool PreInlet::readNormalizedVelocities() {
 
   // Open file
-  std::string pulseFileName = (*hemocell->cfg)["preInlet"]["parameters"]["pulseFileName"].read<std::string>();
+  std::string pulseFileName = hemocell->cfg->get<std::string>("preInlet/parameters/pulseFileName");
   std::ifstream pulseFile(pulseFileName);
 
   // Check if pulsatility file was found
@@ -839,7 +1161,7 @@ bool PreInlet::readNormalizedVelocities() {
   pulseEndTime = normalizedVelocityTimes[normalizedVelocityTimes.size() - 1];
 
   // Read in pulsatility frequency value. Just leave it at its value as per the input pulse data if it's not in the XML.
-  try  { pFrequency = (*hemocell->cfg)["preInlet"]["parameters"]["pFrequency"].read<double>(); }
+  try  { pFrequency = hemocell->cfg->get<double>("preInlet/parameters/pFrequency"); }
   catch (const std::invalid_argument& e)  { pFrequency = 1.0 / pulseEndTime; }
 
   return true;
@@ -45,9 +45,17 @@ enum Direction : int {
 
 
 #define DSET_SLICE 1000
+// MPI tag of the pre-inlet velocity slabs, distinct from the particle exchanges
+#define PREINLET_VELOCITY_TAG 60
+// MPI tags of the pre-inlet particle counts and particle data
+#define PREINLET_PARTICLE_COUNT_TAG 61
+#define PREINLET_PARTICLE_TAG 62
 
 namespace hemo {
 
+class InflowRecorder;
+class InflowReplay;
+
 
 inline plint cellsInBoundingBox(plb::Box3D const & box) {
   return abs((box.x1 - box.x0)*(box.y1-box.y0)*(box.z1-box.z0));
@@ -81,6 +89,7 @@ public:
 
   PreInlet(hemo::HemoCell * hemocell_, plb::MultiScalarField3D<int> * flagMatrix_);
   PreInlet(hemo::HemoCell * hemocell_, plb::MultiBlockManagement3D & management);
+  ~PreInlet();
   inline plint getNumberOfNodes() { return cellsInBoundingBox(location);}
   void createBoundary();
   bool readNormalizedVelocities();
@@ -90,9 +99,32 @@ public:
   double interpolate(vector<double> &xData, vector<double> &yData, double x, bool extrapolate);
   double average(vector<double> values);
   void applyPreInletVelocityBoundary();
-  void applyPreInletParticleBoundary();
-  void applyPreInlet() { applyPreInletVelocityBoundary();
-                         applyPreInletParticleBoundary(); };
+  void createVelocityCommunicationPlan();
+  /// Blocking particle injection, equal to a start directly followed by a finish
+  void applyPreInletParticleBoundary() { startPreInletParticleBoundary();
+                                         finishPreInletParticleBoundary(); };
+  /// Post the particle exchange, HemoCell::iterate() finishes it before spreading the forces
+  void startPreInletParticleBoundary();
+  /// Insert the received particles in the blocks they belong to, no-op if nothing is pending
+  void finishPreInletParticleBoundary();
+  void createParticleChannels();
+  /// Route serialized particles to the local blocks that contain them after shifting them by offset,
+  /// partly received cells are replaced, collective over the main domain
+  void insertPreInletParticles(std::vector<std::vector<char>> & buffers, Dot3D offset);
+  /// Shift from the pre-inlet to the main domain
+  Dot3D getParticleOffset() const;
+  void applyPreInlet();
+
+  /// Record the particle stream and inlet velocities sent to the main domain
+  /// to <fileName>.h5 (index) and <fileName>.<rank>.h5 (data)
+  void recordInflow(std::string fileName) { recordFileName = fileName; }
+  /// Replay a recorded inflow in a loop instead of simulating the pre-inlet,
+  /// must be called before HemoCell::initializeLattice()
+  void replayInflow(std::string fileName) { replayFileName = fileName; }
+  inline bool isReplaying() const { return !replayFileName.empty(); }
+  void recordInflowFrame();
+  void replayInflowFrame();
+  void readInflowRecordingConfig();
   void initializePreInletParticleBoundary();
   void initializePreInletVelocityBoundary();
   void initializePreInlet() { initializePreInletVelocityBoundary(); initializePreInletParticleBoundary(); };
@@ -123,6 +155,37 @@ public:
   int inflow_length = 0;
   int preinlet_length = 0;
   bool communications_mapped = false;
+
+  /// Part of the inlet plane that one pre-inlet block sends to one domain
+  /// block, the box is in global coordinates
+  struct VelocityTransfer {
+    plint blockId; // Local block on this rank
+    plb::Box3D box;
+  };
+  /// Per peer rank, the transfers in the (shared) order of the message
+  std::map<int,std::vector<VelocityTransfer>> velocitySendPlan;
+  std::map<int,std::vector<VelocityTransfer>> velocityRecvPlan;
+  std::map<int,std::vector<T>> velocitySendBuffers;
+  std::map<int,std::vector<T>> velocityRecvBuffers;
+  bool velocityPlanCreated = false;
+
+  /// Persistent channels of the particle counts, one per peer in
+  /// my_send_blocks (pre-inlet) or my_recv_blocks (domain)
+  std::vector<MPI_Request> particleCountRequests;
+  std::vector<MPI_Request> particleDataRequests;
+  std::vector<unsigned long long> particleCounts;
+  std::vector<std::vector<char>> particleBuffers;
+  bool particleChannelsCreated = false;
+  bool particleExchangePending = false;
+
+  std::string recordFileName, replayFileName;
+  InflowRecorder * recorder = 0;
+  InflowReplay * replay = 0;
+  /// First cell id of the current loop over the recording and that loop
+  long long replayIdBase = 0;
+  long long replayLoop = -1;
+  bool recordingInitialized = false;
+
   std::vector<int> particle_receivers;
   std::vector<int> particle_senders;
   HemoCell * hemocell;
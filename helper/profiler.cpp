@@ -27,16 +27,33 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "parallelism/mpiManager.h"
 
+#include <cmath>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
 namespace hemo {
   
+unsigned int Profiler::counter_depth = 0;
+
 Profiler::Profiler(std::string name_) :
-name(name_), parent(*this), current(this)
+name(name_), parent(*this), root(this), current(this), depth(0)
 {}
 
 Profiler::Profiler(std::string name_, Profiler & parent_) :
-name(name_), parent(parent_)
+name(name_), parent(parent_), root(parent_.root), depth(parent_.depth+1)
 {}
 
+bool Profiler::enableHardwareCounters(unsigned int depth_) {
+  if (!HardwareCounters::open()) {
+    hemo::hlog << "(Profiler) (Warning) Hardware counters are not available (perf_event_open), only measuring wall clock time" << std::endl;
+    counter_depth = 0;
+    return false;
+  }
+  counter_depth = depth_;
+  return true;
+}
+
 void Profiler::start() {
   if (started) {
     hemo::hlog << "(Profiler) (Warning) Timer " << name << " has already been started" << std::endl;
@@ -46,10 +63,13 @@ void Profiler::start() {
       hemo::hlog << "(Profiler) (Warning) Starting timer " << name << " but parent has not been started, starting it for now but you should fix this in the code " << std::endl;
       parent.start();
     }
-    start_time = std::chrono::high_resolution_clock::now();
+    if (counting()) { HardwareCounters::read(counter_start); }
+    start_time = clock::now();
     started = true;
+    if (&parent != this) { parent.started_children++; }
   }
-  
+
+#ifndef NDEBUG
   //Check siblings for started
   for (std::pair<const std::string,Profiler> & timer_pair : parent.timers) {
     Profiler & timer = timer_pair.second;
@@ -58,71 +78,87 @@ void Profiler::start() {
       hemo::hlog << "(Profiler) (Warning) Starting timer " << name << " but sibling " << timer.name << " has also been started, starting it for now but you should fix this in the code " << std::endl;
     }
   }
-  
-  //Set current
+#endif
+
+  //Set current, only the current of the root is used
   current = this;
-  Profiler * root = this;
-  do  {
-    root = &root->parent;
-    root->current = this;
-  } while (root != &root->parent);  
+  root->current = this;
+}
+
+void Profiler::stop_children() {
+  //Only descend when a child timer is still running
+  if (!started_children) { return; }
+  for (std::pair<const std::string,Profiler> & timer_pair : timers) {
+    Profiler & timer = timer_pair.second;
+    timer.stop_nowarn();
+  }
+}
+
+void Profiler::record_event() {
+  if (root->tracing) {
+    root->trace_events.push_back({this, std::max(start_time, root->trace_start), clock::now()});
+  }
+}
+
+void Profiler::accumulate() {
+  record_event();
+  total_time += std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(clock::now() - start_time);
+  started = false;
+  if (counting()) {
+    HardwareCounters::Values counter_stop;
+    HardwareCounters::read(counter_stop);
+    for (int i = 0 ; i < HardwareCounters::NUMBER_OF_COUNTERS ; i++) {
+      // Scaling for multiplexing does not guarantee monotonic values
+      if (counter_stop[i] > counter_start[i]) { counter_total[i] += counter_stop[i] - counter_start[i]; }
+    }
+  }
+  if (&parent != this) { parent.started_children--; }
 }
 
 void Profiler::stop_nowarn() {
   if (started)
   {
-    std::chrono::high_resolution_clock::time_point stop_time = std::chrono::high_resolution_clock::now();
-    total_time = total_time + (stop_time - start_time);
-    started = false;
+    accumulate();
   }
-  
+
   //Stop all child timers
-  for (std::pair<const std::string,Profiler> & timer_pair : timers) {
-    Profiler & timer = timer_pair.second;
-    timer.stop_nowarn();
-  }
+  stop_children();
 }
 
 void Profiler::stop() {
   if (!started) {
     hemo::hlog << "(Profiler) (Warning) Timer " << name << " has not been started" << std::endl;
   } else {
-    std::chrono::high_resolution_clock::time_point stop_time = std::chrono::high_resolution_clock::now();
-    total_time = total_time + (stop_time - start_time);
-    started = false;
+    accumulate();
   }
-  
+
   //Stop all child timers
-  for (std::pair<const std::string,Profiler> & timer_pair : timers) {
-    Profiler & timer = timer_pair.second;
-    timer.stop_nowarn();
-  }
-  
+  stop_children();
+
   //Adjust current timer
   current = &parent;
-  Profiler * root = this;
-  do  {
-    root = &root->parent;
-    root->current = &parent;
-  } while (root != &root->parent);  
+  root->current = &parent;
 }
 
 void Profiler::reset() {
+  if (started && &parent != this) { parent.started_children--; }
   started = false;
   total_time = std::chrono::high_resolution_clock::duration::zero();
+  counter_total.fill(0);
   
   //Reset all child timers
   for (std::pair<const std::string,Profiler> & timer_pair : timers) {
     Profiler & timer = timer_pair.second;
     timer.reset();
   }
+  started_children = 0;
 }
 
 std::chrono::high_resolution_clock::duration Profiler::elapsed() {
   if (!started) {
     return total_time;
   } else {
-    return total_time + (std::chrono::high_resolution_clock::now() - start_time);
+    return total_time + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(clock::now() - start_time);
   }
 }
 
@@ -130,17 +166,26 @@ std::string Profiler::elapsed_string() {
   if (!started) {
     return std::to_string(((double)std::chrono::duration_cast<std::chrono::milliseconds>(total_time).count())/1000.0);
   } else {
-    return std::to_string(((double)std::chrono::duration_cast<std::chrono::milliseconds>(total_time+(std::chrono::high_resolution_clock::now() - start_time)).count())/1000.0);
+    return std::to_string(((double)std::chrono::duration_cast<std::chrono::milliseconds>(total_time+std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(clock::now() - start_time)).count())/1000.0);
   }
 }
 
 template<typename T>
 void Profiler::printStatistics_inner(int level, T & out) {
   if (!started) {
-    out << std::string(level,' ') << name << ": " << std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(total_time).count()/1000.0) << std::endl;
+    out << std::string(level,' ') << name << ": " << std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(total_time).count()/1000.0);
   } else {
-    out << std::string(level,' ') << name << ": " << std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(total_time + (std::chrono::high_resolution_clock::now() - start_time)).count()/1000.0) << std::endl;
+    out << std::string(level,' ') << name << ": " << std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(total_time + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(clock::now() - start_time)).count()/1000.0);
   }
+  if (counting()) {
+    for (int i = 0 ; i < HardwareCounters::NUMBER_OF_COUNTERS ; i++) {
+      out << " " << HardwareCounters::name(i) << ": " << counter_total[i];
+    }
+    if (counter_total[HardwareCounters::CYCLES]) {
+      out << " IPC: " << std::to_string((double)counter_total[HardwareCounters::INSTRUCTIONS]/counter_total[HardwareCounters::CYCLES]);
+    }
+  }
+  out << std::endl;
   //Print all child timers
   for (std::pair<const std::string,Profiler> & timer_pair : timers) {
     Profiler & timer = timer_pair.second;
@@ -176,7 +221,150 @@ void Profiler::outputStatistics() {
     }
     plb::global::mpi().barrier();
     turn++;
-  }  
+  }
+  outputReport(hlog.filename + ".statistics.json");
+}
+
+void Profiler::collect(const std::string & prefix, std::map<std::string,Measurement> & values) {
+  std::string path = prefix.empty() ? name : prefix + "/" + name;
+  values[path] = {std::chrono::duration<double>(elapsed()).count(), counter_total};
+  for (std::pair<const std::string,Profiler> & timer_pair : timers) {
+    timer_pair.second.collect(path, values);
+  }
+}
+
+void Profiler::outputReport(const std::string & fileName) {
+  int rank = plb::global::mpi().getRank();
+  int size = plb::global::mpi().getSize();
+
+  std::map<std::string,Measurement> local;
+  collect("", local);
+
+  // The union of the timer paths of all processes, the trees can differ per process
+  std::string localPaths;
+  for (const std::pair<const std::string,Measurement> & value : local) {
+    localPaths += value.first + '\n';
+  }
+  int localLength = localPaths.size();
+  std::vector<int> lengths(size), displacements(size, 0);
+  MPI_Allgather(&localLength, 1, MPI_INT, lengths.data(), 1, MPI_INT, MPI_COMM_WORLD);
+  for (int i = 1 ; i < size ; i++) {
+    displacements[i] = displacements[i-1] + lengths[i-1];
+  }
+  std::string allPaths(displacements.back() + lengths.back(), '\0');
+  MPI_Allgatherv(&localPaths[0], localLength, MPI_CHAR, &allPaths[0], lengths.data(), displacements.data(), MPI_CHAR, MPI_COMM_WORLD);
+
+  std::set<std::string> pathSet;
+  std::istringstream pathStream(allPaths);
+  std::string path;
+  while (std::getline(pathStream, path)) {
+    pathSet.insert(path);
+  }
+  std::vector<std::string> paths(pathSet.begin(), pathSet.end());
+
+  // A timer that does not exist on a process took no time there
+  const int nCounters = HardwareCounters::NUMBER_OF_COUNTERS;
+  std::vector<double> values(paths.size(), 0.), squares(paths.size());
+  std::vector<double> counters(paths.size()*nCounters, 0.);
+  std::vector<std::pair<double,int>> valueRanks(paths.size());
+  for (size_t i = 0 ; i < paths.size() ; i++) {
+    std::map<std::string,Measurement>::iterator found = local.find(paths[i]);
+    if (found != local.end()) {
+      values[i] = found->second.seconds;
+      for (int c = 0 ; c < nCounters ; c++) {
+        counters[i*nCounters + c] = found->second.counters[c];
+      }
+    }
+    squares[i] = values[i]*values[i];
+    valueRanks[i] = {values[i], rank};
+  }
+
+  std::vector<double> minimum(paths.size()), sum(paths.size()), sumSquares(paths.size());
+  std::vector<double> counterSum(counters.size());
+  std::vector<std::pair<double,int>> maximum(paths.size());
+  MPI_Reduce(values.data(), minimum.data(), paths.size(), MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(values.data(), sum.data(), paths.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(squares.data(), sumSquares.data(), paths.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(valueRanks.data(), maximum.data(), paths.size(), MPI_DOUBLE_INT, MPI_MAXLOC, 0, MPI_COMM_WORLD);
+  // Always reduced, the counters can be unavailable on some processes only
+  MPI_Reduce(counters.data(), counterSum.data(), counters.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+  if (rank != 0) { return; }
+  std::ofstream out(fileName);
+  if (!out.is_open()) {
+    hemo::hlog << "(Profiler) (Error) Opening " << fileName << ", no profiler report written" << std::endl;
+    return;
+  }
+  out << std::setprecision(9);
+  out << "{\n  \"processes\": " << size << ",\n  \"unit\": \"s\",\n  \"timers\": [";
+  for (size_t i = 0 ; i < paths.size() ; i++) {
+    double mean = sum[i]/size;
+    double variance = std::max(0., sumSquares[i]/size - mean*mean);
+    out << (i ? ",\n" : "\n") << "    {\"path\": \"" << paths[i] << "\", \"min\": " << minimum[i]
+        << ", \"mean\": " << mean << ", \"max\": " << maximum[i].first
+        << ", \"stddev\": " << std::sqrt(variance) << ", \"maxProcess\": " << maximum[i].second;
+    // Mean over the processes of the hardware counters, zero for uncounted timers
+    if (counter_depth) {
+      for (int c = 0 ; c < nCounters ; c++) {
+        out << ", \"" << HardwareCounters::name(c) << "\": " << counterSum[i*nCounters + c]/size;
+      }
+    }
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+void Profiler::startTrace() {
+  trace_events.clear();
+  // Align the time origin of all processes
+  plb::global::mpi().barrier();
+  trace_start = clock::now();
+  tracing = true;
+}
+
+void Profiler::outputTrace(const std::string & fileName) {
+  tracing = false;
+  int rank = plb::global::mpi().getRank();
+  int size = plb::global::mpi().getSize();
+
+  // Complete events ("ph":"X") in microseconds, nesting follows from the times
+  std::ostringstream events;
+  events << std::fixed << std::setprecision(3);
+  events << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rank << ", \"args\": {\"name\": \"Process " << rank << "\"}}";
+  for (const TraceEvent & event : trace_events) {
+    events << ",\n{\"name\": \"" << event.timer->name << "\", \"ph\": \"X\", \"pid\": " << rank << ", \"tid\": 0"
+           << ", \"ts\": " << std::chrono::duration<double,std::micro>(event.begin - trace_start).count()
+           << ", \"dur\": " << std::chrono::duration<double,std::micro>(event.end - event.begin).count() << "}";
+  }
+  trace_events.clear();
+  trace_events.shrink_to_fit();
+
+  std::string localEvents = events.str();
+  int localLength = localEvents.size();
+  std::vector<int> lengths(size), displacements(size, 0);
+  MPI_Gather(&localLength, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+  std::string allEvents;
+  if (rank == 0) {
+    for (int i = 1 ; i < size ; i++) {
+      displacements[i] = displacements[i-1] + lengths[i-1];
+    }
+    allEvents.resize(displacements.back() + lengths.back());
+  }
+  MPI_Gatherv(&localEvents[0], localLength, MPI_CHAR, &allEvents[0], lengths.data(), displacements.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+
+  if (rank != 0) { return; }
+  std::ofstream out(fileName);
+  if (!out.is_open()) {
+    hemo::hlog << "(Profiler) (Error) Opening " << fileName << ", no profiler trace written" << std::endl;
+    return;
+  }
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  for (int i = 0 ; i < size ; i++) {
+    out << (i ? ",\n" : "");
+    out.write(&allEvents[displacements[i]], lengths[i]);
+  }
+  out << "\n]}\n";
+  hemo::hlog << "(Profiler) Written trace of " << size << " processes to " << fileName << std::endl;
 }
 
 
@@ -188,6 +376,27 @@ Profiler & Profiler::operator[] (std::string name) {
   return timers.at(name);
 };
 
+std::vector<std::string> & Profiler::timerNames() {
+  static std::vector<std::string> names;
+  return names;
+}
+
+Profiler::TimerId Profiler::timerId(const std::string & name) {
+  std::vector<std::string> & names = timerNames();
+  for (TimerId id = 0 ; id < names.size() ; id++) {
+    if (names[id] == name) { return id; }
+  }
+  names.push_back(name);
+  return names.size() - 1;
+}
+
+Profiler & Profiler::child(TimerId id) {
+  Profiler & timer = (*this)[timerNames()[id]];
+  if (children.size() <= id) { children.resize(timerNames().size(), nullptr); }
+  children[id] = &timer;
+  return timer;
+}
+
 Profiler & Profiler::getCurrent() {
   if (this != &parent) {
     hemo::hlog << "(Profiler) (Warning) getCurrent called from non-root Profiler object, this will probably be incorrect" << std::endl;
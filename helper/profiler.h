@@ -28,7 +28,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <chrono>
 #include <string>
 #include <map>
+#include <vector>
 #include <logfile.h>
+#include "hardwareCounters.h"
+
+/**
+ * Resolve a timer name to its TimerId once per call site, use as
+ * global.statistics.getCurrent()[HEMO_TIMER("MpiSend")].start();
+ */
+#define HEMO_TIMER(name) ([]() -> hemo::Profiler::TimerId { \
+  static const hemo::Profiler::TimerId id = hemo::Profiler::timerId(name); \
+  return id; }())
 
 namespace hemo {
 /**
@@ -43,6 +53,20 @@ namespace hemo {
  * started (sub)timer. With this functionality you can time a function
  * which is called through different paths as different functions in the
  * hierarchy.
+ *
+ * Timer names can be registered once as a TimerId (see HEMO_TIMER), which
+ * resolves a subtimer through a cached index instead of a string lookup. The
+ * consistency checks of start (started siblings) are only done in debug builds.
+ *
+ * outputStatistics also reduces the timer trees of all processes into a single
+ * <log>.statistics.json (min/mean/max/stddev per timer and the process holding
+ * the max). Between startTrace and outputTrace every stopped timer is recorded
+ * as an event, the events of all processes are written as one Chrome trace
+ * (chrome://tracing, Perfetto) with a process per rank.
+ *
+ * With enableHardwareCounters(depth) the timers up to that depth in the
+ * hierarchy (e.g. 3: HemoCell, iterate and its phases) also accumulate the
+ * hardware counters of HardwareCounters, which are reported next to the time.
  */
 class Profiler {
 public:
@@ -54,25 +78,68 @@ public:
   void reset();
   void printStatistics();
   void outputStatistics();
+  /// Reduce the timers over all processes and write them as JSON, collective
+  void outputReport(const std::string & fileName);
+  /// Count hardware events in the timers above depth, false if not available
+  static bool enableHardwareCounters(unsigned int depth);
+  /// Start recording timer events, collective
+  void startTrace();
+  /// Stop recording and write the events of all processes, collective
+  void outputTrace(const std::string & fileName);
   
   std::chrono::high_resolution_clock::duration elapsed();
   std::string elapsed_string();
   Profiler & operator[] (std::string);
   Profiler & getCurrent();
 
+  typedef unsigned int TimerId;
+  /// Register a timer name, the same name always gets the same id
+  static TimerId timerId(const std::string & name);
+  Profiler & operator[] (TimerId id) {
+    if (id < children.size() && children[id]) { return *children[id]; }
+    return child(id);
+  }
+
   std::string static toString(std::chrono::high_resolution_clock::duration);
 
 private:
+  typedef std::chrono::steady_clock clock;
+  static std::vector<std::string> & timerNames();
+  Profiler & child(TimerId id);
   void stop_nowarn();
+  void stop_children();
+  void record_event();
+  // Add the time and hardware counters since start() to the totals
+  void accumulate();
+  struct Measurement {
+    double seconds;
+    HardwareCounters::Values counters;
+  };
+  void collect(const std::string & prefix, std::map<std::string,Measurement> & values);
+  bool counting() const { return depth < counter_depth; }
+  static unsigned int counter_depth;
   template<typename T>
   void printStatistics_inner(int level, T & out);
   std::chrono::high_resolution_clock::duration total_time = std::chrono::high_resolution_clock::duration::zero();
-  std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+  clock::time_point start_time = clock::now();
   bool started = false;
+  unsigned int started_children = 0;
   const std::string name;
   std::map<std::string,Profiler> timers;
+  std::vector<Profiler *> children; // Subtimers indexed by TimerId, filled on first use
   Profiler & parent;
+  Profiler * root;
   Profiler * current = this;
+  unsigned int depth;
+  HardwareCounters::Values counter_start = {}, counter_total = {};
+
+  struct TraceEvent {
+    const Profiler * timer;
+    clock::time_point begin, end;
+  };
+  bool tracing = false;
+  clock::time_point trace_start;
+  std::vector<TraceEvent> trace_events; // Only used in the root
 };
 }
 #endif /* PROFILER_H */
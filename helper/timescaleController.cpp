@@ -0,0 +1,119 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "timescaleController.h"
+
+namespace hemo {
+
+// Largest power of two not larger than x, at least 1 and at most maximum
+static unsigned int powerOfTwoBelow(T x, unsigned int maximum) {
+  unsigned int s = 1;
+  while (s*2 <= maximum && s*2 <= x) {
+    s *= 2;
+  }
+  return s;
+}
+
+TimescaleController::TimescaleController(HemoCell & hemocell_, unsigned int maxSeparation_, unsigned int interval_) :
+  hemocell(hemocell_)
+{
+  maxSeparation = powerOfTwoBelow(maxSeparation_, maxSeparation_ ? maxSeparation_ : 1);
+  // Only change separations at iterations where all updates are due
+  interval = max(interval_, maxSeparation);
+  interval += (maxSeparation - interval % maxSeparation) % maxSeparation;
+  hlog << "(TimescaleController) Adapting timescale separations up to " << maxSeparation << " timesteps every " << interval << " iterations" << endl;
+}
+
+unsigned int TimescaleController::limit(unsigned int current, unsigned int wanted, unsigned int minimum) const {
+  wanted = min(wanted, powerOfTwoBelow(2*current, maxSeparation));
+  return max(wanted, minimum);
+}
+
+void TimescaleController::update() {
+  HemoCellFields & cellfields = *hemocell.cellfields;
+  const unsigned int ntypes = cellfields.size();
+  const int range = ceil(cellfields.repulsionCutoff) + 2;
+
+  // velocity, -nearest cell distance, force ratio per cell type
+  vector<double> measured(2 + ntypes, 0.);
+  measured[1] = -range;
+  const vector<plint> & blocks = hemocell.lattice->getMultiBlockManagement().getLocalInfo().getBlocks();
+  for (const plint & bId : blocks) {
+    HemoCellParticleField & pf = cellfields.immersedParticles->getComponent(bId);
+    for (const HemoCellParticle & particle : pf.particles) {
+      const hemo::Array<T,3> v = particle.sv.getVelocity();
+      measured[0] = max(measured[0], (double)sqrt(v[0]*v[0]+v[1]*v[1]+v[2]*v[2]));
+      const hemo::Array<T,3> f = particle.sv.force + particle.sv.force_repulsion;
+      measured[2+particle.sv.celltype] = max(measured[2+particle.sv.celltype], (double)(sqrt(f[0]*f[0]+f[1]*f[1]+f[2]*f[2])/param::f_limit));
+    }
+    if (hemocell.repulsionEnabled) {
+      measured[1] = max(measured[1], -(double)pf.nearestCellDistance(range));
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, measured.data(), measured.size(), MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  const T velocity = measured[0];
+  const T nearest = -measured[1];
+
+  // The velocity separation must keep dividing the separations that are not
+  // adapted, the largest power of two that does is the lowest bit set in any
+  pluint fixed = 0;
+  if (hemocell.boundaryRepulsionEnabled) {
+    fixed |= cellfields.boundaryRepulsionTimescale;
+  }
+  if (global.enableInteriorViscosity) {
+    fixed |= cellfields.interiorViscosityTimescale | cellfields.interiorViscosityEntireGridTimescale;
+  }
+  const unsigned int velocityMaximum = fixed ? min<pluint>(maxSeparation, fixed & (~fixed + 1)) : maxSeparation;
+
+  const T displacementSteps = velocity > 0. ? maxDisplacement/velocity : maxSeparation;
+  const unsigned int velocitySeparation = limit(cellfields.particleVelocityUpdateTimescale,
+                                                powerOfTwoBelow(displacementSteps, velocityMaximum), 1);
+  if (velocitySeparation != cellfields.particleVelocityUpdateTimescale) {
+    hlogfile << "(TimescaleController) Iteration " << hemocell.iter << ": velocity update separation " << cellfields.particleVelocityUpdateTimescale << " -> " << velocitySeparation << " (v_max " << velocity << ")" << endl;
+    cellfields.particleVelocityUpdateTimescale = velocitySeparation;
+  }
+
+  for (unsigned int i = 0 ; i < ntypes ; i++) {
+    const T forceSteps = measured[2+i] > 0. ? maxForceFraction/measured[2+i] : maxSeparation;
+    const unsigned int separation = limit(cellfields[i]->timescale,
+                                          powerOfTwoBelow(min(displacementSteps, forceSteps), maxSeparation),
+                                          velocitySeparation);
+    if (separation != cellfields[i]->timescale) {
+      hlogfile << "(TimescaleController) Iteration " << hemocell.iter << ": material separation of " << cellfields[i]->name << " " << cellfields[i]->timescale << " -> " << separation << " (F_max/F_limit " << measured[2+i] << ")" << endl;
+      cellfields[i]->timescale = separation;
+    }
+  }
+
+  if (hemocell.repulsionEnabled) {
+    const T gap = nearest - cellfields.repulsionCutoff;
+    const T gapSteps = gap <= 0. ? 1. : (velocity > 0. ? gap/(2.*velocity) : maxSeparation);
+    const unsigned int separation = limit(cellfields.repulsionTimescale,
+                                          powerOfTwoBelow(gapSteps, maxSeparation), velocitySeparation);
+    if (separation != cellfields.repulsionTimescale) {
+      hlogfile << "(TimescaleController) Iteration " << hemocell.iter << ": repulsion separation " << cellfields.repulsionTimescale << " -> " << separation << " (nearest cell " << nearest << " LU)" << endl;
+      cellfields.repulsionTimescale = separation;
+    }
+  }
+}
+
+}
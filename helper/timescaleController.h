@@ -0,0 +1,75 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef HEMO_TIMESCALE_CONTROLLER_H
+#define HEMO_TIMESCALE_CONTROLLER_H
+
+namespace hemo {
+  class TimescaleController;
+}
+#include "hemocell.h"
+
+namespace hemo {
+/**
+ * Adjusts the timescale separations of the velocity update, the material
+ * models and the repulsion at runtime, enabled through
+ * HemoCell::enableAdaptiveTimescaleSeparation(). Every interval iterations the
+ * largest vertex velocity, the largest vertex force relative to FORCE_LIMIT
+ * (per cell type) and the smallest distance between two cells are reduced over
+ * all processes, and each separation is set to the largest power of two for
+ * which:
+ *
+ *   velocity   v_max * s <= maxDisplacement
+ *   material   v_max * s <= maxDisplacement and F_max/F_limit * s <= maxForceFraction
+ *   repulsion  2 * v_max * s <= nearest cell distance - repulsionCutoff
+ *
+ * A separation at most doubles per update but drops immediately. The material
+ * and repulsion separations stay multiples of the velocity separation and the
+ * velocity separation keeps dividing the separations that are not adapted
+ * (boundary repulsion and interior viscosity), so the sanity check invariants
+ * hold. The interval is a multiple of maxSeparation, so a new separation always
+ * starts at an iteration where every update is due.
+ */
+class TimescaleController {
+public:
+  TimescaleController(HemoCell & hemocell, unsigned int maxSeparation, unsigned int interval);
+
+  /// Measure and update the separations, collective
+  void update();
+
+  unsigned int getInterval() const { return interval; }
+
+  /// Displacement in lattice units a vertex may make on a stale velocity or force
+  T maxDisplacement = 0.05;
+  /// Fraction of FORCE_LIMIT a vertex force may accumulate over a material separation
+  T maxForceFraction = 0.5;
+
+private:
+  unsigned int limit(unsigned int current, unsigned int wanted, unsigned int minimum) const;
+
+  HemoCell & hemocell;
+  unsigned int maxSeparation;
+  unsigned int interval;
+};
+}
+#endif
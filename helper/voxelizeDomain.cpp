@@ -151,4 +151,15 @@ void getFlagMatrixFromSTL(std::string meshFileName, plint extendedEnvelopeWidth,
 
 }
 
+// ---------------------- Export for packCells ---------------------------------
+
+void writeFlagMatrix(MultiScalarField3D<int> & flagMatrix, T dx, std::string fileName) {
+    Box3D domain = flagMatrix.getBoundingBox();
+    plb_ofstream file(fileName.c_str());
+    // Header: nx ny nz dx[µm], followed by the flags ordered x, y, z (z fastest)
+    file << domain.getNx() << " " << domain.getNy() << " " << domain.getNz() << " " << dx*1e6 << endl;
+    file << flagMatrix << endl;
+    hlog << "(Voxelizer) Flag matrix written to " << fileName << ", use it with packCells --flags" << endl;
+}
+
 }
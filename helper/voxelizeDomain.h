@@ -51,5 +51,10 @@ void getFlagMatrixFromSTL(std::string meshFileName, plb::plint extendedEnvelopeW
                           plb::VoxelizedDomain3D<T> *&voxelizedDomain, plb::MultiScalarField3D<int> *&flagMatrix, plint blockSize, int particleEnvelope = 0);
 void getFlagMatrixFromSTL(std::string meshFileName, plb::plint extendedEnvelopeWidth, plb::plint refDirLength, plb::plint refDir,
                           std::auto_ptr<plb::VoxelizedDomain3D<T>> & voxelizedDomain, std::auto_ptr<plb::MultiScalarField3D<int>> &flagMatrix, plint blockSize, int particleEnvelope = 0);
+
+/// Write the flag matrix (1 = fluid, 0 = solid) in the format read by
+/// packCells --flags, so cells can be packed in the fluid region directly.
+/// dx is the lattice spacing in [m].
+void writeFlagMatrix(plb::MultiScalarField3D<int> & flagMatrix, T dx, std::string fileName);
 }
 #endif
@@ -41,6 +41,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 /* Helpers */
 #include "preInlet.h"
+#include "blockTelemetry.h"
+#include "timescaleController.h"
 // #include "leesEdwardsBC.h"
 
 /* Always used palabos functions in case files*/
@@ -104,6 +106,16 @@ class HemoCell {
    */
   void latticeEquilibrium(T rho, hemo::Array<T, 3> vel);
 
+  /**
+   *  Set a constant force on all fluid nodes, for example the driving force of
+   *  a channel flow. Unlike a plb::setExternalVector() after every iterate()
+   *  this is kept without sweeping the whole lattice each iteration.
+   *
+   *  @param force the force density in lbm units
+   */
+  void setBodyForce(hemo::Array<T, 3> force);
+  hemo::Array<T, 3> bodyForce = {0.,0.,0.};
+
   /**
    * Initialice the cellfields structure (and thus also the particlefield)
    */
@@ -145,6 +157,7 @@ class HemoCell {
   // Lees-Edwards boundary condition
   bool leesEdwardsBC = false;
   double * LEcurrentDisplacement;
+  T LEvelocityShift = 0.; // Velocity jump (bottom - top wall) of particles crossing the sheared boundary
 
   //Set the timescale separation of the particles of a particle type
   void setMaterialTimeScaleSeparation(string name, unsigned int separation);
@@ -152,7 +165,10 @@ class HemoCell {
   //Enable solidify mechanics of a celltype
   void enableSolidifyMechanics(string name) {
     hlog << "(HemoCell) Enabling Solidify Mechanics for " << name << " mechanical model" << endl;
-    (*cellfields)[name]->doSolidifyMechanics = true;
+    HemoCellField * field = (*cellfields)[name];
+    field->doSolidifyMechanics = true;
+    field->solidifyDistanceThreshold = field->mechanics->cfg["MaterialModel"]["distanceThreshold"].read<T>();
+    field->solidifyShearThreshold = field->mechanics->cfg["MaterialModel"]["shearThreshold"].read<T>();
   }
   
   //Set the separation of when velocity is interpolated to the particle
@@ -165,6 +181,14 @@ class HemoCell {
 
   //Set the timescale separation of the interior viscosity, in between update and raytracing (expensive) update
   void setInteriorViscosityTimeScaleSeperation(unsigned int separation, unsigned int separation_entire_grid);
+
+  //Let the velocity update, material and repulsion timescale separations adapt to the
+  //measured vertex velocities, forces and cell distances, see helper/timescaleController.h
+  void enableAdaptiveTimescaleSeparation(unsigned int maxSeparation, unsigned int interval = 0);
+
+  //Sort the particles in memory every interval timesteps (0 disables), on the Morton order of their
+  //position or on cell and vertex id, improves the cache locality of the IBM kernels on large blocks
+  void setParticleReorderTimescale(unsigned int interval, bool byCell = false);
   
   //Enable Boundary particles and set the boundary particle constants
   void enableBoundaryParticles(T boundaryRepulsionConstant, T boundaryRepulsionCutoff, unsigned int timestep = 1);
@@ -230,6 +254,8 @@ public:
   map<plint,plint> BlockToMpi;
   
   LoadBalancer * loadBalancer = 0;
+  BlockTelemetry * blockTelemetry = 0;
+  TimescaleController * timescaleController = 0;
   ///The fluid lattice
   MultiBlockLattice3D<T, DESCRIPTOR> * lattice = 0, *preinlet_lattice = 0, * domain_lattice = 0;
   
@@ -44,7 +44,6 @@ void writeFluidField_HDF5(HemoCellFields& cellfields, T dx, T dt, plint iter, st
   global.statistics.getCurrent()["writeFluidField"].start();
 
   if(std::find(cellfields.desiredFluidOutputVariables.begin(), cellfields.desiredFluidOutputVariables.end(), OUTPUT_FORCE) != cellfields.desiredFluidOutputVariables.end()) {
-    hlogfile << "(FluidOutput) (OutputForce) The force on the fluid field is reset to zero, If there is a bodyforce, reset it after this output function (FluidField write force, OUTPUT_FORCE)" << endl; 
     cellfields.spreadParticleForce();
   }
   WriteFluidField<DESCRIPTOR> * wff = new WriteFluidField<DESCRIPTOR>(cellfields, *cellfields.lattice,iter,"Fluid",dx,dt,cellfields.desiredFluidOutputVariables);
@@ -53,10 +52,11 @@ void writeFluidField_HDF5(HemoCellFields& cellfields, T dx, T dt, plint iter, st
   wrapper.push_back(cellfields.immersedParticles); //Needed for the atomicblock id, nothing else
   applyProcessingFunctional(wff,cellfields.lattice->getBoundingBox(),wrapper);
   if(std::find(cellfields.desiredFluidOutputVariables.begin(), cellfields.desiredFluidOutputVariables.end(), OUTPUT_FORCE) != cellfields.desiredFluidOutputVariables.end()) {
-    // Reset Forces on the lattice, TODO do own efficient implementation
+    // Reset Forces on the lattice to the body force
+    const hemo::Array<T,3> & bodyForce = cellfields.hemocell.bodyForce;
     plb::setExternalVector(*cellfields.hemocell.lattice, (*cellfields.hemocell.lattice).getBoundingBox(),
           DESCRIPTOR<T>::ExternalField::forceBeginsAt,
-          plb::Array<T, DESCRIPTOR<T>::d>(0.0, 0.0, 0.0));
+          plb::Array<T, DESCRIPTOR<T>::d>(bodyForce[0], bodyForce[1], bodyForce[2]));
   }
   
   global.statistics.getCurrent().stop();
@@ -64,9 +64,9 @@ void HemoCellParticleField::outputPositions(Box3D domain,vector<vector<T>>& outp
       sparticle = &particles[particles_per_cell.at(cellid)[i]];
 
       vector<T> pbv;
-      pbv.push_back(sparticle->sv.position[0]);
-      pbv.push_back(sparticle->sv.position[1]);
-      pbv.push_back(sparticle->sv.position[2]);
+      pbv.push_back(sparticle->sv.getPosition()[0]);
+      pbv.push_back(sparticle->sv.getPosition()[1]);
+      pbv.push_back(sparticle->sv.getPosition()[2]);
       output.push_back(pbv); //TODO, memory copy
 
     }
@@ -96,9 +96,9 @@ void HemoCellParticleField::outputVelocities(Box3D domain,vector<vector<T>>& out
       sparticle = &particles[particles_per_cell.at(cellid)[i]];
 
       vector<T> pbv;
-      pbv.push_back(sparticle->sv.v[0]);
-      pbv.push_back(sparticle->sv.v[1]);
-      pbv.push_back(sparticle->sv.v[2]);
+      pbv.push_back(sparticle->sv.getVelocity()[0]);
+      pbv.push_back(sparticle->sv.getVelocity()[1]);
+      pbv.push_back(sparticle->sv.getVelocity()[2]);
       output.push_back(pbv); //TODO, memory copy
     }
   }
@@ -22,8 +22,13 @@ You should have received a copy of the GNU Affero General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "readPositionsBloodCells.h"
-#include "tools/packCells/geometry.h"
+#include "tools/packCells/cellPositionsBinary.h"
 #include <sstream>
+#include <numeric>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "logfile.h"
 #include "hemocell.h"
 #include "preInlet.h"
@@ -33,16 +38,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace hemo {
 
-/// Rotates a triangular surface mesh inplace. The rotation is applied in order
+/// Computes the rotation matrix of a cell. The rotation is applied in order
 /// X, Y, Z. NOTE: plb::TriangularSurfaceMesh does provide an method to rotate
 /// the surface mesh, however, that routine is defined in ZYX order.
-template<typename T>
-void rotateTriangularMeshXYZ(plb::TriangularSurfaceMesh<T>* mesh, T alpha, T beta, T gamma) {
-  PLB_ASSERT((theta > T() || util::fpequal(theta, T(), eps0)) &&
-             (theta < PI  || util::fpequal(theta, PI, eps0)));
-
+void rotationMatrixXYZ(T alpha, T beta, T gamma, T a[3][3]) {
   // Rotation matrix around x axis (column-first)
-  T a[3][3];
   a[0][0] =  (T) 1.0;
   a[0][1] =  (T) 0.0;
   a[0][2] =  (T) 0.0;
@@ -96,37 +96,24 @@ void rotateTriangularMeshXYZ(plb::TriangularSurfaceMesh<T>* mesh, T alpha, T bet
           }
       }
   }
-
-  for (auto iVertex = 0; iVertex < mesh->getNumVertices(); iVertex++) {
-      Array<T,3> x = mesh->getVertex(iVertex);
-      for (int i = 0; i < 3; i++) {
-          mesh->getVertex(iVertex)[i] = (T) 0.0;
-          for (int j = 0; j < 3; j++) {
-              mesh->getVertex(iVertex)[i] += a[i][j]*x[j];
-          }
-      }
-  }
-}
-
-inline void meshRotation (TriangularSurfaceMesh<T> * mesh, hemo::Array<T,3> rotationAngles) {
-    plb::Array<T,2> xRange, yRange, zRange;
-    mesh->computeBoundingBox (xRange, yRange, zRange);
-    plb::Array<T,3> meshCenter = plb::Array<T,3>(xRange[1] + xRange[0], yRange[1] + yRange[0], zRange[1] + zRange[0]) * (T)0.5;
-    mesh->translate((T)-1.0 * meshCenter);
-    rotateTriangularMeshXYZ(mesh, rotationAngles[0], rotationAngles[1], rotationAngles[2]);
-    mesh->translate(meshCenter);
 }
 
 inline void positionCellInParticleField(HemoCellParticleField& particleField, BlockLattice3D<T,DESCRIPTOR>& fluid,
-                                            TriangularSurfaceMesh<T> * mesh, hemo::Array<T,3> startingPoint, plint cellId, pluint celltype) {
-    plint nVertices=mesh->getNumVertices();
+                                        const vector<hemo::Array<T,3>> & cellTemplate, const CellPosition & cell,
+                                        pluint celltype) {
     Box3D fluidbb = fluid.getBoundingBox();
     Dot3D rrelfluidloc; // used later;
-    int denyLayerSize; // used later;
     HemoCellParticle::serializeValues_t to_add_particle; // used_later
 
-    for (plint iVertex=0; iVertex < nVertices; ++iVertex) {
-        hemo::Array<T,3> vertex = startingPoint + mesh->getVertex(iVertex);
+    // Deny particles that are in the outer most layer, aka. the "shear layer"
+    const int denyLayerSize = ((*particleField.cellFields)[celltype]->minimumDistanceFromSolid*1e-6)/param::dx;
+    const T (&R)[3][3] = cell.rotation;
+
+    for (pluint iVertex=0; iVertex < cellTemplate.size(); ++iVertex) {
+        const hemo::Array<T,3> & v = cellTemplate[iVertex];
+        const hemo::Array<T,3> vertex = {cell.position[0] + R[0][0]*v[0] + R[0][1]*v[1] + R[0][2]*v[2],
+                                         cell.position[1] + R[1][0]*v[0] + R[1][1]*v[1] + R[1][2]*v[2],
+                                         cell.position[2] + R[2][0]*v[0] + R[2][1]*v[1] + R[2][2]*v[2]};
         
         //If we cannot place it in the particle field continue
         if (!particleField.isContainedABS(vertex,particleField.getBoundingBox())) { continue; }
@@ -145,9 +132,6 @@ inline void positionCellInParticleField(HemoCellParticleField& particleField, Bl
             }
         } 
             
-      //bool neighboringBoundariesAnywhere = false;  
-      // Deny particles that are in the outer most layer, aka. the "shear layer"    
-      denyLayerSize = ((*particleField.cellFields)[celltype]->minimumDistanceFromSolid*1e-6)/param::dx;
       for (int px = -denyLayerSize; px <= denyLayerSize; ++px) {  
         for (int py = -denyLayerSize; py <= denyLayerSize; ++py) { 
           for (int pz = -denyLayerSize; pz <= denyLayerSize; ++pz) {
@@ -163,7 +147,7 @@ inline void positionCellInParticleField(HemoCellParticleField& particleField, Bl
         }  
       }
       
-      to_add_particle = HemoCellParticle(vertex,cellId,iVertex,celltype).sv;
+      to_add_particle = HemoCellParticle(vertex,cell.cellId,iVertex,celltype).sv;
       particleField.addParticle(to_add_particle);
 no_add:;
     }
@@ -172,6 +156,14 @@ no_add:;
 int getTotalNumberOfCells(HemoCellFields & cellFields){
   int nCells, totalCells = 0;
   for (pluint j = 0; j < cellFields.size(); j++) {
+    const string binaryFile = cellFields[j]->name + ".posb";
+    if (file_exists(binaryFile)) {
+      PosbHeader header;
+      fstream fIn(binaryFile, fstream::in | fstream::binary);
+      fIn.read((char *)&header, sizeof(PosbHeader));
+      totalCells += isValidPosbHeader(header) ? header.count : 0;
+      continue;
+    }
     fstream fIn;
     fIn.open(cellFields[j]->name + ".pos", fstream::in);
     fIn >> nCells;
@@ -182,182 +174,268 @@ int getTotalNumberOfCells(HemoCellFields & cellFields){
   
 }
 
-bool first_time =true;
-void getReadPositionsBloodCellsVector(Box3D realDomain,
-                                            std::vector<TriangularSurfaceMesh<T>* > & meshes,
-                                            std::vector<plint> & Np,
-                                            std::vector<std::vector<hemo::Array<T,3> > > & positions,
-                                            std::vector<std::vector<plint> > & cellIds,
-                                            std::vector<std::vector<hemo::Array<T,3> > > & randomAngles,
-                                            T dx, Config & cfg, HemoCellFields & cellFields,
-                                            HemoCellParticleField & particleField)
-{
-
-    
-
-
-    vector<vector3> packPositions[cellFields.size()];
-    vector<vector3> packAngles[cellFields.size()];
-    vector<plint> cellIdss[cellFields.size()];
+/// Reads a text .pos file on the main processor and broadcasts its content
+/// as x y z alpha beta gamma per cell. Returns the number of cells.
+static int readTextPositions(const string & filename, vector<T> & packed) {
+  int Np = 0;
+  if (global::mpi().isMainProcessor()) {
+    fstream fIn;
+    fIn.open(filename, fstream::in);
+    if(!fIn.is_open()) {
+      cout << "*** WARNING! particle positions input file " << filename << " does not exist!" << endl;
+    } else {
+      fIn >> Np;
+      packed.resize(6*Np);
+      for (int i = 0; i < 6*Np; i++) {
+        fIn >> packed[i];
+      }
+    }
+  }
+  global::mpi().bCast(&Np, 1);
+  packed.resize(6*Np);
+  if (Np > 0) {
+    global::mpi().bCast(packed.data(), 6*Np);
+  }
+  return Np;
+}
 
-    Np.resize(cellFields.size());
+/// Reads the cells of a binary .posb file that lie within any of the regions
+/// (x0 x1 y0 y1 z0 z1 in [µm]). The file is memory mapped, and as the records
+/// are sorted on bins only the pages of the overlapping bins are read from
+/// disk. Returns the total number of cells in the file.
+static int readBinaryPositions(const string & filename, const vector<hemo::Array<T,6>> & regions,
+                               vector<T> & packed, vector<plint> & ids) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PosbHeader)) {
+    hlog << "(readPositionsBloodCells) (Error) Cannot read binary position file " << filename << ", exiting..." << endl;
+    exit(1);
+  }
+  void * map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    hlog << "(readPositionsBloodCells) (Error) Cannot map binary position file " << filename << ", exiting..." << endl;
+    exit(1);
+  }
+  // We jump between bins, reading ahead would touch pages we do not need
+  madvise(map, st.st_size, MADV_RANDOM);
+
+  const PosbHeader & header = *(const PosbHeader *)map;
+  const uint64_t nBins = posbNumberOfBins(header);
+  if (!isValidPosbHeader(header) || header.units != POSB_UNITS_MICROMETER_DEGREE ||
+      (size_t)st.st_size != sizeof(PosbHeader) + (nBins+1)*sizeof(uint64_t) + header.count*sizeof(PosbRecord)) {
+    hlog << "(readPositionsBloodCells) (Error) " << filename << " is not a valid binary position file (version " << POSB_VERSION << "), exiting..." << endl;
+    exit(1);
+  }
+  const uint64_t * binStart = (const uint64_t *)((const char *)map + sizeof(PosbHeader));
+  const PosbRecord * records = (const PosbRecord *)(binStart + nBins + 1);
+
+  vector<bool> visited(nBins, false);
+  for (const hemo::Array<T,6> & region : regions) {
+    for (uint32_t bx = posbBinOf(header, 0, region[0]); bx <= posbBinOf(header, 0, region[1]); bx++) {
+      for (uint32_t by = posbBinOf(header, 1, region[2]); by <= posbBinOf(header, 1, region[3]); by++) {
+        for (uint32_t bz = posbBinOf(header, 2, region[4]); bz <= posbBinOf(header, 2, region[5]); bz++) {
+          const uint64_t b = posbLinearBin(header, bx, by, bz);
+          if (visited[b]) { continue; }
+          visited[b] = true;
+          for (uint64_t r = binStart[b]; r < binStart[b+1]; r++) {
+            packed.insert(packed.end(), records[r].position, records[r].position+3);
+            packed.insert(packed.end(), records[r].rotation, records[r].rotation+3);
+            ids.push_back(r);
+          }
+        }
+      }
+    }
+  }
+  const int count = header.count;
+  munmap(map, st.st_size);
+  return count;
+}
 
-    int cellid = 0;
-    // TODO: proper try-catch
-    for(pluint j = 0; j < Np.size(); j++) {
+/* ******** CellPositionIndex *********************************** */
+CellPositionIndex::CellPositionIndex(HemoCellFields & cellFields, T dx) {
+  const T posRatio = 1e-6/dx;
+  cells.resize(cellFields.size());
+  templates.resize(cellFields.size());
+  bucketStart.resize(cellFields.size());
+  bucketEntries.resize(cellFields.size());
+
+  hemo::Array<T,3> offset = {0.,0.,0.};
+  if (cellFields.hemocell.preInlet && cellFields.hemocell.preInlet->initialized) {
+    //Translate system to preInlet Location (set 0,0,0 point)
+    offset = {T(cellFields.hemocell.preInlet->location.x0),
+              T(cellFields.hemocell.preInlet->location.y0),
+              T(cellFields.hemocell.preInlet->location.z0)};
+  }
 
-        // Reading data from file
-        fstream fIn;
-        fIn.open(cellFields[j]->name + ".pos", fstream::in);
+  // The regions of the local atomic blocks in the [µm] frame of the position
+  // files, only these are read from binary position files
+  vector<hemo::Array<T,6>> regions;
+  for (plint blockId : cellFields.lattice->getLocalInfo().getBlocks()) {
+    SmartBulk3D bulk(cellFields.lattice->getMultiBlockManagement(), blockId);
+    const Box3D block = bulk.getBulk().enlarge(cellFields.envelopeSize);
+    regions.push_back({(block.x0-offset[0])/posRatio, (block.x1-offset[0])/posRatio,
+                       (block.y0-offset[1])/posRatio, (block.y1-offset[1])/posRatio,
+                       (block.z0-offset[2])/posRatio, (block.z1-offset[2])/posRatio});
+  }
 
-        if(!fIn.is_open())
-        {
-            cout << "*** WARNING! particle positions input file " << cellFields[j]->name << ".pos does not exist!" << endl;
-        }
+  for (pluint ct = 0; ct < cellFields.size(); ct++) {
+    // The seeds as x y z alpha beta gamma [µm, degrees], and their index
+    // within the position file
+    vector<T> packed;
+    vector<plint> ids;
+    int Np;
+    const string binaryFile = cellFields[ct]->name + ".posb";
+    if (file_exists(binaryFile)) {
+      Np = readBinaryPositions(binaryFile, regions, packed, ids);
+    } else {
+      Np = readTextPositions(cellFields[ct]->name + ".pos", packed);
+      ids.resize(Np);
+      std::iota(ids.begin(), ids.end(), 0);
+    }
+    hlog << "(readPositionsBloodCells) Particle count in file (" << cellFields[ct]->name << "): " << Np << "." << endl;
 
-        fIn >> Np[j];
-        if (first_time) {
-          hlog << "(readPositionsBloodCells) Particle count in file (" << cellFields[j]->name << "): " << Np[j] << "." << endl;
-        }
-        packPositions[j].resize(Np[j]); packAngles[j].resize(Np[j]);cellIdss[j].resize(Np[j]);
-        int less = 0;
-        for (plint i = 0; i < Np[j]; i++) {
-            fIn >> 
-              packPositions[j][i-less][0] >> packPositions[j][i-less][1] >> packPositions[j][i-less][2] >> 
-              packAngles[j][i-less][0] >> packAngles[j][i-less][1] >> packAngles[j][i-less][2];
-            packAngles[j][i-less] *= PI/180.0; // Deg to Rad
-            packAngles[j][i-less] *= -1.0;  // Right- to left-handed coordinate system
-            cellIdss[j][i-less] = cellid;
-
-            if (cellFields.hemocell.preInlet && cellFields.hemocell.preInlet->initialized) {
-              //Translate system to preInlet Location (set 0,0,0 point)
-              packPositions[j][i-less][0] += cellFields.hemocell.preInlet->location.x0/dx;
-              packPositions[j][i-less][1] += cellFields.hemocell.preInlet->location.y0/dx;
-              packPositions[j][i-less][2] += cellFields.hemocell.preInlet->location.z0/dx;
-            }
-            
-            //Check if it actually fits (mostly) in this atomic block
-            if (packPositions[j][i-less][0]*dx < realDomain.x0 - cfg["domain"]["particleEnvelope"].read<int>() ||
-                packPositions[j][i-less][0]*dx > realDomain.x1 + cfg["domain"]["particleEnvelope"].read<int>() ||
-                packPositions[j][i-less][1]*dx < realDomain.y0 - cfg["domain"]["particleEnvelope"].read<int>() ||
-                packPositions[j][i-less][1]*dx > realDomain.y1 + cfg["domain"]["particleEnvelope"].read<int>() ||
-                packPositions[j][i-less][2]*dx < realDomain.z0 - cfg["domain"]["particleEnvelope"].read<int>() ||
-                packPositions[j][i-less][2]*dx > realDomain.z1 + cfg["domain"]["particleEnvelope"].read<int>()) {
-              less ++;
-            }
-            cellid++;
+    cells[ct].resize(ids.size());
+    for (unsigned int i = 0; i < ids.size(); i++) {
+      CellPosition & cell = cells[ct][i];
+      for (int d = 0; d < 3; d++) {
+        cell.position[d] = packed[6*i+d]*posRatio + offset[d];
+      }
+      // Deg to Rad, and right- to left-handed coordinate system
+      const T degToRad = -PI/180.0;
+      rotationMatrixXYZ(packed[6*i+3]*degToRad, packed[6*i+4]*degToRad,
+                        packed[6*i+5]*degToRad, cell.rotation);
+      cell.cellId = numberOfCells + ids[i];
+    }
+    numberOfCells += Np;
 
-        }
-        //Destroy unwanted particles and adjust list size;
-        Np[j] -= less;
-        packPositions[j].resize(Np[j]);
-        packAngles[j].resize(Np[j]);
-        cellIdss[j].resize(Np[j]);
+    // Store the mesh vertices relative to the center of its bounding box
+    TriangularSurfaceMesh<T> & mesh = cellFields[ct]->getMesh();
+    plb::Array<T,2> xRange, yRange, zRange;
+    mesh.computeBoundingBox (xRange, yRange, zRange);
+    const hemo::Array<T,3> center = {(xRange[0]+xRange[1])/(T)2.0,
+                                     (yRange[0]+yRange[1])/(T)2.0,
+                                     (zRange[0]+zRange[1])/(T)2.0};
+    templates[ct].resize(mesh.getNumVertices());
+    for (plint iVertex = 0; iVertex < mesh.getNumVertices(); iVertex++) {
+      templates[ct][iVertex] = hemo::Array<T,3>(mesh.getVertex(iVertex)) - center;
+    }
+  }
 
-        fIn.close();
+  // A single bucket grid covering all seeds, one envelope wide per bucket,
+  // so a block query visits at most a few buckets in every direction
+  bucketSize = std::max(cellFields.envelopeSize, (pluint)1);
+  hemo::Array<T,3> upper = {0.,0.,0.};
+  bool first = true;
+  for (const vector<CellPosition> & cellsOfType : cells) {
+    for (const CellPosition & cell : cellsOfType) {
+      for (int d = 0; d < 3; d++) {
+        if (first || cell.position[d] < origin[d]) { origin[d] = cell.position[d]; }
+        if (first || cell.position[d] > upper[d]) { upper[d] = cell.position[d]; }
+      }
+      first = false;
     }
-    
-    cellFields.number_of_cells = getTotalNumberOfCells(cellFields);
-    
-    // Copy results of packing to appropriate hemo::Arrays for ficsion
-    positions.clear();	positions.resize(Np.size());
-    randomAngles.clear(); randomAngles.resize(Np.size());
-    cellIds.clear();	cellIds.resize(Np.size());
+  }
+  for (int d = 0; d < 3; d++) {
+    nBuckets[d] = plint((upper[d]-origin[d])/bucketSize) + 1;
+  }
+  for (pluint ct = 0; ct < cellFields.size(); ct++) {
+    buildBuckets(ct);
+  }
+}
 
+hemo::Array<plint,3> CellPositionIndex::bucketOf(const hemo::Array<T,3> & position) const {
+  hemo::Array<plint,3> bucket;
+  for (int d = 0; d < 3; d++) {
+    bucket[d] = std::min(std::max(plint(std::floor((position[d]-origin[d])/bucketSize)), (plint)0), nBuckets[d]-1);
+  }
+  return bucket;
+}
 
-    for (pluint i = 0; i < Np.size(); ++i)
-    {
-        positions[i].resize(Np[i]);
-        cellIds[i].resize(Np[i]);
-        randomAngles[i].resize(Np[i]);
-
-        for (plint j = 0; j < Np[i]; ++j)
-        {
-            // Store mesh positions and rotations
-            //randomAngles[i][j] = hemo::Array<T, 3>(1.0,0.0,0.0);
-            randomAngles[i][j] = hemo::Array<T, 3>({packAngles[i][j][0], packAngles[i][j][1], packAngles[i][j][2]});
-            positions[i][j] =hemo::Array<T,3>({packPositions[i][j][0], packPositions[i][j][1], packPositions[i][j][2]});
-            cellIds[i][j] = cellIdss[i][j];
+void CellPositionIndex::buildBuckets(unsigned int celltype) {
+  const vector<CellPosition> & cellsOfType = cells[celltype];
+  vector<unsigned int> & start = bucketStart[celltype];
+  vector<unsigned int> & entries = bucketEntries[celltype];
+  vector<unsigned int> bucketIds(cellsOfType.size());
+
+  // Counting sort of the seeds over the buckets
+  start.assign(nBuckets[0]*nBuckets[1]*nBuckets[2]+1, 0);
+  for (unsigned int i = 0; i < cellsOfType.size(); i++) {
+    const hemo::Array<plint,3> b = bucketOf(cellsOfType[i].position);
+    bucketIds[i] = (b[0]*nBuckets[1] + b[1])*nBuckets[2] + b[2];
+    start[bucketIds[i]+1]++;
+  }
+  for (unsigned int b = 1; b < start.size(); b++) {
+    start[b] += start[b-1];
+  }
+  entries.resize(cellsOfType.size());
+  vector<unsigned int> fill(start.begin(), start.end()-1);
+  for (unsigned int i = 0; i < cellsOfType.size(); i++) {
+    entries[fill[bucketIds[i]]++] = i;
+  }
+}
 
+void CellPositionIndex::findCells(const Box3D & domain, unsigned int celltype,
+                                  vector<const CellPosition *> & found) const {
+  found.clear();
+  if (cells[celltype].empty()) { return; }
+  const hemo::Array<plint,3> lower = bucketOf({T(domain.x0), T(domain.y0), T(domain.z0)});
+  const hemo::Array<plint,3> upper = bucketOf({T(domain.x1), T(domain.y1), T(domain.z1)});
+  const vector<unsigned int> & start = bucketStart[celltype];
+  const vector<unsigned int> & entries = bucketEntries[celltype];
+
+  for (plint bx = lower[0]; bx <= upper[0]; bx++) {
+    for (plint by = lower[1]; by <= upper[1]; by++) {
+      for (plint bz = lower[2]; bz <= upper[2]; bz++) {
+        const plint b = (bx*nBuckets[1] + by)*nBuckets[2] + bz;
+        for (unsigned int e = start[b]; e < start[b+1]; e++) {
+          const CellPosition & cell = cells[celltype][entries[e]];
+          if (cell.position[0] < domain.x0 || cell.position[0] > domain.x1 ||
+              cell.position[1] < domain.y0 || cell.position[1] > domain.y1 ||
+              cell.position[2] < domain.z0 || cell.position[2] > domain.z1) {
+            continue;
+          }
+          found.push_back(&cell);
         }
+      }
     }
-    first_time = false;
+  }
 }
 
 
-
 /* ******** ReadPositionMultipleCellField3D *********************************** */
 void ReadPositionsBloodCellField3D::processGenericBlocks (
         Box3D domain, std::vector<AtomicBlock3D*> blocks )
 {  
     int numberOfCellFields = blocks.size() -1;
-    //T ratio;
     BlockLattice3D<T,DESCRIPTOR>& fluid =
             *dynamic_cast<BlockLattice3D<T,DESCRIPTOR>*>(blocks[0]);
     std::vector<HemoCellParticleField* > particleFields(numberOfCellFields);
-    std::vector<T> volumes(numberOfCellFields);
-    std::vector<TriangularSurfaceMesh<T>* > meshes(numberOfCellFields);
-    std::vector<ElementsOfTriangularSurfaceMesh<T> > emptyEoTSM(numberOfCellFields);
-    std::vector<plint> Np(numberOfCellFields);
-
-    T totalVolumeFraction=0;
-
-    //T Vdomain = domain.getNx() * domain.getNy() * domain.getNz();
 
     Dot3D fLocation(fluid.getLocation());
     Box3D realDomain(
             domain.x0 + fLocation.x, domain.x1 + fLocation.x,
             domain.y0 + fLocation.y, domain.y1 + fLocation.y,
             domain.z0 + fLocation.z, domain.z1 + fLocation.z );
-    plb::Array<T,2> xRange, yRange, zRange;
+    //Only seeds that fit (mostly) in this atomic block
+    const Box3D searchDomain = realDomain.enlarge(cellFields.envelopeSize);
 
     for (pluint iCF = 0; iCF < cellFields.size(); ++iCF) {
-
-        TriangularSurfaceMesh<T> * mesh = copyTriangularSurfaceMesh(cellFields[iCF]->getMesh(), emptyEoTSM[iCF]);
-        mesh->computeBoundingBox (xRange, yRange, zRange);
-        mesh->translate(plb::Array<T,3>(-(xRange[0]+xRange[1])/2.0, -(yRange[0]+yRange[1])/2.0, -(zRange[0]+zRange[1])/2.0));
-        meshes[iCF] = mesh;
-        volumes[iCF] = MeshMetrics<T>(*mesh).getVolume();
-
-        totalVolumeFraction += volumes[iCF];
         particleFields[iCF] = ( dynamic_cast<HemoCellParticleField*>(blocks[iCF+1]) );
         particleFields[iCF]->removeParticles(particleFields[iCF]->getBoundingBox());
     }
-   
-
-    std::vector<std::vector<hemo::Array<T,3> > > positions;
-    std::vector<std::vector<plint> > cellIds;
-    std::vector<std::vector<hemo::Array<T,3> > > randomAngles;
-
-    // Note: this method uses the center of the particles for location
-    T posRatio = 1e-6/dx;
-    getReadPositionsBloodCellsVector(realDomain, meshes, Np, positions, cellIds, randomAngles, posRatio, cfg, cellFields,*particleFields[0]);
 
-    // Change positions to match dx (it is in um originally)
-    T wallWidth = 0; // BB wall in [lu]. Offset to count in width of the wall in particle position (useful for pipeflow, not necessarily useful elswhere)
-    
-    for (pluint iCF = 0; iCF < positions.size(); ++iCF)
+    std::vector<const CellPosition *> found;
+    for (pluint iCF = 0; iCF < cellFields.size(); ++iCF)
     {
-        for (pluint c = 0; c < positions[iCF].size(); ++c)
-        {
-            ElementsOfTriangularSurfaceMesh<T> emptyEoTSMCopy;
-    	    TriangularSurfaceMesh<T> * meshCopy = copyTriangularSurfaceMesh(*meshes[iCF], emptyEoTSMCopy);
-    	    
-            meshRotation (meshCopy, randomAngles[iCF][c]);
-            
+        index.findCells(searchDomain, iCF, found);
+        for (const CellPosition * cell : found) {
             positionCellInParticleField(*(particleFields[iCF]), fluid,
-                                         meshCopy, positions[iCF][c]*posRatio+wallWidth, cellIds[iCF][c], iCF); 
-			delete meshCopy;
+                                        index.getTemplate(iCF), *cell, iCF);
         }
 
         particleFields[iCF]->deleteIncompleteCells(iCF,false);
-        std::vector<HemoCellParticle*> particles;
-        particleFields[iCF]->findParticles(particleFields[iCF]->getBoundingBox(), particles, iCF);
-        
-        delete meshes[iCF];
     }
-    //cout << "Atomic Block ID: " << particleFields[0]->atomicBlockId;
-    //cout    << " Total complete cells (with periodicity): " << particleFields[0]->get_lpc().size() << std::endl;
 }
 
 
@@ -398,14 +476,17 @@ void readPositionsBloodCellField3D(HemoCellFields & cellFields, T dx, Config & c
         fluidAndParticleFieldsArg.push_back(cellFields[icf]->getParticleField3D());
     }
     hlog << "(readPositionsBloodCells) Reading particle positions..." << std::endl;
+
+    // Every process constructs the index, as it contains a broadcast
+    CellPositionIndex index(cellFields, dx);
     
     if (cellFields.hemocell.preInlet && cellFields.hemocell.preInlet->initialized && !cellFields.hemocell.partOfpreInlet) { } else {
     applyProcessingFunctional(
-            new ReadPositionsBloodCellField3D(cellFields, dx, cfg),
+            new ReadPositionsBloodCellField3D(cellFields, index, cfg),
             cellFields.lattice->getBoundingBox(), fluidAndParticleFieldsArg);
     hlogfile << "Mpi Process: " << global::mpi().getRank()  << " Completed loading particles" << std::endl;
     }
-    cellFields.number_of_cells = getTotalNumberOfCells(cellFields);
+    cellFields.number_of_cells = index.getNumberOfCells();
 }
 
 }
@@ -35,28 +35,65 @@ namespace hemo {
 void readPositionsBloodCellField3D(HemoCellFields & cellFields, T dx, Config & cfg);
 int getTotalNumberOfCells(HemoCellFields & cellFields);
 
-void getReadPositionsBloodCellsVector(plb::Box3D realDomain,
-                                           std::vector<plb::TriangularSurfaceMesh<T>* > & meshes,
-                                           std::vector<plint> & Np,
-                                           std::vector<std::vector<hemo::Array<T,3> > > & positions,
-                                           std::vector<std::vector<plint> > & cellIds,
-                                           std::vector<std::vector<hemo::Array<T,3> > > & randomAngles,
-                                           Config & cfg, HemoCellFields & cellFields,
-                                           HemoCellParticleField & particleField);
+/// Computes the rotation matrix applied to a cell template, in X, Y, Z order.
+void rotationMatrixXYZ(T alpha, T beta, T gamma, T rotation[3][3]);
+
+/// A single cell seed read from a `<CellType>.pos` file. The position is in
+/// lattice units and the rotation is stored as a precomputed matrix.
+struct CellPosition {
+  hemo::Array<T,3> position;
+  T rotation[3][3];
+  plint cellId;
+};
+
+/*
+ * Contains all cell seeds of all celltypes. The `.pos` files are parsed once
+ * on the main processor and broadcasted, after which the seeds are bucketed on
+ * a uniform grid such that every atomic block only visits the seeds that can
+ * overlap it. The centered vertices of every celltype mesh are stored once as
+ * a template which is rotated and translated per seed.
+ */
+class CellPositionIndex {
+public:
+  CellPositionIndex(HemoCellFields & cellFields, T dx);
+
+  /// Find all seeds of a celltype with its center within domain (lattice units)
+  void findCells(const plb::Box3D & domain, unsigned int celltype,
+                 std::vector<const CellPosition *> & found) const;
+
+  const std::vector<hemo::Array<T,3>> & getTemplate(unsigned int celltype) const {
+    return templates[celltype];
+  }
+  int getNumberOfCells() const { return numberOfCells; }
+
+private:
+  void buildBuckets(unsigned int celltype);
+  hemo::Array<plint,3> bucketOf(const hemo::Array<T,3> & position) const;
+
+  std::vector<std::vector<CellPosition>> cells;
+  std::vector<std::vector<hemo::Array<T,3>>> templates;
+  /// Bucket grid per celltype, stored compressed: the seeds of bucket `b`
+  /// are bucketEntries[bucketStart[b]] up to bucketEntries[bucketStart[b+1]]
+  std::vector<std::vector<unsigned int>> bucketStart, bucketEntries;
+  hemo::Array<T,3> origin = {0.,0.,0.};
+  hemo::Array<plint,3> nBuckets = {1,1,1};
+  T bucketSize = 1.;
+  int numberOfCells = 0;
+};
 
 class ReadPositionsBloodCellField3D : public plb::BoxProcessingFunctional3D
 {
 public:
-    ReadPositionsBloodCellField3D (HemoCellFields & cellFields_, T dx_, Config & cfg_)
-            : cellFields(cellFields_), cfg(cfg_) {dx = dx_;}
+    ReadPositionsBloodCellField3D (HemoCellFields & cellFields_, CellPositionIndex const & index_, Config & cfg_)
+            : cellFields(cellFields_), index(index_), cfg(cfg_) {}
     /// Arguments: [0] Particle-field.
     virtual void processGenericBlocks(plb::Box3D domain, std::vector<plb::AtomicBlock3D*> fields);
     virtual ReadPositionsBloodCellField3D* clone() const;
     virtual void getTypeOfModification(std::vector<plb::modif::ModifT>& modified) const;
     void getModificationPattern(std::vector<bool>& isWritten) const;
     virtual plb::BlockDomain::DomainT appliesTo() const;
-    T dx;
     HemoCellFields & cellFields;
+    CellPositionIndex const & index;
     Config & cfg;
 };
 }
@@ -31,7 +31,9 @@ void writeCellInfo_CSV(HemoCell & hemocell) {
   global.statistics.getCurrent()["writeCellCSVInfo"].start();
 
   map<int,CellInformation> info_per_cell;
-  CellInformationFunctionals::calculateCellInformation(&hemocell,info_per_cell);
+  CellInformationFunctionals::calculateCellInformation(&hemocell,info_per_cell,
+    CellInformationFunctionals::POSITION | CellInformationFunctionals::VELOCITY |
+    CellInformationFunctionals::AREA | CellInformationFunctionals::VOLUME);
   for (auto it = info_per_cell.cbegin(); it != info_per_cell.cend() ;) 
   {
     if (!it->second.centerLocal) {
@@ -48,7 +48,7 @@ class CellMechanics {
   
   
   T calculate_kLink(Config & cfg, plb::MeshMetrics<T> & meshmetric){
-    T kLink = cfg["MaterialModel"]["kLink"].read<T>();
+    T kLink = cfg.get<T>("MaterialModel/kLink");
     T persistenceLengthFine = 7.5e-9; // In [m] -> this is the biological value.
     T plc = persistenceLengthFine/param::dx; //* sqrt((meshmetric.getNumVertices()-2.0) / (23867-2.0)); // <- Constant from the Karniadakis group. We don't use this.
     return  kLink * param::kBT_lbm/plc;
@@ -56,25 +56,25 @@ class CellMechanics {
   
   T calculate_kBend(Config & cfg, plb::MeshMetrics<T> & meshmetric ){
     T eqLength = 5e-7/param::dx;
-    return cfg["MaterialModel"]["kBend"].read<T>() * param::kBT_lbm / eqLength;
+    return cfg.get<T>("MaterialModel/kBend") * param::kBT_lbm / eqLength;
   };
 
   T calculate_kVolume(Config & cfg, plb::MeshMetrics<T> & meshmetric){
-    T kVolume =  cfg["MaterialModel"]["kVolume"].read<T>();
+    T kVolume =  cfg.get<T>("MaterialModel/kVolume");
     T eqLength = 5e-7/param::dx;
     T NfacesScaling = 1280.0/cellConstants.triangle_list.size();
     return kVolume * NfacesScaling * param::kBT_lbm / eqLength;
   };
 
   T calculate_kArea(Config & cfg, plb::MeshMetrics<T> & meshmetric){
-    T kArea =  cfg["MaterialModel"]["kArea"].read<T>();
+    T kArea =  cfg.get<T>("MaterialModel/kArea");
     T eqLength = 5e-7/param::dx;
     T NfacesScaling = 1280.0/cellConstants.triangle_list.size();
     return kArea * NfacesScaling * param::kBT_lbm/(eqLength);
   };
 
   T calculate_etaM(Config & cfg ){
-    return cfg["MaterialModel"]["eta_m"].read<T>() * param::dx / param::dt / param::df;
+    return cfg.get<T>("MaterialModel/eta_m") * param::dx / param::dt / param::df;
   };
 };
 }
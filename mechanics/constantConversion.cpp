@@ -34,11 +34,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace hemo {
 void Parameters::lbm_base_parameters(Config & cfg) {
-    dt = cfg["domain"]["dt"].read<T>();
-    dx = cfg["domain"]["dx"].read<T>();
-    nu_p = cfg["domain"]["nuP"].read<T>();
-    rho_p = cfg["domain"]["rhoP"].read<T>();
-    kBT_p = cfg["domain"]["kBT"].read<T>();
+    dt = cfg.get<T>("domain/dt");
+    dx = cfg.get<T>("domain/dx");
+    nu_p = cfg.get<T>("domain/nuP");
+    rho_p = cfg.get<T>("domain/rhoP");
+    kBT_p = cfg.get<T>("domain/kBT");
 
     if (dt < 0.0 ) { //dt is not set, calculate it from nu_p and dx, tau is set to 1
       tau = 1.0;
@@ -60,7 +60,7 @@ void Parameters::lbm_base_parameters(Config & cfg) {
 
 void Parameters::lbm_pipe_parameters(Config & cfg, plb::MultiScalarField3D<int> * sf) {
     Parameters::lbm_base_parameters(cfg);
-    re = cfg["domain"]["Re"].read<T>();
+    re = cfg.get<T>("domain/Re");
     
     plb::Box3D domain = sf->getBoundingBox();
     domain.x1 = domain.x0;
@@ -74,7 +74,7 @@ void Parameters::lbm_pipe_parameters(Config & cfg, plb::MultiScalarField3D<int>
 
 void Parameters::lbm_pipe_parameters(Config & cfg, int nY) {
     Parameters::lbm_base_parameters(cfg);
-    re = cfg["domain"]["Re"].read<T>();
+    re = cfg.get<T>("domain/Re");
     
     pipe_radius = nY;
     hlog << "(Parameters) The channel has a predefined radius of " << pipe_radius << " LU." << std::endl;
@@ -83,7 +83,7 @@ void Parameters::lbm_pipe_parameters(Config & cfg, int nY) {
 
 void Parameters::lbm_shear_parameters(Config & cfg,T nx) {
   Parameters::lbm_base_parameters(cfg);
-  T shearrate_p = cfg["domain"]["shearrate"].read<T>();
+  T shearrate_p = cfg.get<T>("domain/shearrate");
   re = (nx* (shearrate_p * (nx*0.5))) / nu_p;
   shearrate_lbm = shearrate_p*dt;
   u_lbm_max = shearrate_lbm;  
@@ -91,7 +91,7 @@ void Parameters::lbm_shear_parameters(Config & cfg,T nx) {
 
 void Parameters::lbm_LE_parameters(Config & cfg, T nz) {
   Parameters::lbm_base_parameters(cfg);
-  T shearrate_p = cfg["domain"]["shearrate"].read<T>();
+  T shearrate_p = cfg.get<T>("domain/shearrate");
   re = (nz * (shearrate_p * (nz * 0.5))) / nu_p;
   // plb::pcout << shearrate_p << std::endl;
   shearrate_lbm = shearrate_p * dt;
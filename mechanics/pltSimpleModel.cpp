@@ -23,8 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "pltSimpleModel.h"
 #include "logfile.h"
-#include "octree.h"
-#include "mollerTrumbore.h"
+#include "cellBVH.h"
 
 #include "palabos3D.h"
 #include "palabos3D.hh"
@@ -57,9 +56,9 @@ void PltSimpleModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> & par
 
     // Per-triangle calculations
     for (const hemo::Array<plint,3> & triangle : cellConstants.triangle_list) {
-      const hemo::Array<T,3> & v0 = cell[triangle[0]]->sv.position;
-      const hemo::Array<T,3> & v1 = cell[triangle[1]]->sv.position;
-      const hemo::Array<T,3> & v2 = cell[triangle[2]]->sv.position;
+      const hemo::Array<T,3> v0 = cell[triangle[0]]->sv.getPosition();
+      const hemo::Array<T,3> v1 = cell[triangle[1]]->sv.getPosition();
+      const hemo::Array<T,3> v2 = cell[triangle[2]]->sv.getPosition();
       
       //Volume
       const T v210 = v2[0]*v1[1]*v0[2];
@@ -122,8 +121,8 @@ void PltSimpleModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> & par
     // Per-edge calculations
     int edge_n=0;
     for (const hemo::Array<plint,2> & edge : cellConstants.edge_list) {
-      const hemo::Array<T,3> & v0 = cell[edge[0]]->sv.position;
-      const hemo::Array<T,3> & v1 = cell[edge[1]]->sv.position;
+      const hemo::Array<T,3> v0 = cell[edge[0]]->sv.getPosition();
+      const hemo::Array<T,3> v1 = cell[edge[1]]->sv.getPosition();
 
       // Link force
       const hemo::Array<T,3> edge_v = v1-v0;
@@ -139,7 +138,7 @@ void PltSimpleModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> & par
 
       // Membrane viscosity of bilipid layer
       // F = eta * (dv/l) * l. 
-      const hemo::Array<T,3> rel_vel = cell[edge[1]]->sv.v - cell[edge[0]]->sv.v;
+      const hemo::Array<T,3> rel_vel = cell[edge[1]]->sv.getVelocity() - cell[edge[0]]->sv.getVelocity();
       const hemo::Array<T,3> rel_vel_projection = dot(rel_vel, edge_uv) * edge_uv;
       hemo::Array<T,3> Fvisc_memb = eta_m * rel_vel_projection;
 
@@ -156,13 +155,13 @@ void PltSimpleModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> & par
       const plint b0 = cellConstants.edge_bending_triangles_list[edge_n][0];
       const plint b1 = cellConstants.edge_bending_triangles_list[edge_n][1];
 
-      const hemo::Array<T,3> b00 = particles_per_cell[cid][cellField.triangle_list[b0][0]]->sv.position;
-      const hemo::Array<T,3> b01 = particles_per_cell[cid][cellField.triangle_list[b0][1]]->sv.position;
-      const hemo::Array<T,3> b02 = particles_per_cell[cid][cellField.triangle_list[b0][2]]->sv.position;
+      const hemo::Array<T,3> b00 = particles_per_cell[cid][cellField.triangle_list[b0][0]]->sv.getPosition();
+      const hemo::Array<T,3> b01 = particles_per_cell[cid][cellField.triangle_list[b0][1]]->sv.getPosition();
+      const hemo::Array<T,3> b02 = particles_per_cell[cid][cellField.triangle_list[b0][2]]->sv.getPosition();
       
-      const hemo::Array<T,3> b10 = particles_per_cell[cid][cellField.triangle_list[b1][0]]->sv.position;
-      const hemo::Array<T,3> b11 = particles_per_cell[cid][cellField.triangle_list[b1][1]]->sv.position;
-      const hemo::Array<T,3> b12 = particles_per_cell[cid][cellField.triangle_list[b1][2]]->sv.position;
+      const hemo::Array<T,3> b10 = particles_per_cell[cid][cellField.triangle_list[b1][0]]->sv.getPosition();
+      const hemo::Array<T,3> b11 = particles_per_cell[cid][cellField.triangle_list[b1][1]]->sv.getPosition();
+      const hemo::Array<T,3> b12 = particles_per_cell[cid][cellField.triangle_list[b1][2]]->sv.getPosition();
 
       const hemo::Array<T,3> V1 = computeTriangleNormal(b00,b01,b02, false);
       const hemo::Array<T,3> V2 = computeTriangleNormal(b10,b11,b12, false);
@@ -187,8 +186,8 @@ void PltSimpleModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> & par
     // Per-inner-edge caluclations
     int inner_edge_n=0;
     for (const hemo::Array<plint,2> & edge : cellConstants.inner_edge_list) {
-      const hemo::Array<T,3> & v0 = cell[edge[0]]->sv.position;
-      const hemo::Array<T,3> & v1 = cell[edge[1]]->sv.position;
+      const hemo::Array<T,3> v0 = cell[edge[0]]->sv.getPosition();
+      const hemo::Array<T,3> v1 = cell[edge[1]]->sv.getPosition();
 
       // Link force
       const hemo::Array<T,3> edge_v = v1-v0;
@@ -209,6 +208,12 @@ void PltSimpleModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> & par
 
 #ifdef SOLIDIFY_MECHANICS
 void PltSimpleModel::solidifyMechanics(const std::map<int,std::vector<int>>& ppc,std::vector<HemoCellParticle>& particles,plb::BlockLattice3D<T,DESCRIPTOR> * fluid,plb::BlockLattice3D<T,CEPAC_DESCRIPTOR> * CEPAC, pluint ctype, HemoCellParticleField & pf) {
+  const plb::Dot3D location = fluid->getLocation();
+  const hemo::Array<plint,6> block = {location.x, location.x + fluid->getNx()-1,
+                                      location.y, location.y + fluid->getNy()-1,
+                                      location.z, location.z + fluid->getNz()-1};
+  CellBVH bvh;
+
   //For all cells
   for (auto & pair : ppc) {
     bool broken = false;
@@ -233,16 +238,15 @@ void PltSimpleModel::solidifyMechanics(const std::map<int,std::vector<int>>& ppc
 
     // If it was tagged last round, solidify it now
     if (solidify) {
-      hemo::OctreeStructCell octCell(3, 1, 30, cellConstants.triangle_list, particles, cell);
- 
-      set<Array<plint,3>> innerNodes;
-      octCell.findInnerNodes(fluid,particles,cell,innerNodes);
-      for (const Array<plint,3> & node : innerNodes) {
-          if (!fluid->get(node[0],node[1],node[2]).getDynamics().isBoundary()) {
-          defineDynamics(*fluid,node[0],node[1],node[2],new BounceBack<T,DESCRIPTOR>(1.));
-          bindingFieldHelper::get(*pf.cellFields).add(pf, {node[0],node[1],node[2]});
+      bvh.build(cellConstants.triangle_list, particles, cell);
+      bvh.forEachInnerNode(block, [&](plint x, plint y, plint z) {
+        const plint x_l = x-location.x, y_l = y-location.y, z_l = z-location.z;
+        if (!pf.boundaryMask.isBoundary(x_l,y_l,z_l)) {
+          defineDynamics(*fluid,x_l,y_l,z_l,new BounceBack<T,DESCRIPTOR>(1.));
+          pf.boundaryMask.setBoundary(x_l,y_l,z_l);
+          bindingFieldHelper::get(*pf.cellFields).add(pf, {x_l,y_l,z_l});
         }
-      }
+      });
      
       for (const int & particle : cell) {
         particles[particle].tag = 1; //tag for removal
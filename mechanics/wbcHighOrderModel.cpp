@@ -58,9 +58,9 @@ void WbcHighOrderModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> &
 
     // Per-triangle calculations
     for (const hemo::Array<plint,3> & triangle : cellConstants.triangle_list) {
-      const hemo::Array<T,3> & v0 = cell[triangle[0]]->sv.position;
-      const hemo::Array<T,3> & v1 = cell[triangle[1]]->sv.position;
-      const hemo::Array<T,3> & v2 = cell[triangle[2]]->sv.position;
+      const hemo::Array<T,3> v0 = cell[triangle[0]]->sv.getPosition();
+      const hemo::Array<T,3> v1 = cell[triangle[1]]->sv.getPosition();
+      const hemo::Array<T,3> v2 = cell[triangle[2]]->sv.getPosition();
       
       //Volume
       const T v210 = v2[0]*v1[1]*v0[2];
@@ -124,23 +124,23 @@ void WbcHighOrderModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> &
       hemo::Array<T,3> vertexes_sum = {0.,0.,0.};
 
       for(unsigned int j = 0; j < cellConstants.vertex_n_vertexes[i]; j++) {
-        vertexes_sum += cell[cellConstants.vertex_vertexes[i][j]]->sv.position;
+        vertexes_sum += cell[cellConstants.vertex_vertexes[i][j]]->sv.getPosition();
       }
       const hemo::Array<T,3> vertexes_middle = vertexes_sum/cellConstants.vertex_n_vertexes[i];
 
-      const hemo::Array<T,3> dev_vect = vertexes_middle - cell[i]->sv.position;
+      const hemo::Array<T,3> dev_vect = vertexes_middle - cell[i]->sv.getPosition();
       
       
       // Get the local surface normal
       hemo::Array<T,3> patch_normal = {0.,0.,0.};
       for(unsigned int j = 0; j < cellConstants.vertex_n_vertexes[i]-1; j++) {
-        hemo::Array<T,3> triangle_normal = crossProduct(cell[cellConstants.vertex_vertexes[i][j]]->sv.position - cell[i]->sv.position, 
-                                                             cell[cellConstants.vertex_vertexes[i][j+1]]->sv.position - cell[i]->sv.position);
+        hemo::Array<T,3> triangle_normal = crossProduct(cell[cellConstants.vertex_vertexes[i][j]]->sv.getPosition() - cell[i]->sv.getPosition(), 
+                                                             cell[cellConstants.vertex_vertexes[i][j+1]]->sv.getPosition() - cell[i]->sv.getPosition());
         triangle_normal /= norm(triangle_normal);  
         patch_normal += triangle_normal;                                                   
       }
-      hemo::Array<T,3> triangle_normal = crossProduct(cell[cellConstants.vertex_vertexes[i][cellConstants.vertex_n_vertexes[i]-1]]->sv.position - cell[i]->sv.position, 
-                                                           cell[cellConstants.vertex_vertexes[i][0]]->sv.position - cell[i]->sv.position);
+      hemo::Array<T,3> triangle_normal = crossProduct(cell[cellConstants.vertex_vertexes[i][cellConstants.vertex_n_vertexes[i]-1]]->sv.getPosition() - cell[i]->sv.getPosition(), 
+                                                           cell[cellConstants.vertex_vertexes[i][0]]->sv.getPosition() - cell[i]->sv.getPosition());
       triangle_normal /= norm(triangle_normal);
       patch_normal += triangle_normal;
  
@@ -165,8 +165,8 @@ void WbcHighOrderModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> &
     // Per-edge calculations
     int edge_n=0;
     for (const hemo::Array<plint,2> & edge : cellConstants.edge_list) {
-      const hemo::Array<T,3> & p0 = cell[edge[0]]->sv.position;
-      const hemo::Array<T,3> & p1 = cell[edge[1]]->sv.position;
+      const hemo::Array<T,3> p0 = cell[edge[0]]->sv.getPosition();
+      const hemo::Array<T,3> p1 = cell[edge[1]]->sv.getPosition();
 
       // Link force
       const hemo::Array<T,3> edge_vec = p1-p0;
@@ -182,7 +182,7 @@ void WbcHighOrderModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> &
 
       // Membrane viscosity of bilipid layer
       // F = eta * (dv/l) * l. 
-      const hemo::Array<T,3> rel_vel = cell[edge[1]]->sv.v - cell[edge[0]]->sv.v;
+      const hemo::Array<T,3> rel_vel = cell[edge[1]]->sv.getVelocity() - cell[edge[0]]->sv.getVelocity();
       const hemo::Array<T,3> rel_vel_projection = dot(rel_vel, edge_uv) * edge_uv;
       hemo::Array<T,3> Fvisc_memb = eta_m * rel_vel_projection;
 
@@ -200,8 +200,8 @@ void WbcHighOrderModel::ParticleMechanics(map<int,vector<HemoCellParticle *>> &
     
     // Enforce rigid inner core size
     for (const hemo::Array<plint,2> & edge : cellConstants.inner_edge_list) {
-      const hemo::Array<T,3> & p0 = cell[edge[0]]->sv.position;
-      const hemo::Array<T,3> & p1 = cell[edge[1]]->sv.position;
+      const hemo::Array<T,3> p0 = cell[edge[0]]->sv.getPosition();
+      const hemo::Array<T,3> p1 = cell[edge[1]]->sv.getPosition();
 
       // Inner link forces
       const hemo::Array<T,3> edge_vec = p1-p0;
@@ -241,23 +241,23 @@ void WbcHighOrderModel::statistics() {
 // Provide methods to calculate and scale to coefficients from here
 
 T WbcHighOrderModel::calculate_kInnerRigid(Config & cfg){
-  T kInnerRigid = cfg["MaterialModel"]["kInnerRigid"].read<T>();
+  T kInnerRigid = cfg.get<T>("MaterialModel/kInnerRigid");
   //TODO: convert to proper dimension
   return kInnerRigid/param::df;
 };
 
 T WbcHighOrderModel::calculate_kCytoskeleton(Config & cfg){
-  T kCytoskeleton = cfg["MaterialModel"]["kCytoskeleton"].read<T>();
+  T kCytoskeleton = cfg.get<T>("MaterialModel/kCytoskeleton");
   return kCytoskeleton/param::df;
 };
 
 T WbcHighOrderModel::calculate_coreRadius(Config & cfg){
-  T coreRadius = cfg["MaterialModel"]["coreRadius"].read<T>();
+  T coreRadius = cfg.get<T>("MaterialModel/coreRadius");
   return coreRadius/param::dx;
 };
 
 T WbcHighOrderModel::calculate_radius(Config & cfg){
-  T radius = cfg["MaterialModel"]["radius"].read<T>();
+  T radius = cfg.get<T>("MaterialModel/radius");
   return radius/param::dx;
 };
 }
@@ -0,0 +1,152 @@
+#ifndef HEMO_BENCHMARK_H
+#define HEMO_BENCHMARK_H
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "parallelism/mpiManager.h"
+
+// A minimal benchmark runner for the kernels of HemoCell, in the style of
+// Google Benchmark. A benchmark is a function that repeats the timed kernel in
+// `while (state.keepRunning())`, the runner repeats it until it ran for at
+// least `--benchmark_min_time` seconds and reports the mean time per
+// iteration. With several processes the main process decides when to stop,
+// so all of them run the same number of iterations.
+//
+// The results are written with `--benchmark_out=<file>` in the JSON format of
+// Google Benchmark, so its tools (e.g. compare.py) can be used to track
+// regressions between versions. `--benchmark_filter=<regex>` selects the
+// benchmarks to run, any other `--<key>=<value>` is available through
+// `Runner::option`.
+namespace hemo {
+namespace benchmark {
+
+class State {
+public:
+  explicit State(double minTime_) : minTime(minTime_) {}
+
+  bool keepRunning() {
+    if (iterations == 0 && !running) {
+      running = true;
+      startReal = std::chrono::steady_clock::now();
+      startCpu = std::clock();
+      return true;
+    }
+    iterations++;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startReal).count();
+    int keep = elapsed < minTime;
+    if (plb::global::mpi().getSize() > 1) {
+      plb::global::mpi().bCast(&keep, 1);
+    }
+    if (keep) {
+      return true;
+    }
+    realTime = elapsed;
+    cpuTime = double(std::clock() - startCpu)/CLOCKS_PER_SEC;
+    running = false;
+    return false;
+  }
+
+  /// Extra values reported with the benchmark, e.g. the number of particles
+  std::map<std::string,double> counters;
+
+  unsigned long iterations = 0;
+  double realTime = 0., cpuTime = 0.;
+
+private:
+  const double minTime;
+  bool running = false;
+  std::chrono::steady_clock::time_point startReal;
+  std::clock_t startCpu = 0;
+};
+
+class Runner {
+public:
+  Runner(int argc, char * argv[]) : executable(argv[0]) {
+    for (int i = 1 ; i < argc ; i++) {
+      std::string arg(argv[i]);
+      size_t eq = arg.find('=');
+      if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) { continue; }
+      options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+  }
+
+  template<typename V>
+  V option(const std::string & key, V defaultValue) const {
+    std::map<std::string,std::string>::const_iterator found = options.find(key);
+    if (found == options.end()) { return defaultValue; }
+    std::istringstream value(found->second);
+    value >> defaultValue;
+    return defaultValue;
+  }
+
+  void context(const std::string & key, const std::string & value) { contextValues[key] = value; }
+
+  void run(const std::string & name, std::function<void(State &)> benchmark) {
+    if (!std::regex_search(name, std::regex(option<std::string>("benchmark_filter", ".")))) { return; }
+    State state(option<double>("benchmark_min_time", 0.5));
+    benchmark(state);
+    if (state.iterations == 0) { return; }
+    results.push_back({name, state});
+    if (verbose) {
+      std::cout << std::left << std::setw(48) << name << std::right
+                << std::setw(14) << std::fixed << std::setprecision(1) << 1e6*state.realTime/state.iterations << " us"
+                << std::setw(14) << 1e6*state.cpuTime/state.iterations << " us"
+                << std::setw(10) << state.iterations << std::endl;
+    }
+  }
+
+  /// Write the results as Google Benchmark JSON, if --benchmark_out is given
+  void write() const {
+    std::string fileName = option<std::string>("benchmark_out", "");
+    if (fileName.empty() || !verbose) { return; }
+    std::ofstream out(fileName);
+    if (!out.is_open()) {
+      std::cerr << "(Benchmark) (Error) Opening " << fileName << std::endl;
+      return;
+    }
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    out << std::setprecision(10);
+    out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n    \"executable\": \"" << executable << "\"";
+    for (const std::pair<const std::string,std::string> & value : contextValues) {
+      out << ",\n    \"" << value.first << "\": \"" << value.second << "\"";
+    }
+    out << "\n  },\n  \"benchmarks\": [";
+    for (size_t i = 0 ; i < results.size() ; i++) {
+      const State & state = results[i].second;
+      out << (i ? ",\n" : "\n") << "    {\"name\": \"" << results[i].first << "\", \"run_name\": \"" << results[i].first
+          << "\", \"run_type\": \"iteration\", \"iterations\": " << state.iterations
+          << ", \"real_time\": " << 1e6*state.realTime/state.iterations
+          << ", \"cpu_time\": " << 1e6*state.cpuTime/state.iterations << ", \"time_unit\": \"us\"";
+      for (const std::pair<const std::string,double> & counter : state.counters) {
+        out << ", \"" << counter.first << "\": " << counter.second;
+      }
+      out << "}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+  /// Only the main process prints and writes results
+  bool verbose = true;
+
+private:
+  std::string executable;
+  std::map<std::string,std::string> options;
+  std::map<std::string,std::string> contextValues;
+  std::vector<std::pair<std::string,State>> results;
+};
+
+}
+}
+#endif
@@ -0,0 +1,227 @@
+#include "benchmark.h"
+
+#include <hemocell.h>
+#include "rbcHighOrderModel.h"
+#include "pltSimpleModel.h"
+#include "wbcHighOrderModel.h"
+#include "immersedBoundaryMethod.h"
+#include "FluidHdf5IO.h"
+#include "ParticleHdf5IO.h"
+#include "palabos3D.h"
+#include "palabos3D.hh"
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+// Micro-benchmarks of the hot kernels of HemoCell on a single process. Every
+// benchmark runs on a synthetic, fully periodic cube of `--size` lattice nodes
+// per direction that is filled with one cell type at `--hematocrit`.
+//
+//   hemocell_benchmark --size=50 --hematocrit=0.3 --benchmark_out=result.json
+//
+// The cells are placed on a regular grid with a random (but reproducible)
+// orientation, they may overlap at high hematocrit which does not change the
+// amount of work per kernel. Since two HemoCell instances cannot exist at the
+// same time, the benchmarks are grouped per cell type.
+
+using namespace hemo;
+
+namespace {
+
+const char * config_file = "config_benchmark.xml";
+
+// Write <name>.pos with the cells filling the cube up to the hematocrit
+int writePositions(const std::string & name, T cellVolume, T hematocrit, int n) {
+  const T length = n * param::dx * 1e6; // [µm]
+  const int cells = std::max(1, (int)std::round(hematocrit * length*length*length / cellVolume));
+  const int perAxis = std::ceil(std::cbrt((T)cells));
+  const T spacing = length / perAxis;
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<T> angle(0., 360.);
+  std::ofstream pos(name + ".pos");
+  pos << cells << "\n";
+  for (int i = 0 ; i < cells ; i++) {
+    const int x = i / (perAxis*perAxis), y = (i / perAxis) % perAxis, z = i % perAxis;
+    pos << (x + 0.5)*spacing << " " << (y + 0.5)*spacing << " " << (z + 0.5)*spacing << " "
+        << angle(generator) << " " << angle(generator) << " " << angle(generator) << "\n";
+  }
+  return cells;
+}
+
+// A periodic cube with a single cell type
+template<class Model>
+class SyntheticField {
+public:
+  SyntheticField(const std::string & name_, int construction, T cellVolume, T hematocrit, int n, char * argv[])
+    : name(name_), hemocell((char *)config_file, 0, argv, HemoCell::MPIHandle::External) {
+    Config * cfg = hemocell.cfg;
+    param::lbm_base_parameters(*cfg);
+
+    hemocell.lattice = new plb::MultiBlockLattice3D<T, DESCRIPTOR>(
+        plb::defaultMultiBlockPolicy3D().getMultiBlockManagement(n, n, n, (*cfg)["domain"]["fluidEnvelope"].read<int>()),
+        plb::defaultMultiBlockPolicy3D().getBlockCommunicator(),
+        plb::defaultMultiBlockPolicy3D().getCombinedStatistics(),
+        plb::defaultMultiBlockPolicy3D().getMultiCellAccess<T, DESCRIPTOR>(),
+        new plb::GuoExternalForceBGKdynamics<T, DESCRIPTOR>(1.0/param::tau));
+    hemocell.lattice->toggleInternalStatistics(false);
+    hemocell.lattice->periodicity().toggleAll(true);
+    hemocell.latticeEquilibrium(1., plb::Array<T, 3>(0., 0., 0.));
+    hemocell.lattice->initialize();
+
+    hemocell.initializeCellfield();
+    hemocell.addCellType<Model>(name, construction);
+    hemocell.setOutputs(name, {OUTPUT_POSITION, OUTPUT_TRIANGLES, OUTPUT_FORCE});
+    hemocell.setFluidOutputs({OUTPUT_VELOCITY, OUTPUT_DENSITY});
+    for (int d = 0 ; d < 3 ; d++) {
+      hemocell.setSystemPeriodicity(d, true);
+    }
+    hemocell.setRepulsion((*cfg)["domain"]["kRep"].read<T>(), (*cfg)["domain"]["RepCutoff"].read<T>());
+
+    if (plb::global::mpi().isMainProcessor()) {
+      writePositions(name, cellVolume, hematocrit, n);
+    }
+    plb::global::mpi().barrier();
+    hemocell.loadParticles();
+    hemocell.cellfields->interpolateFluidVelocity();
+  }
+
+  /// Number of particles on this process
+  size_t particles() {
+    size_t count = 0;
+    for (plint bId : localBlocks()) {
+      count += hemocell.cellfields->immersedParticles->getComponent(bId).particles.size();
+    }
+    return count;
+  }
+
+  const std::vector<plint> & localBlocks() {
+    return hemocell.cellfields->immersedParticles->getMultiBlockManagement().getLocalInfo().getBlocks();
+  }
+
+  const std::string name;
+  HemoCell hemocell;
+};
+
+void mechanicsBenchmark(benchmark::Runner & runner, HemoCellFields & cellfields, size_t particles, const std::string & name) {
+  runner.run("ParticleMechanics/" + name, [&](benchmark::State & state) {
+    state.counters["particles"] = particles;
+    while (state.keepRunning()) {
+      cellfields.applyConstitutiveModel(true);
+    }
+  });
+}
+
+}
+
+int main(int argc, char * argv[]) {
+  plb::plbInit(&argc, &argv);
+  benchmark::Runner runner(argc, argv);
+  runner.verbose = plb::global::mpi().isMainProcessor();
+
+  const T hematocrit = runner.option<T>("hematocrit", 0.3);
+  const int n = runner.option<int>("size", 50);
+  runner.context("hematocrit", std::to_string(hematocrit));
+  runner.context("size", std::to_string(n));
+  runner.context("processes", std::to_string(plb::global::mpi().getSize()));
+
+  {
+    SyntheticField<RbcHighOrderModel> field("RBC_HO", RBC_FROM_SPHERE, 90., hematocrit, n, argv);
+    HemoCellFields & cellfields = *field.hemocell.cellfields;
+    const size_t particles = field.particles();
+
+    runner.run("interpolationCoefficientsPhi2", [&](benchmark::State & state) {
+      state.counters["particles"] = particles;
+      while (state.keepRunning()) {
+        for (plint bId : field.localBlocks()) {
+          HemoCellParticleField & pf = cellfields.immersedParticles->getComponent(bId);
+          plb::BlockLattice3D<T, DESCRIPTOR> & block = cellfields.lattice->getComponent(bId);
+          for (HemoCellParticle & particle : pf.particles) {
+            interpolationCoefficientsPhi2(block, particle, pf.boundaryMask);
+          }
+        }
+      }
+    });
+    runner.run("interpolationCoefficientsPhi3", [&](benchmark::State & state) {
+      state.counters["particles"] = particles;
+      while (state.keepRunning()) {
+        for (plint bId : field.localBlocks()) {
+          HemoCellParticleField & pf = cellfields.immersedParticles->getComponent(bId);
+          plb::BlockLattice3D<T, DESCRIPTOR> & block = cellfields.lattice->getComponent(bId);
+          for (HemoCellParticle & particle : pf.particles) {
+            interpolationCoefficientsPhi3(block, particle, pf.boundaryMask);
+          }
+        }
+      }
+    });
+    runner.run("interpolationCoefficientsPhi4", [&](benchmark::State & state) {
+      state.counters["particles"] = particles;
+      while (state.keepRunning()) {
+        for (plint bId : field.localBlocks()) {
+          HemoCellParticleField & pf = cellfields.immersedParticles->getComponent(bId);
+          plb::BlockLattice3D<T, DESCRIPTOR> & block = cellfields.lattice->getComponent(bId);
+          for (HemoCellParticle & particle : pf.particles) {
+            interpolationCoefficientsPhi4(block, particle, pf.boundaryMask);
+          }
+        }
+      }
+    });
+    // Restore the default kernels of the later benchmarks
+    for (plint bId : field.localBlocks()) {
+      HemoCellParticleField & pf = cellfields.immersedParticles->getComponent(bId);
+      plb::BlockLattice3D<T, DESCRIPTOR> & block = cellfields.lattice->getComponent(bId);
+      for (HemoCellParticle & particle : pf.particles) {
+        interpolationCoefficientsPhi2(block, particle, pf.boundaryMask);
+      }
+    }
+    runner.run("interpolateFluidVelocity", [&](benchmark::State & state) {
+      state.counters["particles"] = particles;
+      while (state.keepRunning()) {
+        cellfields.interpolateFluidVelocity();
+      }
+    });
+    runner.run("spreadParticleForce", [&](benchmark::State & state) {
+      state.counters["particles"] = particles;
+      while (state.keepRunning()) {
+        cellfields.spreadParticleForce();
+      }
+    });
+    runner.run("applyRepulsionForce", [&](benchmark::State & state) {
+      state.counters["particles"] = particles;
+      while (state.keepRunning()) {
+        cellfields.applyRepulsionForce();
+      }
+    });
+    runner.run("syncEnvelopes", [&](benchmark::State & state) {
+      state.counters["particles"] = particles;
+      while (state.keepRunning()) {
+        cellfields.syncEnvelopes();
+      }
+    });
+    mechanicsBenchmark(runner, cellfields, particles, field.name);
+    runner.run("writeCellField3D_HDF5", [&](benchmark::State & state) {
+      state.counters["particles"] = particles;
+      while (state.keepRunning()) {
+        writeCellField3D_HDF5(cellfields, param::dx, param::dt, 0);
+      }
+    });
+    runner.run("writeFluidField_HDF5", [&](benchmark::State & state) {
+      state.counters["nodes"] = (double)n*n*n;
+      while (state.keepRunning()) {
+        writeFluidField_HDF5(cellfields, param::dx, param::dt, 0);
+      }
+    });
+  }
+  {
+    SyntheticField<PltSimpleModel> field("PLT", ELLIPSOID_FROM_SPHERE, 11., hematocrit*0.1, n, argv);
+    mechanicsBenchmark(runner, *field.hemocell.cellfields, field.particles(), field.name);
+  }
+  {
+    SyntheticField<WbcHighOrderModel> field("WBC_HO", WBC_SPHERE, 268., hematocrit*0.1, n, argv);
+    mechanicsBenchmark(runner, *field.hemocell.cellfields, field.particles(), field.name);
+  }
+
+  runner.write();
+  return 0;
+}
@@ -0,0 +1,285 @@
+#include "gtest/gtest.h"
+#include <hemocell.h>
+#include <helper/voxelizeDomain.h>
+#include "rbcHighOrderModel.h"
+#include "pltSimpleModel.h"
+#include "cellInfo.h"
+#include "fluidInfo.h"
+#include "particleInfo.h"
+#include "hemoCellStretch.h"
+#include "palabos3D.h"
+#include "palabos3D.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <string>
+
+// Compares the stretch_cell and pipeflow cases run with the mixed precision
+// library against the same runs with the default library, vertex by vertex.
+// The default library writes the reference, the mixed precision library
+// compares against it, both with the same number of processes. Both are run by
+// the `test_mixed_precision` target.
+
+namespace {
+
+const auto reference_prefix = "tmp/mixed_precision_reference_";
+
+// Allowed deviation from the reference. The positions are rounded to ~1e-7
+// relative to the origin of their block every iteration (a few 1e-6 lattice
+// units), the velocities to ~1e-7 relative. The tolerances leave room for the
+// growth of these errors over the runs.
+const T position_tolerance = 1e-2; // Lattice units
+const T velocity_tolerance = 1e-2; // Relative to the largest reference velocity
+const T force_tolerance = 1e-2;    // Relative to the largest reference force
+const T summary_tolerance = 1e-3;  // Relative, the number of cells has to match
+
+struct Vertex {
+  hemo::Array<T, 3> position, velocity, force;
+};
+typedef std::map<std::pair<plint, int>, Vertex> Vertices;
+
+// The vertices within the local domain of the blocks on this process
+Vertices localVertices(hemo::HemoCell &hemocell) {
+  Vertices vertices;
+  for (plint bId : hemocell.cellfields->immersedParticles->getLocalInfo().getBlocks()) {
+    hemo::HemoCellParticleField &pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    for (const hemo::HemoCellParticle &particle : pf.particles) {
+      const hemo::Array<T, 3> position = particle.sv.getPosition();
+      if (!pf.isContainedABS(position, pf.localDomain)) { continue; }
+      vertices[{particle.sv.cellId, particle.sv.vertexId}] = {position, particle.sv.getVelocity(), particle.sv.force};
+    }
+  }
+  return vertices;
+}
+
+std::string referenceFile(const std::string &name, int rank) {
+  return reference_prefix + name + "_" + std::to_string(rank) + ".txt";
+}
+
+// The default library writes a file per process with the summary values (the
+// first is the number of cells) and its vertices. The mixed precision library
+// reads the files of all processes, a vertex can end up on a neighbouring
+// process.
+void writeOrCompare(hemo::HemoCell &hemocell, const std::string &name, const std::vector<T> &summary) {
+  const int processes = plb::global::mpi().getSize();
+  const Vertices vertices = localVertices(hemocell);
+
+#ifdef HEMOCELL_MIXED_PRECISION
+  Vertices reference;
+  std::vector<T> referenceSummary(summary.size());
+  for (int rank = 0; rank < processes; rank++) {
+    std::ifstream file(referenceFile(name, rank));
+    ASSERT_TRUE(file.good()) << "Missing " << referenceFile(name, rank) << ", run the default library first";
+    int referenceProcesses;
+    file >> referenceProcesses;
+    ASSERT_EQ(referenceProcesses, processes) << "The reference was written with a different number of processes";
+    std::vector<T> values(summary.size());
+    for (T &value : values) { file >> value; }
+    if (rank == plb::global::mpi().getRank()) { referenceSummary = values; }
+    std::pair<plint, int> key;
+    Vertex vertex;
+    while (file >> key.first >> key.second) {
+      for (int d = 0; d < 3; d++) { file >> vertex.position[d]; }
+      for (int d = 0; d < 3; d++) { file >> vertex.velocity[d]; }
+      for (int d = 0; d < 3; d++) { file >> vertex.force[d]; }
+      reference[key] = vertex;
+    }
+  }
+
+  EXPECT_EQ(summary[0], referenceSummary[0]);
+  for (unsigned int i = 1; i < summary.size(); i++) {
+    EXPECT_NEAR(summary[i], referenceSummary[i], summary_tolerance * std::fabs(referenceSummary[i])) << "summary value " << i;
+  }
+
+  T maxVelocity = 0, maxForce = 0;
+  for (const auto &vertex : reference) {
+    maxVelocity = std::max(maxVelocity, hemo::norm(vertex.second.velocity));
+    maxForce = std::max(maxForce, hemo::norm(vertex.second.force));
+  }
+  T positionError = 0, velocityError = 0, forceError = 0;
+  long compared = 0;
+  for (const auto &vertex : vertices) {
+    const auto match = reference.find(vertex.first);
+    EXPECT_TRUE(match != reference.end()) << "vertex " << vertex.first.second << " of cell " << vertex.first.first << " is not in the reference";
+    if (match == reference.end()) { continue; }
+    positionError = std::max(positionError, hemo::norm(vertex.second.position - match->second.position));
+    velocityError = std::max(velocityError, hemo::norm(vertex.second.velocity - match->second.velocity));
+    forceError = std::max(forceError, hemo::norm(vertex.second.force - match->second.force));
+    compared++;
+  }
+  EXPECT_LE(positionError, position_tolerance);
+  EXPECT_LE(velocityError, velocity_tolerance * maxVelocity);
+  EXPECT_LE(forceError, force_tolerance * maxForce);
+
+  long total = 0;
+  MPI_Allreduce(&compared, &total, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+  EXPECT_EQ(total, (long)reference.size()) << "Not every reference vertex was compared";
+#else
+  std::ofstream file(referenceFile(name, plb::global::mpi().getRank()));
+  ASSERT_TRUE(file.good()) << "Cannot write " << referenceFile(name, plb::global::mpi().getRank());
+  file << std::setprecision(17) << processes;
+  for (const T value : summary) { file << " " << value; }
+  file << "\n";
+  for (const auto &vertex : vertices) {
+    file << vertex.first.first << " " << vertex.first.second;
+    for (int d = 0; d < 3; d++) { file << " " << vertex.second.position[d]; }
+    for (int d = 0; d < 3; d++) { file << " " << vertex.second.velocity[d]; }
+    for (int d = 0; d < 3; d++) { file << " " << vertex.second.force[d]; }
+    file << "\n";
+  }
+#endif
+}
+
+}
+
+TEST(MixedPrecision, StretchCell) {
+  const unsigned max_iteration = 2000;
+  const unsigned n_forced_lsps = 7;
+  const T stretch_force = 75; // pN
+  const T to_micro_meter = 1e-6;
+
+  char *args[] = {(char *)"test", (char *)"path", NULL};
+  char *inp = (char *)"validation/stretch_cell/config_stretch_cell.xml";
+
+  hemo::HemoCell hemocell(inp, 0, args, hemo::HemoCell::MPIHandle::External);
+  hemo::Config *cfg = hemocell.cfg;
+  hemo::param::lbm_base_parameters(*cfg);
+  hemo::param::ef_lbm = stretch_force * (1e-12 / hemo::param::df);
+
+  plint nz = 13 * (to_micro_meter / (*cfg)["domain"]["dx"].read<T>());
+  plint nx = 2 * nz;
+  plint ny = nz;
+  plint extendedEnvelopeWidth = 2;
+
+  hemocell.lattice = new plb::MultiBlockLattice3D<T, DESCRIPTOR>(
+      plb::defaultMultiBlockPolicy3D().getMultiBlockManagement(
+          nx, ny, nz, extendedEnvelopeWidth),
+      plb::defaultMultiBlockPolicy3D().getBlockCommunicator(),
+      plb::defaultMultiBlockPolicy3D().getCombinedStatistics(),
+      plb::defaultMultiBlockPolicy3D().getMultiCellAccess<T, DESCRIPTOR>(),
+      new plb::GuoExternalForceBGKdynamics<T, DESCRIPTOR>(1.0 /
+                                                          hemo::param::tau));
+
+  hemocell.lattice->toggleInternalStatistics(false);
+  hemocell.lattice->periodicity().toggleAll(false);
+
+  auto *boundaryCondition =
+      plb::createLocalBoundaryCondition3D<T, DESCRIPTOR>();
+  boundaryCondition->setVelocityConditionOnBlockBoundaries(*hemocell.lattice);
+  setBoundaryVelocity(*hemocell.lattice, hemocell.lattice->getBoundingBox(),
+                      plb::Array<T, 3>(0., 0., 0.));
+
+  hemocell.latticeEquilibrium(1., hemo::Array<T, 3>({0., 0., 0.}));
+  hemocell.lattice->initialize();
+
+  hemocell.initializeCellfield();
+  hemocell.addCellType<hemo::RbcHighOrderModel>("validation/stretch_cell/stretch_RBC", RBC_FROM_SPHERE);
+  hemocell.loadParticles();
+
+  auto cellfield = (*hemocell.cellfields)["validation/stretch_cell/stretch_RBC"];
+  hemo::HemoCellStretch cellStretch(*cellfield, n_forced_lsps, hemo::param::ef_lbm);
+
+  while (hemocell.iter < max_iteration) {
+    cellStretch.applyForce(); // cell force should be applied manually
+    hemocell.iterate();
+  }
+
+  // The diameters of the cell over the vertices on all processes
+  const pluint count = hemo::CellInformationFunctionals::getTotalNumberOfCells(&hemocell);
+  T low[3] = {INFINITY, INFINITY, INFINITY}, high[3] = {-INFINITY, -INFINITY, -INFINITY};
+  for (const auto &vertex : localVertices(hemocell)) {
+    for (int d = 0; d < 3; d++) {
+      low[d] = std::min(low[d], vertex.second.position[d]);
+      high[d] = std::max(high[d], vertex.second.position[d]);
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, low, 3, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, high, 3, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+  writeOrCompare(hemocell, "stretch_cell", {T(count), high[0] - low[0], high[1] - low[1]});
+
+  // The forced points of the cell stretch are static, see test_stretch_cell.cpp
+  cellStretch.lower_lsps.clear();
+  cellStretch.upper_lsps.clear();
+}
+
+TEST(MixedPrecision, Pipeflow) {
+  const unsigned warmup_iterations = 100;
+  const unsigned max_iteration = 300;
+  const auto geometry_file = "../examples/pipeflow/tube.stl";
+
+  char *args[] = {(char *)"test", (char *)"path", NULL};
+  char *inp = (char *)"validation/pipeflow/config_pipeflow.xml";
+
+  hemo::HemoCell hemocell(inp, 0, args, hemo::HemoCell::MPIHandle::External);
+  hemo::Config * cfg = hemocell.cfg;
+
+  std::auto_ptr<plb::MultiScalarField3D<int>> flagMatrix;
+  std::auto_ptr<hemo::VoxelizedDomain3D<T>> voxelizedDomain;
+
+  hemo::getFlagMatrixFromSTL(geometry_file,
+                       cfg->get<int>("domain/fluidEnvelope"),
+                       cfg->get<int>("domain/refDirN"),
+                       cfg->get<int>("domain/refDir"),
+                       voxelizedDomain, flagMatrix,
+                       cfg->get<int>("domain/blockSize"),
+                       cfg->get<int>("domain/particleEnvelope"));
+
+  hemo::param::lbm_pipe_parameters((*cfg), flagMatrix.get());
+
+  hemocell.lattice = new plb::MultiBlockLattice3D<T, DESCRIPTOR>(
+            voxelizedDomain.get()->getMultiBlockManagement(),
+            plb::defaultMultiBlockPolicy3D().getBlockCommunicator(),
+            plb::defaultMultiBlockPolicy3D().getCombinedStatistics(),
+            plb::defaultMultiBlockPolicy3D().getMultiCellAccess<T, DESCRIPTOR>(),
+            new plb::GuoExternalForceBGKdynamics<T, DESCRIPTOR>(1.0/hemo::param::tau));
+
+  defineDynamics(*hemocell.lattice, *flagMatrix.get(), (*hemocell.lattice).getBoundingBox(), new hemo::BounceBack<T, DESCRIPTOR>(1.), 0);
+
+  hemocell.lattice->toggleInternalStatistics(false);
+  hemocell.lattice->periodicity().toggleAll(false);
+  hemocell.latticeEquilibrium(1., {0., 0., 0.});
+
+  auto poiseuilleForce =  8 * hemo::param::nu_lbm * (hemo::param::u_lbm_max * 0.5) / hemo::param::pipe_radius / hemo::param::pipe_radius;
+  auto driving_force = plb::Array<T, 3> {poiseuilleForce, 0., 0.};
+
+  hemocell.lattice->initialize();
+  hemocell.initializeCellfield();
+
+  hemocell.addCellType<hemo::RbcHighOrderModel>("validation/pipeflow/RBC", RBC_FROM_SPHERE);
+  hemocell.setMaterialTimeScaleSeparation("validation/pipeflow/RBC", cfg->get<int>("ibm/stepMaterialEvery"));
+  hemocell.setInitialMinimumDistanceFromSolid("validation/pipeflow/RBC", 0.5);
+
+  hemocell.addCellType<hemo::PltSimpleModel>("validation/pipeflow/PLT", ELLIPSOID_FROM_SPHERE);
+  hemocell.setMaterialTimeScaleSeparation("validation/pipeflow/PLT", cfg->get<int>("ibm/stepMaterialEvery"));
+
+  hemocell.setParticleVelocityUpdateTimeScaleSeparation(cfg->get<int>("ibm/stepParticleEvery"));
+
+  hemocell.setSystemPeriodicity(0, true);
+  hemocell.loadParticles();
+
+  setExternalVector(*hemocell.lattice, (*hemocell.lattice).getBoundingBox(),
+                    DESCRIPTOR<T>::ExternalField::forceBeginsAt,
+                    driving_force);
+
+  for (unsigned i = 0; i < warmup_iterations; ++i)
+    hemocell.lattice->collideAndStream();
+
+  while (hemocell.iter < max_iteration) {
+    hemocell.iterate();
+    setExternalVector(*hemocell.lattice, hemocell.lattice->getBoundingBox(),
+                DESCRIPTOR<T>::ExternalField::forceBeginsAt,
+                driving_force);
+  }
+
+  // The statistics are gathered on every process
+  const pluint count = hemo::CellInformationFunctionals::getTotalNumberOfCells(&hemocell);
+  const T fluid_velocity = hemo::FluidInfo::calculateVelocityStatistics(&hemocell).avg;
+  const T particle_velocity = hemo::ParticleInfo::calculateVelocityStatistics(&hemocell).avg;
+  const T particle_force = hemo::ParticleInfo::calculateForceStatistics(&hemocell).avg;
+
+  writeOrCompare(hemocell, "pipeflow", {T(count), fluid_velocity, particle_velocity, particle_force});
+}
@@ -0,0 +1,54 @@
+#ifndef HEMOCELL_TEST_SINGLE_CELL_H
+#define HEMOCELL_TEST_SINGLE_CELL_H
+
+#include "hemocell.h"
+#include "rbcHighOrderModel.h"
+#include "palabos3D.h"
+#include "palabos3D.hh"
+
+#include <map>
+#include <vector>
+
+// Small fixture for the tests that need a particle field: fluid at rest in a
+// box of 52x26x26 nodes with a single RBC in the middle (the set up of the
+// stretch_cell validation, without stretching it). No iterations are done.
+
+const auto single_cell_config = "single_cell/config_single_cell.xml";
+const auto single_cell_type = "validation/stretch_cell/stretch_RBC";
+
+inline void setupSingleCell(hemo::HemoCell &hemocell) {
+  hemo::param::lbm_base_parameters(*hemocell.cfg);
+
+  const plint nz = 26, ny = nz, nx = 2 * nz;
+  hemocell.lattice = new plb::MultiBlockLattice3D<T, DESCRIPTOR>(
+      plb::defaultMultiBlockPolicy3D().getMultiBlockManagement(nx, ny, nz, 2),
+      plb::defaultMultiBlockPolicy3D().getBlockCommunicator(),
+      plb::defaultMultiBlockPolicy3D().getCombinedStatistics(),
+      plb::defaultMultiBlockPolicy3D().getMultiCellAccess<T, DESCRIPTOR>(),
+      new plb::GuoExternalForceBGKdynamics<T, DESCRIPTOR>(1.0 / hemo::param::tau));
+  hemocell.lattice->toggleInternalStatistics(false);
+  hemocell.lattice->periodicity().toggleAll(false);
+  hemocell.latticeEquilibrium(1., hemo::Array<T, 3>({0., 0., 0.}));
+  hemocell.lattice->initialize();
+
+  hemocell.initializeCellfield();
+  hemocell.addCellType<hemo::RbcHighOrderModel>(single_cell_type, RBC_FROM_SPHERE);
+  hemocell.loadParticles();
+}
+
+// The particles of a cell on all local blocks, by vertex id
+inline std::map<int, hemo::HemoCellParticle::serializeValues_t>
+cellVertices(hemo::HemoCell &hemocell, int cellId) {
+  std::map<int, hemo::HemoCellParticle::serializeValues_t> vertices;
+  for (plint bId : hemocell.cellfields->immersedParticles->getLocalInfo().getBlocks()) {
+    hemo::HemoCellParticleField &pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    for (const hemo::HemoCellParticle &particle : pf.particles) {
+      if (particle.sv.cellId == cellId) {
+        vertices[particle.sv.vertexId] = particle.sv;
+      }
+    }
+  }
+  return vertices;
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "helper/cellBVH.h"
+#include "helper/mollerTrumbore.h"
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <set>
+
+// The scanline filling of CellBVH should classify the lattice sites of a
+// closed mesh exactly like casting a ray per site with Moller-Trumbore.
+
+namespace {
+
+// Latitude-longitude ellipsoid, closed with a vertex at each pole
+void ellipsoid(const hemo::Array<T,3> & center, const hemo::Array<T,3> & radius, int rings, int segments,
+               std::vector<hemo::Array<T,3>> & vertices, std::vector<hemo::Array<plint,3>> & triangles) {
+  vertices.clear();
+  triangles.clear();
+  vertices.push_back({center[0], center[1], center[2]+radius[2]});
+  for (int r = 1; r < rings; r++) {
+    const T theta = M_PI*r/rings;
+    for (int s = 0; s < segments; s++) {
+      const T phi = 2*M_PI*s/segments;
+      vertices.push_back({center[0]+radius[0]*sin(theta)*cos(phi),
+                          center[1]+radius[1]*sin(theta)*sin(phi),
+                          center[2]+radius[2]*cos(theta)});
+    }
+  }
+  vertices.push_back({center[0], center[1], center[2]-radius[2]});
+
+  const plint south = vertices.size()-1;
+  for (int s = 0; s < segments; s++) {
+    const plint s1 = (s+1)%segments;
+    triangles.push_back({0, 1+s, 1+s1});
+    for (int r = 0; r < rings-2; r++) {
+      const plint a = 1+r*segments+s, b = 1+r*segments+s1;
+      triangles.push_back({a, a+segments, b});
+      triangles.push_back({b, a+segments, b+segments});
+    }
+    triangles.push_back({south, 1+(rings-2)*segments+s1, 1+(rings-2)*segments+s});
+  }
+}
+
+std::set<hemo::Array<plint,3>> rayCast(const std::vector<hemo::Array<T,3>> & vertices,
+                                       const std::vector<hemo::Array<plint,3>> & triangles,
+                                       const hemo::Array<plint,6> & region) {
+  std::set<hemo::Array<plint,3>> inside;
+  for (plint x = region[0]; x <= region[1]; x++) {
+    for (plint y = region[2]; y <= region[3]; y++) {
+      for (plint z = region[4]; z <= region[5]; z++) {
+        hemo::Array<plint,3> site = {x, y, z};
+        int crossed = 0;
+        for (const hemo::Array<plint,3> & t : triangles) {
+          crossed += hemo::MollerTrumbore(vertices[t[0]], vertices[t[1]], vertices[t[2]], site);
+        }
+        if (crossed%2) { inside.insert(site); }
+      }
+    }
+  }
+  return inside;
+}
+
+}
+
+TEST(CellBVH, matchesMollerTrumbore) {
+  std::vector<hemo::Array<T,3>> vertices;
+  std::vector<hemo::Array<plint,3>> triangles;
+  ellipsoid({20.37, 21.61, 19.13}, {8.3, 6.1, 3.2}, 12, 24, vertices, triangles);
+  // Wrinkle the surface a bit, so the mesh is not convex
+  srand(1);
+  for (hemo::Array<T,3> & vertex : vertices) {
+    for (int d = 0; d < 3; d++) {
+      vertex[d] += 0.4*(rand()/(T)RAND_MAX - 0.5);
+    }
+  }
+
+  hemo::CellBVH bvh;
+  bvh.build(triangles, vertices);
+  const hemo::Array<plint,6> region = {0, 40, 0, 40, 0, 40};
+  const std::set<hemo::Array<plint,3>> expected = rayCast(vertices, triangles, region);
+
+  std::set<hemo::Array<plint,3>> filled;
+  bvh.forEachInnerNode(region, [&](plint x, plint y, plint z) { filled.insert({x, y, z}); });
+  EXPECT_GT(expected.size(), 0u);
+  EXPECT_EQ(filled, expected);
+
+  for (plint x = region[0]; x <= region[1]; x++) {
+    for (plint y = region[2]; y <= region[3]; y++) {
+      for (plint z = region[4]; z <= region[5]; z++) {
+        EXPECT_EQ(bvh.isInside({x, y, z}), expected.count({x, y, z}) == 1);
+      }
+    }
+  }
+
+  // Clipping to a smaller region only drops the sites outside of it
+  std::set<hemo::Array<plint,3>> clipped;
+  bvh.forEachInnerNode({15, 20, 0, 40, 18, 40}, [&](plint x, plint y, plint z) { clipped.insert({x, y, z}); });
+  for (const hemo::Array<plint,3> & site : expected) {
+    const bool inRegion = site[0] >= 15 && site[0] <= 20 && site[2] >= 18;
+    EXPECT_EQ(clipped.count(site), inRegion ? 1u : 0u);
+  }
+}
+
+TEST(CellBVH, verticesOnLattice) {
+  // An octahedron with its vertices and edges on lattice lines, every
+  // scanline through the tips passes exactly through vertices and edges
+  const std::vector<hemo::Array<T,3>> vertices = {{15, 10, 10}, {5, 10, 10}, {10, 15, 10},
+                                                  {10, 5, 10}, {10, 10, 15}, {10, 10, 5}};
+  const std::vector<hemo::Array<plint,3>> triangles = {{0, 2, 4}, {2, 1, 4}, {1, 3, 4}, {3, 0, 4},
+                                                       {2, 0, 5}, {1, 2, 5}, {3, 1, 5}, {0, 3, 5}};
+  hemo::CellBVH bvh;
+  bvh.build(triangles, vertices);
+
+  std::set<hemo::Array<plint,3>> filled;
+  bvh.forEachInnerNode({0, 20, 0, 20, 0, 20}, [&](plint x, plint y, plint z) { filled.insert({x, y, z}); });
+  for (plint x = 0; x <= 20; x++) {
+    for (plint y = 0; y <= 20; y++) {
+      for (plint z = 0; z <= 20; z++) {
+        const plint distance = std::abs(x-10) + std::abs(y-10) + std::abs(z-10);
+        if (distance == 5) { continue; } // On the surface
+        EXPECT_EQ(filled.count({x, y, z}), distance < 5 ? 1u : 0u);
+      }
+    }
+  }
+}
+
+TEST(CellBVH, sitesOnFaceAreOutside) {
+  // A box with the faces normal to x on lattice planes, the scanlines enter
+  // and leave the box exactly at a lattice site
+  const std::vector<hemo::Array<T,3>> vertices = {{5, 4.5, 4.5}, {15, 4.5, 4.5}, {5, 15.5, 4.5}, {15, 15.5, 4.5},
+                                                  {5, 4.5, 15.5}, {15, 4.5, 15.5}, {5, 15.5, 15.5}, {15, 15.5, 15.5}};
+  const std::vector<hemo::Array<plint,3>> triangles = {{0, 2, 4}, {2, 6, 4}, {1, 5, 3}, {3, 5, 7},
+                                                       {0, 4, 1}, {1, 4, 5}, {2, 3, 6}, {3, 7, 6},
+                                                       {0, 1, 2}, {1, 3, 2}, {4, 6, 5}, {5, 6, 7}};
+  hemo::CellBVH bvh;
+  bvh.build(triangles, vertices);
+
+  std::set<hemo::Array<plint,3>> filled;
+  bvh.forEachInnerNode({0, 20, 0, 20, 0, 20}, [&](plint x, plint y, plint z) { filled.insert({x, y, z}); });
+  for (plint x = 0; x <= 20; x++) {
+    for (plint y = 0; y <= 20; y++) {
+      for (plint z = 0; z <= 20; z++) {
+        const bool inside = x > 5 && x < 15 && y >= 5 && y <= 15 && z >= 5 && z <= 15;
+        EXPECT_EQ(filled.count({x, y, z}), inside ? 1u : 0u);
+        EXPECT_EQ(bvh.isInside({x, y, z}), inside);
+      }
+    }
+  }
+}
+
+TEST(CellBVH, oddCrossingsAreOutside) {
+  // An open mesh, the scanlines through the first triangle cross the
+  // membrane once and never leave the cell again. The second one is off
+  // these scanlines and only stretches the bounding box along x.
+  const std::vector<hemo::Array<T,3>> vertices = {{10, 0.5, 0.5}, {10, 20.5, 0.5}, {10, 0.5, 20.5},
+                                                  {20, 30.5, 30.5}, {20, 31.5, 30.5}, {20, 30.5, 31.5}};
+  const std::vector<hemo::Array<plint,3>> triangles = {{0, 1, 2}, {3, 4, 5}};
+  hemo::CellBVH bvh;
+  bvh.build(triangles, vertices);
+
+  std::set<hemo::Array<plint,3>> filled;
+  bvh.forEachInnerNode({0, 20, 0, 20, 0, 20}, [&](plint x, plint y, plint z) { filled.insert({x, y, z}); });
+  EXPECT_EQ(filled.size(), 0u);
+  for (plint x = 0; x <= 20; x++) {
+    EXPECT_EQ(bvh.isInside({x, 5, 5}), false);
+  }
+}
@@ -0,0 +1,45 @@
+#include "config.h"
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+
+// The typed accessors return the values parsed when the config is loaded,
+// which should match parsing the XML element on request.
+const char *config_file = "validation/pipeflow/config_pipeflow.xml";
+
+TEST(Config, typedAccess) {
+  hemo::Config cfg(config_file);
+  EXPECT_EQ(cfg.get<double>("domain/dx"), cfg["domain"]["dx"].read<double>());
+  EXPECT_EQ(cfg.get<int>("domain/particleEnvelope"), 25);
+  EXPECT_EQ(cfg.get<unsigned int>("sim/tmax"), cfg["sim"]["tmax"].read<unsigned int>());
+  EXPECT_EQ(cfg.get<std::string>("parameters/outputDirectory"), "tmp");
+}
+
+TEST(Config, missingParameter) {
+  hemo::Config cfg(config_file);
+  EXPECT_THROW(cfg.get<double>("domain/doesNotExist"), std::invalid_argument);
+  // A section has no numerical value
+  EXPECT_THROW(cfg.get<double>("domain"), std::invalid_argument);
+}
+
+// The keys of a material config are checked when its cell type is added
+TEST(Config, materialUnknownParameter) {
+  hemo::Config known("validation/stretch_cell/stretch_RBC.xml");
+  testing::internal::CaptureStdout();
+  hemo::checkMaterialParameters(&known, "stretch_RBC");
+  EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+
+  hemo::Config unknown("config/material_unknown.xml");
+  testing::internal::CaptureStdout();
+  hemo::checkMaterialParameters(&unknown, "material_unknown");
+  const std::string output = testing::internal::GetCapturedStdout();
+  EXPECT_NE(output.find("(Warning)"), std::string::npos);
+  EXPECT_NE(output.find("MaterialModel/kLnik"), std::string::npos);
+  EXPECT_EQ(output.find("MaterialModel/kLink"), std::string::npos);
+}
+
+TEST(Config, materialMalformedParameter) {
+  hemo::Config malformed("config/material_malformed.xml");
+  EXPECT_EXIT(hemo::checkMaterialParameters(&malformed, "material_malformed"), testing::ExitedWithCode(1), "");
+}
@@ -0,0 +1,100 @@
+#include "helper/convexHull.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdlib>
+
+// The diameter over the convex hull vertices should match comparing every
+// pair of vertices, for convex cells and for the concave RBC.
+
+namespace {
+
+// Latitude-longitude mesh vertices of a surface of revolution around z, given
+// as (radius, height) at each latitude theta
+template<class Profile>
+std::vector<hemo::Array<T,3>> revolve(const hemo::Array<T,3> & center, int rings, int segments, Profile profile) {
+  std::vector<hemo::Array<T,3>> vertices;
+  for (int r = 0; r <= rings; r++) {
+    const T theta = M_PI*r/rings;
+    T radius, height;
+    profile(theta, radius, height);
+    const int n = (r == 0 || r == rings) ? 1 : segments;
+    for (int s = 0; s < n; s++) {
+      const T phi = 2*M_PI*s/segments;
+      vertices.push_back({center[0]+radius*cos(phi), center[1]+radius*sin(phi), center[2]+height});
+    }
+  }
+  return vertices;
+}
+
+// Rotate and jitter the vertices, so no symmetry lines up with the axes
+void perturb(std::vector<hemo::Array<T,3>> & vertices, T jitter) {
+  const T a = 0.3, b = 0.7;
+  for (hemo::Array<T,3> & v : vertices) {
+    const T x = v[0]*cos(a) - v[1]*sin(a), y = v[0]*sin(a) + v[1]*cos(a);
+    const T y2 = y*cos(b) - v[2]*sin(b), z2 = y*sin(b) + v[2]*cos(b);
+    v = {x, y2, z2};
+    for (int d = 0; d < 3; d++) {
+      v[d] += jitter*(rand()/(T)RAND_MAX - 0.5);
+    }
+  }
+}
+
+T bruteForceDiameter(const std::vector<hemo::Array<T,3>> & vertices) {
+  T best = 0;
+  for (unsigned int i = 0; i < vertices.size(); i++) {
+    for (unsigned int j = i + 1; j < vertices.size(); j++) {
+      best = std::max(best, hemo::norm(vertices[i] - vertices[j]));
+    }
+  }
+  return best;
+}
+
+bool onHull(const std::vector<hemo::Array<T,3>> & vertices, unsigned int i) {
+  const std::vector<unsigned int> hull = hemo::convexHullVertices(vertices);
+  return std::find(hull.begin(), hull.end(), i) != hull.end();
+}
+
+}
+
+TEST(ConvexHull, sphereDiameter) {
+  srand(1);
+  std::vector<hemo::Array<T,3>> vertices = revolve({10.2, 11.3, 9.7}, 16, 32,
+      [](T theta, T & radius, T & height) { radius = 4.*sin(theta); height = 4.*cos(theta); });
+  perturb(vertices, 0.);
+  // Every vertex of a sphere is on its hull
+  EXPECT_EQ(hemo::convexHullVertices(vertices).size(), vertices.size());
+  EXPECT_NEAR(hemo::pointSetDiameter(vertices), bruteForceDiameter(vertices), 1e-12);
+}
+
+TEST(ConvexHull, ellipsoidDiameter) {
+  srand(2);
+  std::vector<hemo::Array<T,3>> vertices = revolve({0., 0., 0.}, 20, 40,
+      [](T theta, T & radius, T & height) { radius = 3.*sin(theta); height = 8.*cos(theta); });
+  perturb(vertices, 0.05);
+  EXPECT_NEAR(hemo::pointSetDiameter(vertices), bruteForceDiameter(vertices), 1e-12);
+}
+
+TEST(ConvexHull, rbcDiameter) {
+  srand(3);
+  // Biconcave shape of Evans and Fung, the dimples are not on the hull
+  const T R = 3.91;
+  std::vector<hemo::Array<T,3>> vertices = revolve({5., 5., 5.}, 24, 48, [R](T theta, T & radius, T & height) {
+    const T r = sin(theta);
+    radius = R*r;
+    height = (cos(theta) < 0 ? -0.5 : 0.5)*R*sqrt(1 - r*r)*(0.207 + 2.003*r*r - 1.123*r*r*r*r);
+  });
+  perturb(vertices, 0.01);
+  const std::vector<unsigned int> hull = hemo::convexHullVertices(vertices);
+  EXPECT_LT(hull.size(), vertices.size());
+  EXPECT_FALSE(onHull(vertices, 0)); // The center of the top dimple
+  EXPECT_NEAR(hemo::pointSetDiameter(vertices), bruteForceDiameter(vertices), 1e-12);
+}
+
+TEST(ConvexHull, degeneratePoints) {
+  // Coplanar points span no volume, they are all returned
+  const std::vector<hemo::Array<T,3>> square = {{0, 0, 1}, {2, 0, 1}, {2, 3, 1}, {0, 3, 1}, {1, 1, 1}};
+  EXPECT_EQ(hemo::convexHullVertices(square).size(), square.size());
+  EXPECT_NEAR(hemo::pointSetDiameter(square), sqrt(13.), 1e-12);
+  EXPECT_EQ(hemo::pointSetDiameter({{1, 2, 3}}), 0.);
+}
@@ -0,0 +1,118 @@
+#include "hemocell.h"
+#include "immersedBoundaryMethod.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+// The interpolation kernels are evaluated on Width nodes per direction,
+// starting at floor(x - Width/2) + 1. On these nodes the weights of a kernel
+// sum to one and have a zero first moment, for any position of the vertex.
+
+template <T (*Phi)(T), int Width> void expectMoments() {
+  for (int sample = 0; sample <= 100; sample++) {
+    const T position = -3. + 0.0613 * sample;
+    const plint first = plint(std::floor(position - 0.5 * Width)) + 1;
+    T sum = 0., moment = 0.;
+    for (int i = 0; i < Width; i++) {
+      const T weight = Phi(position - (first + i));
+      EXPECT_GE(weight, 0.);
+      sum += weight;
+      moment += weight * (position - (first + i));
+    }
+    // Nodes outside of the window do not contribute
+    EXPECT_EQ(Phi(position - (first - 1)), 0.);
+    EXPECT_EQ(Phi(position - (first + Width)), 0.);
+    EXPECT_NEAR(sum, 1., 1e-12) << "position: " << position;
+    EXPECT_NEAR(moment, 0., 1e-12) << "position: " << position;
+  }
+}
+
+TEST(IBMKernels, phi2) { expectMoments<hemo::phi2, 2>(); }
+TEST(IBMKernels, phi3) { expectMoments<hemo::phi3, 3>(); }
+TEST(IBMKernels, phi4) { expectMoments<hemo::phi4, 4>(); }
+TEST(IBMKernels, phi4c) {
+  // The cosine kernel only conserves the sum of the weights
+  for (int sample = 0; sample <= 100; sample++) {
+    const T position = -3. + 0.0613 * sample;
+    const plint first = plint(std::floor(position - 2.)) + 1;
+    T sum = 0.;
+    for (int i = 0; i < 4; i++) {
+      sum += hemo::phi4c(position - (first + i));
+    }
+    EXPECT_NEAR(sum, 1., 1e-12) << "position: " << position;
+  }
+}
+
+// A vertex close to the face between two blocks spreads over both of them.
+// The weights each block computes for its own nodes must match the weights
+// of a single block covering both, so no force is lost or gained at the face.
+
+typedef std::map<std::vector<plint>, T> NodeWeights;
+
+static void collectWeights(plb::BlockLattice3D<T, DESCRIPTOR> &block,
+                           const hemo::Array<T, 3> &position,
+                           void (*kernel)(plb::BlockLattice3D<T, DESCRIPTOR> &,
+                                          hemo::HemoCellParticle &,
+                                          hemo::BoundaryMask const &),
+                           NodeWeights &weights) {
+  hemo::BoundaryMask boundaryMask;
+  boundaryMask.build(block);
+  hemo::HemoCellParticle particle(position, 0, 0, 0);
+  kernel(block, particle, boundaryMask);
+
+  const plb::Cell<T, DESCRIPTOR> *origin = &block.get(0, 0, 0);
+  const plint ny = block.getNy(), nz = block.getNz();
+  const plb::Dot3D location = block.getLocation();
+  for (size_t i = 0; i < particle.kernelSize; i++) {
+    const plint node = particle.kernelLocations[i] - origin;
+    const std::vector<plint> global = {node / (ny * nz) + location.x,
+                                       (node / nz) % ny + location.y,
+                                       node % nz + location.z};
+    weights[global] += particle.kernelWeights[i];
+  }
+}
+
+static void expectSplitMatchesWhole(
+    void (*kernel)(plb::BlockLattice3D<T, DESCRIPTOR> &,
+                   hemo::HemoCellParticle &, hemo::BoundaryMask const &)) {
+  plb::BlockLattice3D<T, DESCRIPTOR> whole(
+      16, 8, 8, new plb::BGKdynamics<T, DESCRIPTOR>(1.));
+  plb::BlockLattice3D<T, DESCRIPTOR> left(
+      8, 8, 8, new plb::BGKdynamics<T, DESCRIPTOR>(1.));
+  plb::BlockLattice3D<T, DESCRIPTOR> right(
+      8, 8, 8, new plb::BGKdynamics<T, DESCRIPTOR>(1.));
+  right.setLocation(plb::Dot3D(8, 0, 0));
+
+  const T offsets[] = {7.1, 7.5, 7.6, 8.3};
+  for (T x : offsets) {
+    const hemo::Array<T, 3> position = {x, 3.3, 4.1};
+    NodeWeights expected, split;
+    collectWeights(whole, position, kernel, expected);
+    collectWeights(left, position, kernel, split);
+    collectWeights(right, position, kernel, split);
+
+    ASSERT_EQ(expected.size(), split.size()) << "x: " << x;
+    T sum = 0.;
+    for (const auto &node : expected) {
+      ASSERT_TRUE(split.count(node.first)) << "x: " << x;
+      EXPECT_NEAR(split[node.first], node.second, 1e-12) << "x: " << x;
+      sum += split[node.first];
+    }
+    EXPECT_NEAR(sum, 1., 1e-12) << "x: " << x;
+  }
+}
+
+TEST(IBMKernels, blockFacePhi2) {
+  expectSplitMatchesWhole(hemo::interpolationCoefficientsPhi2);
+}
+TEST(IBMKernels, blockFacePhi3) {
+  expectSplitMatchesWhole(hemo::interpolationCoefficientsPhi3);
+}
+TEST(IBMKernels, blockFacePhi4) {
+  expectSplitMatchesWhole(hemo::interpolationCoefficientsPhi4);
+}
+TEST(IBMKernels, blockFacePhi4c) {
+  expectSplitMatchesWhole(hemo::interpolationCoefficientsPhi4c);
+}
@@ -0,0 +1,94 @@
+#include "single_cell/single_cell.h"
+#include "preInlet.h"
+#include "gtest/gtest.h"
+
+// A cell that crosses the inlet arrives in parts: each exchange the pre-inlet
+// sends the vertices that passed the inlet so far. The vertices received
+// earlier have been advected in the main domain meanwhile, as long as the
+// cell is incomplete they are replaced by the fresh ones from the pre-inlet.
+
+namespace {
+
+void moveDomainParticles(hemo::HemoCell &hemocell, const hemo::Array<T, 3> &shift) {
+  for (plint bId : hemocell.cellfields->immersedParticles->getLocalInfo().getBlocks()) {
+    hemo::HemoCellParticleField &pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    for (hemo::HemoCellParticle &particle : pf.particles) {
+      particle.sv.shiftPosition(shift);
+    }
+    pf.invalidate_pg();
+  }
+}
+
+// Every block holds only copies of the cell as it was sent last
+void expectOnlySent(hemo::HemoCell &hemocell,
+                    const std::map<int, hemo::HemoCellParticle::serializeValues_t> &sent) {
+  for (plint bId : hemocell.cellfields->immersedParticles->getLocalInfo().getBlocks()) {
+    hemo::HemoCellParticleField &pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    for (const hemo::HemoCellParticle &particle : pf.particles) {
+      ASSERT_EQ(particle.sv.cellId, 0);
+      ASSERT_TRUE(sent.count(particle.sv.vertexId)) << "vertex " << particle.sv.vertexId << " was not sent";
+      for (int d = 0; d < 3; d++) {
+        EXPECT_EQ(particle.sv.getPosition()[d], sent.at(particle.sv.vertexId).getPosition()[d]) << "vertex " << particle.sv.vertexId;
+      }
+    }
+  }
+}
+
+}
+
+TEST(PreInlet, partlyReceivedCellIsReplaced) {
+  char *args[] = {(char *)"test", (char *)"path", NULL};
+  hemo::HemoCell hemocell((char *)single_cell_config, 0, args, hemo::HemoCell::MPIHandle::External);
+  setupSingleCell(hemocell);
+  hemo::PreInlet preInlet(&hemocell, (plb::MultiScalarField3D<int> *)0);
+
+  // Take the cell out of the main domain, it is streamed in from the pre-inlet
+  std::map<int, hemo::HemoCellParticle::serializeValues_t> cell = cellVertices(hemocell, 0);
+  const unsigned int numVertex = cell.size();
+  ASSERT_GT(numVertex, 0u);
+  for (plint bId : hemocell.cellfields->immersedParticles->getLocalInfo().getBlocks()) {
+    hemo::HemoCellParticleField &pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    pf.removeParticles(pf.getBoundingBox());
+  }
+  T zMin = cell.begin()->second.getPosition()[2], zMax = zMin;
+  for (const auto &vertex : cell) {
+    zMin = std::min(zMin, vertex.second.getPosition()[2]);
+    zMax = std::max(zMax, vertex.second.getPosition()[2]);
+  }
+
+  const int exchanges = 4;
+  std::map<int, hemo::HemoCellParticle::serializeValues_t> sent;
+  for (int exchange = 1; exchange <= exchanges + 1; exchange++) {
+    // The main domain and the pre-inlet advect the cell differently
+    moveDomainParticles(hemocell, {0.25, 0., 0.});
+    for (auto &vertex : cell) {
+      vertex.second.shiftPosition({0., 0., 0.5});
+    }
+
+    // The part of the cell that passed the inlet, all of it at the last exchanges
+    const T inlet = zMin + 0.5 * exchange + (zMax - zMin) * exchange / exchanges;
+    std::vector<std::vector<char>> buffers(1);
+    sent.clear();
+    for (const auto &vertex : cell) {
+      if (vertex.second.getPosition()[2] > inlet) { continue; }
+      sent[vertex.first] = vertex.second;
+      const char *raw = (const char *)&vertex.second;
+      buffers[0].insert(buffers[0].end(), raw, raw + sizeof(hemo::HemoCellParticle::serializeValues_t));
+    }
+    const bool complete = cellVertices(hemocell, 0).size() == numVertex;
+    preInlet.insertPreInletParticles(buffers, plb::Dot3D(0, 0, 0));
+
+    if (complete) {
+      // A complete cell belongs to the main domain, nothing is replaced
+      std::map<int, hemo::HemoCellParticle::serializeValues_t> present = cellVertices(hemocell, 0);
+      EXPECT_EQ(present.size(), numVertex);
+      for (const auto &vertex : present) {
+        EXPECT_NE(vertex.second.getPosition()[0], cell.at(vertex.first).getPosition()[0]);
+      }
+    } else {
+      expectOnlySent(hemocell, sent);
+      EXPECT_EQ(cellVertices(hemocell, 0).size(), sent.size()) << "exchange " << exchange;
+    }
+  }
+  EXPECT_EQ(cellVertices(hemocell, 0).size(), numVertex);
+}
@@ -0,0 +1,100 @@
+#include "single_cell/single_cell.h"
+#include "gtest/gtest.h"
+
+#include <set>
+#include <utility>
+
+// reorderParticles moves the particles of a block around and remaps the per
+// cell, per type and grid indices instead of rebuilding them. Every index
+// should still resolve to the same (cellId, vertexId) afterwards.
+
+namespace {
+
+typedef std::pair<int, int> VertexKey;
+
+struct Resolved {
+  std::map<int, std::vector<VertexKey>> perCell;
+  std::vector<std::set<VertexKey>> perType;
+  std::vector<std::multiset<VertexKey>> perNode;
+};
+
+VertexKey key(const hemo::HemoCellParticle &particle) {
+  return {particle.sv.cellId, particle.sv.vertexId};
+}
+
+// Builds the indices if they are not up to date, so the next reorder remaps them
+Resolved resolve(hemo::HemoCellParticleField &pf) {
+  Resolved resolved;
+  for (const auto &cell : pf.get_particles_per_cell()) {
+    for (int index : cell.second) {
+      resolved.perCell[cell.first].push_back(index == -1 ? VertexKey(-1, -1) : key(pf.particles[index]));
+    }
+  }
+  const std::vector<std::vector<unsigned int>> &perType = pf.get_particles_per_type();
+  resolved.perType.resize(perType.size());
+  for (unsigned int type = 0; type < perType.size(); type++) {
+    for (unsigned int index : perType[type]) {
+      EXPECT_EQ(pf.particles[index].sv.celltype, type);
+      resolved.perType[type].insert(key(pf.particles[index]));
+    }
+  }
+  for (int x = 0; x < pf.atomicLattice->getNx(); x++) {
+    for (int y = 0; y < pf.atomicLattice->getNy(); y++) {
+      for (int z = 0; z < pf.atomicLattice->getNz(); z++) {
+        std::multiset<VertexKey> onNode;
+        for (unsigned int index : pf.get_particles_on_node(x, y, z)) {
+          onNode.insert(key(pf.particles[index]));
+        }
+        resolved.perNode.push_back(onNode);
+      }
+    }
+  }
+  return resolved;
+}
+
+void expectSameIndices(hemo::HemoCell &hemocell, bool byCell) {
+  for (plint bId : hemocell.cellfields->immersedParticles->getLocalInfo().getBlocks()) {
+    hemo::HemoCellParticleField &pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    const Resolved before = resolve(pf);
+    pf.reorderParticles(byCell);
+    const Resolved after = resolve(pf);
+
+    EXPECT_EQ(after.perCell, before.perCell);
+    for (const auto &cell : after.perCell) {
+      for (unsigned int vertex = 0; vertex < cell.second.size(); vertex++) {
+        if (cell.second[vertex].first == -1) { continue; }
+        EXPECT_EQ(cell.second[vertex], VertexKey(cell.first, vertex));
+      }
+    }
+    EXPECT_EQ(after.perType, before.perType);
+    EXPECT_EQ(after.perNode, before.perNode);
+  }
+}
+
+}
+
+TEST(ReorderParticles, indicesResolveToSameVertices) {
+  char *args[] = {(char *)"test", (char *)"path", NULL};
+  hemo::HemoCell hemocell((char *)single_cell_config, 0, args, hemo::HemoCell::MPIHandle::External);
+  setupSingleCell(hemocell);
+  ASSERT_GT(cellVertices(hemocell, 0).size(), 0u);
+
+  // The particles are loaded in vertex order, so the Morton order moves them
+  expectSameIndices(hemocell, false);
+  bool moved = false;
+  for (plint bId : hemocell.cellfields->immersedParticles->getLocalInfo().getBlocks()) {
+    hemo::HemoCellParticleField &pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    for (unsigned int i = 1; i < pf.particles.size(); i++) {
+      moved |= key(pf.particles[i]) < key(pf.particles[i - 1]);
+    }
+  }
+  EXPECT_TRUE(moved);
+
+  expectSameIndices(hemocell, true);
+  for (plint bId : hemocell.cellfields->immersedParticles->getLocalInfo().getBlocks()) {
+    hemo::HemoCellParticleField &pf = hemocell.cellfields->immersedParticles->getComponent(bId);
+    for (unsigned int i = 1; i < pf.particles.size(); i++) {
+      EXPECT_LT(key(pf.particles[i - 1]), key(pf.particles[i]));
+    }
+  }
+}
@@ -0,0 +1,33 @@
+#include "helper/array.h"
+#include "gtest/gtest.h"
+
+// The closed form eigenvalues of a symmetric 3x3 matrix are used for the
+// Tresca stress in the solidification of platelets. The matrices are given as
+// {xx, xy, xz, yy, yz, zz}, the eigenvalues are returned in ascending order.
+
+TEST(SymmetricEigenvalues, diagonal) {
+  const hemo::Array<double, 3> lambda =
+      hemo::symmetricEigenvalues(hemo::Array<double, 6>({3., 0., 0., -1., 0., 2.}));
+  EXPECT_DOUBLE_EQ(lambda[0], -1.);
+  EXPECT_DOUBLE_EQ(lambda[1], 2.);
+  EXPECT_DOUBLE_EQ(lambda[2], 3.);
+}
+
+TEST(SymmetricEigenvalues, simpleShear) {
+  // Simple shear with shear rate g has strain-rate eigenvalues -g/2, 0, g/2
+  const double g = 1e-4;
+  const hemo::Array<double, 3> lambda =
+      hemo::symmetricEigenvalues(hemo::Array<double, 6>({0., g / 2, 0., 0., 0., 0.}));
+  EXPECT_NEAR(lambda[0], -g / 2, 1e-15);
+  EXPECT_NEAR(lambda[1], 0., 1e-15);
+  EXPECT_NEAR(lambda[2], g / 2, 1e-15);
+}
+
+TEST(SymmetricEigenvalues, full) {
+  // {{2,1,0},{1,2,1},{0,1,2}} has eigenvalues 2-sqrt(2), 2, 2+sqrt(2)
+  const hemo::Array<double, 3> lambda =
+      hemo::symmetricEigenvalues(hemo::Array<double, 6>({2., 1., 0., 2., 1., 2.}));
+  EXPECT_NEAR(lambda[0], 2. - sqrt(2.), 1e-12);
+  EXPECT_NEAR(lambda[1], 2., 1e-12);
+  EXPECT_NEAR(lambda[2], 2. + sqrt(2.), 1e-12);
+}
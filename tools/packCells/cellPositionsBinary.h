@@ -0,0 +1,98 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab
+in the University of Amsterdam. Any questions or remarks regarding this library
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CELL_POSITIONS_BINARY_H
+#define CELL_POSITIONS_BINARY_H
+
+/*
+ * Binary cell position format (<CellType>.posb), shared by packCells (writer)
+ * and HemoCell (reader). All values are stored in native (little endian) byte
+ * order. The layout is:
+ *
+ *   PosbHeader
+ *   uint64_t binStart[nBins[0]*nBins[1]*nBins[2]+1]
+ *   PosbRecord records[count]
+ *
+ * The records are sorted on a coarse grid of bins of binSize, with the bins
+ * ordered x, y, z (z fastest). The records of bin b are the records
+ * binStart[b] up to binStart[b+1]. A reader therefore only has to touch the
+ * pages of the bins that overlap its own region.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+
+#define POSB_MAGIC "POSB"
+#define POSB_VERSION 1
+#define POSB_UNITS_MICROMETER_DEGREE 0
+
+struct PosbHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t count;
+  char cellType[32];
+  uint32_t units;
+  uint32_t nBins[3];
+  double binSize;
+  double origin[3];
+};
+
+/// Location<X Y Z> Rotation<X Y Z>, the same content as a line of a .pos file
+struct PosbRecord {
+  double position[3];
+  double rotation[3];
+};
+
+inline void initPosbHeader(PosbHeader & header, const std::string & cellType, uint64_t count) {
+  memset(&header, 0, sizeof(PosbHeader));
+  memcpy(header.magic, POSB_MAGIC, 4);
+  header.version = POSB_VERSION;
+  header.count = count;
+  strncpy(header.cellType, cellType.c_str(), sizeof(header.cellType)-1);
+  header.units = POSB_UNITS_MICROMETER_DEGREE;
+}
+
+inline bool isValidPosbHeader(const PosbHeader & header) {
+  return (memcmp(header.magic, POSB_MAGIC, 4) == 0) && (header.version == POSB_VERSION);
+}
+
+inline uint64_t posbNumberOfBins(const PosbHeader & header) {
+  return (uint64_t)header.nBins[0]*header.nBins[1]*header.nBins[2];
+}
+
+/// The bin index along a single axis, clamped to the bin grid
+inline uint32_t posbBinOf(const PosbHeader & header, int axis, double position) {
+  double b = std::floor((position - header.origin[axis])/header.binSize);
+  if (b < 0) { return 0; }
+  if (b >= header.nBins[axis]) { return header.nBins[axis]-1; }
+  return (uint32_t)b;
+}
+
+inline uint64_t posbLinearBin(const PosbHeader & header, uint32_t bx, uint32_t by, uint32_t bz) {
+  return ((uint64_t)bx*header.nBins[1] + by)*header.nBins[2] + bz;
+}
+
+#endif /* CELL_POSITIONS_BINARY_H */
@@ -0,0 +1,176 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab
+in the University of Amsterdam. Any questions or remarks regarding this library
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FLAGMATRIX_H
+#define FLAGMATRIX_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cmath>
+
+#include "geometry.h"
+
+using namespace std;
+
+/*
+ * Voxelised domain as written by hemo::writeFlagMatrix() in HemoCell. The file
+ * contains a header line "nx ny nz dx" (dx in [µm]) followed by nx*ny*nz flags
+ * (1 = fluid, 0 = solid), ordered x, y, z (z fastest). Node (i,j,k) is located
+ * at (i,j,k)*dx, so the voxel of a position p is round(p/dx).
+ *
+ * On loading the signed distance to the wall is computed (positive in the
+ * fluid), which the packing uses to push ellipsoids back into the fluid.
+ */
+class FlagMatrix {
+  int n[3];
+  double dx;
+  vector<char> flags;
+  vector<float> distance;
+
+  // Squared euclidean distance transform along one line (Felzenszwalb & Huttenlocher)
+  static void edt1d(const vector<double> & f, vector<double> & d, vector<int> & v, vector<double> & z) {
+    int len = f.size(), k = 0;
+    v[0] = 0;
+    z[0] = -numeric_limits<double>::infinity();
+    z[1] = numeric_limits<double>::infinity();
+    for (int q = 1; q < len; q++) {
+      double s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k])) / (2.*q - 2.*v[k]);
+      while (s <= z[k]) {
+        k--;
+        s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k])) / (2.*q - 2.*v[k]);
+      }
+      k++;
+      v[k] = q;
+      z[k] = s;
+      z[k+1] = numeric_limits<double>::infinity();
+    }
+    k = 0;
+    for (int q = 0; q < len; q++) {
+      while (z[k+1] < q) k++;
+      d[q] = (q - v[k])*(q - v[k]) + f[v[k]];
+    }
+  }
+
+  // Squared distance (in voxels) from every voxel to the nearest voxel with flags == target
+  vector<double> squaredDistanceTo(char target) const {
+    const double inf = 1e20;
+    vector<double> dist(flags.size());
+    for (size_t i = 0; i < flags.size(); i++) dist[i] = (flags[i] == target) ? 0. : inf;
+
+    int maxn = max(max(n[0], n[1]), n[2]);
+    vector<double> f(maxn), d(maxn), z(maxn+1);
+    vector<int> v(maxn);
+    int stride[3] = { n[1]*n[2], n[2], 1 };
+    for (int axis = 0; axis < 3; axis++) {
+      int a1 = (axis+1)%3, a2 = (axis+2)%3;
+      f.resize(n[axis]); d.resize(n[axis]);
+      for (int i1 = 0; i1 < n[a1]; i1++) {
+        for (int i2 = 0; i2 < n[a2]; i2++) {
+          size_t base = (size_t)i1*stride[a1] + (size_t)i2*stride[a2];
+          for (int q = 0; q < n[axis]; q++) f[q] = dist[base + (size_t)q*stride[axis]];
+          edt1d(f, d, v, z);
+          for (int q = 0; q < n[axis]; q++) dist[base + (size_t)q*stride[axis]] = d[q];
+        }
+      }
+    }
+    return dist;
+  }
+
+  size_t index(int i, int j, int k) const {
+    return ((size_t)i*n[1] + j)*n[2] + k;
+  }
+
+  // Clamp a position in [µm] to the closest voxel
+  void voxelOf(const vector3 & pos, int * ijk) const {
+    for (int d = 0; d < 3; d++) {
+      ijk[d] = (int) floor(pos[d]/dx + 0.5);
+      if (ijk[d] < 0) ijk[d] = 0;
+      if (ijk[d] >= n[d]) ijk[d] = n[d]-1;
+    }
+  }
+
+public:
+  bool load(const string & fileName) {
+    ifstream file(fileName);
+    if (!file.is_open()) return false;
+    if (!(file >> n[0] >> n[1] >> n[2] >> dx)) return false;
+    if (n[0] <= 0 || n[1] <= 0 || n[2] <= 0 || dx <= 0.) return false;
+
+    flags.resize((size_t)n[0]*n[1]*n[2]);
+    int flag;
+    for (size_t i = 0; i < flags.size(); i++) {
+      if (!(file >> flag)) return false;
+      flags[i] = (flag != 0);
+    }
+
+    // Signed distance in [µm], the wall is located halfway between a fluid and a solid node
+    vector<double> toSolid = squaredDistanceTo(0);
+    vector<double> toFluid = squaredDistanceTo(1);
+    distance.resize(flags.size());
+    for (size_t i = 0; i < flags.size(); i++) {
+      if (flags[i]) distance[i] = (sqrt(toSolid[i]) - 0.5) * dx;
+      else distance[i] = (0.5 - sqrt(toFluid[i])) * dx;
+    }
+    return true;
+  }
+
+  /// Domain size in [µm]
+  vector3 getSize() const { return vector3(n[0]*dx, n[1]*dx, n[2]*dx); }
+  double getDx() const { return dx; }
+
+  /// Volume of the fluid nodes in [µm^3]
+  double getFluidVolume() const {
+    size_t fluid = 0;
+    for (char f : flags) fluid += f;
+    return fluid*dx*dx*dx;
+  }
+
+  /// Signed distance to the wall in [µm] of a position in [µm], positive in the fluid
+  double getDistance(const vector3 & pos) const {
+    int ijk[3];
+    voxelOf(pos, ijk);
+    return distance[index(ijk[0], ijk[1], ijk[2])];
+  }
+
+  /// Unit vector pointing away from the wall (central differences of the distance)
+  vector3 getNormal(const vector3 & pos) const {
+    int ijk[3];
+    voxelOf(pos, ijk);
+    vector3 g;
+    for (int d = 0; d < 3; d++) {
+      int lo[3] = { ijk[0], ijk[1], ijk[2] }, hi[3] = { ijk[0], ijk[1], ijk[2] };
+      if (lo[d] > 0) lo[d]--;
+      if (hi[d] < n[d]-1) hi[d]++;
+      if (hi[d] == lo[d]) continue;
+      g[d] = (distance[index(hi[0], hi[1], hi[2])] - distance[index(lo[0], lo[1], lo[2])]) / ((hi[d]-lo[d])*dx);
+    }
+    double len = sqrt(g*g);
+    if (len < 1e-12) return vector3();
+    return g * (1./len);
+  }
+};
+
+#endif /* FLAGMATRIX_H */
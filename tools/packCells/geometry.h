@@ -384,18 +384,41 @@ class Quaternion {
 public:
     Quaternion();
     Quaternion(double ss, vector3 pp) : s(ss), p(pp) { norm(); }
+    // Inverse of eulerAngles(), the rotation matrix countQ() is rebuilt from
+    // the angles and converted back, so a written orientation reads back equal
     Quaternion(vector3 euler_angles) {
-        vector3 px(sin(0.5*euler_angles[0]), 0, 0);
-        vector3 py(0, sin(0.5*euler_angles[1]), 0);
-        vector3 pz(0, 0, sin( 0.5*euler_angles[2]));
-        double sx = cos(0.5*euler_angles[0]);
-        double sy = cos(0.5*euler_angles[1]);
-        double sz = cos(0.5*euler_angles[2]);
-        Quaternion qx(sx, px);
-        Quaternion qy(sy, py);
-        Quaternion qz(sz, pz);
-        Quaternion q1 = qx * qy;
-        *this = (q1 * qz).norm();
+        double ca = cos(euler_angles[0]), sa = sin(euler_angles[0]);
+        double cb = cos(euler_angles[1]), sb = sin(euler_angles[1]);
+        double cc = cos(euler_angles[2]), sc = sin(euler_angles[2]);
+        double val[3][3] = {{cb*cc, cb*sc, -sb},
+                            {sa*sb*cc - ca*sc, sa*sb*sc + ca*cc, sa*cb},
+                            {ca*sb*cc + sa*sc, ca*sb*sc - sa*cc, ca*cb}};
+        matrix33 Q(val);
+
+        // Largest of s and p components first, to avoid dividing by a small value
+        double tr = Q(0,0) + Q(1,1) + Q(2,2);
+        if (tr > 0) {
+            s = 0.5 * sqrt(1 + tr);
+            p = vector3(Q(1,2) - Q(2,1), Q(2,0) - Q(0,2), Q(0,1) - Q(1,0)) * (0.25 / s);
+        } else if (Q(0,0) >= Q(1,1) && Q(0,0) >= Q(2,2)) {
+            double p0 = 0.5 * sqrt(1 + Q(0,0) - Q(1,1) - Q(2,2));
+            s = (Q(1,2) - Q(2,1)) * 0.25 / p0;
+            p = vector3(p0, (Q(0,1) + Q(1,0)) * 0.25 / p0, (Q(0,2) + Q(2,0)) * 0.25 / p0);
+        } else if (Q(1,1) >= Q(2,2)) {
+            double p1 = 0.5 * sqrt(1 + Q(1,1) - Q(0,0) - Q(2,2));
+            s = (Q(2,0) - Q(0,2)) * 0.25 / p1;
+            p = vector3((Q(0,1) + Q(1,0)) * 0.25 / p1, p1, (Q(1,2) + Q(2,1)) * 0.25 / p1);
+        } else {
+            double p2 = 0.5 * sqrt(1 + Q(2,2) - Q(0,0) - Q(1,1));
+            s = (Q(0,1) - Q(1,0)) * 0.25 / p2;
+            p = vector3((Q(0,2) + Q(2,0)) * 0.25 / p2, (Q(1,2) + Q(2,1)) * 0.25 / p2, p2);
+        }
+        norm();
+    }
+    // Euler angles [rad] as written to the <Cell>.pos files
+    vector3 eulerAngles() const {
+        matrix33 Q = countQ();
+        return vector3(atan2(Q(1,2),Q(2,2)), -asin(Q(0,2)), atan2(Q(0,1),Q(0,0)));
     }
     Quaternion& operator*= (const Quaternion& q) {
         Quaternion t(*this);
@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 void PrintHelp() {
   std::cerr <<
           "USAGE: packCells sX sY sZ [OPTIONAL ARGUMENTS ...]\n"
+          "       packCells --flags <file> [OPTIONAL ARGUMENTS ...]\n"
           "\n"
           "OPTIONAL ARGUMENTS:\n"
           "  --hematocrit <0-1.0>                 -h The hematocrit of the solution (human blood only!)\n"
@@ -46,12 +47,22 @@ void PrintHelp() {
           "  --noRotate                              Disallow rotation of ellipsoids\n"
           "  --scale <ratio>                      -s Scales the neighbourhood grid (only change this if you know what you are doing!)\n"
           "  --maxiter <n>                           Maximum number of iterations\n"
+          "  --tolerance <tol>                       Stop when the actual and nominal packing density differ\n"
+          "                                          less than tol (relative), default: only stop force-free\n"
+          "  --resume                                Continue from the <Cell>.pos files in the working directory\n"
+          "  --flags <file>                          Pack inside the fluid region of a flag matrix written by\n"
+          "                                          hemo::writeFlagMatrix(), the domain size is taken from it\n"
+          "  --wall_margin <d>                       Minimal distance of the cells to the walls in [µm], default=0\n"
+          "  --binary                                Also write the binary <Cell>.posb output\n"
           "  --help                                  Print this"
           "\n"
           "OUTPUT:\n"
           "  <Cell>.pos for every celltype. The first line contains the number of cells.\n"
           "  The rest of the lines are the cells in \"Location<X Y Z> Rotation<X Y Z>\" format."
           "\n"
+          "  <Cell>.posb (with --binary) contains the same cells in a binary, spatially\n"
+          "  sorted format which HemoCell prefers over the text format when present.\n"
+          "\n"
           "  Cells.pov is a tool for visualization in povray\n"
           "\n"
           "NOTE:\n"
@@ -60,6 +71,8 @@ void PrintHelp() {
           "  --hematocrit and --RBC are mutually exclusive\n"
           "  --hematocrit and --PLT are mutually exclusive\n"
           "  --PLT_ratio does not work without --hematocrit\n"
+          "  With --flags the hematocrit is relative to the fluid volume of the geometry\n"
+          "  The packing runs in parallel with OpenMP, use OMP_NUM_THREADS to set the number of threads\n"
           ; 
           
 }
@@ -81,6 +94,11 @@ const option long_opts[] = {
             {"scale",      1, nullptr, 7},
             {"maxiter",    1, nullptr, 8},
             {"help",       0, nullptr, 9},
+            {"binary",     0, nullptr, 15},
+            {"tolerance",  1, nullptr, 16},
+            {"resume",     0, nullptr, 17},
+            {"flags",      1, nullptr, 18},
+            {"wall_margin",1, nullptr, 19},
             {NULL, 0, 0, 0}
 };
 
@@ -108,6 +126,11 @@ int main(int argc, char *argv[])
   bool hematocrit_set = false;
   bool RBC_PLT_set = false;
   bool doRotate = true;
+  bool writeBinary = false;
+  double tolerance = 0.0;
+  bool resume = false;
+  string flagFile = "";
+  double wallMargin = 0.0;
   vector<CellType> cellTypes;
   
   
@@ -178,6 +201,21 @@ int main(int argc, char *argv[])
       case(8):
         maxIter = atoi(optarg);
         break;
+      case(15):
+        writeBinary = true;
+        break;
+      case(16):
+        tolerance = atof(optarg);
+        break;
+      case(17):
+        resume = true;
+        break;
+      case(18):
+        flagFile = string(optarg);
+        break;
+      case(19):
+        wallMargin = atof(optarg);
+        break;
       case(9):
       case('?'):
       default:
@@ -185,21 +223,33 @@ int main(int argc, char *argv[])
         return 1;
     }
   }
-  if (optind + 3 > argc) {
-    cout << "Insufficient arguments." << endl << endl;
-    PrintHelp();
-    return 1;
+  FlagMatrix flags;
+  if (flagFile != "") {
+    if (!flags.load(flagFile)) {
+      cerr << "Cannot read flag matrix " << flagFile << ", exiting..." << endl;
+      return 1;
+    }
+    vector3 size = flags.getSize();
+    sX = size[0];
+    sY = size[1];
+    sZ = size[2];
+  } else {
+    if (optind + 3 > argc) {
+      cout << "Insufficient arguments." << endl << endl;
+      PrintHelp();
+      return 1;
+    }
+    sX = atoi(argv[optind]);
+    sY = atoi(argv[optind+1]);
+    sZ = atoi(argv[optind+2]);
   }
-  sX = atoi(argv[optind]);
-  sY = atoi(argv[optind+1]);
-  sZ = atoi(argv[optind+2]);
   
   if (!hematocrit_set && cellTypes.size() == 0) {
     cout << "You need to specify at least a celltype (--RBC, --PLT, --WBC, --CELL, etc.) or the hematocrit (--hematocrit), exiting..." << endl;
     return 1;
   }
   if (hematocrit_set) {
-    double domainVol = sX*sY*sZ;
+    double domainVol = (flagFile != "") ? flags.getFluidVolume() : sX*sY*sZ;
     double rbcVolNominal = 97.0; // This is set to match the model used in HemoCell! 
     //TODO subtract wbc number? why?
     int nRBC = (int)round(hematocrit * domainVol / rbcVolNominal);
@@ -246,6 +296,12 @@ int main(int argc, char *argv[])
   cout << "  Maximum Iterations : " << maxIter << endl;
   cout << "  Scale              : " << scale << endl;
   cout << "  Rotation           : " << doRotate << endl;
+  cout << "  Tolerance          : " << tolerance << endl;
+  cout << "  Resume             : " << resume << endl;
+  if (flagFile != "") {
+    cout << "  Geometry           : " << flagFile << endl;
+    cout << "  Wall margin [µm]   : " << wallMargin << endl;
+  }
   if (hematocrit_set) {
     cout << "  Hematocrit    : " << hematocrit << endl;
     cout << "  PLT/RBC Ratio : " << plt_ratio << endl;
@@ -261,12 +317,20 @@ int main(int argc, char *argv[])
   Packing pack;
   
   pack.setRndRotation(doRotate); // This needs to be set first!
+  pack.setTolerance(tolerance);
+  pack.setResume(resume);
+  if (flagFile != "") {
+    pack.setFlagMatrix(&flags, wallMargin);
+  }
   
   pack.initBlood(sX, sY, sZ, maxIter, scale, cellTypes);
 
   pack.execute();
 
   pack.saveBloodCellPositions();
+  if (writeBinary) {
+    pack.saveBloodCellPositionsBinary();
+  }
   
   //pack.savePov(povFileName.c_str(), sX, sY, sZ, wbcNumber);
 
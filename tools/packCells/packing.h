@@ -37,14 +37,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 #include <math.h>
 #include <stdlib.h>
+#include <omp.h>
 
 #include "geometry.h"
 #include "ellipsoid.h"
 #include "rnd_utils.h"
+#include "cellPositionsBinary.h"
+#include "flagMatrix.h"
 
 
 using namespace std;
 
+// A single ellipsoid-ellipsoid overlap found by a thread, applied afterwards
+struct Contact {
+  int ipart, jpart;
+  vector3 f, fu_i, fu_j;
+};
+
 class Packing {
   bool isFinished;
 
@@ -58,32 +67,44 @@ class Packing {
   double Pactual, nomPackDens, DensityNominal;
 
   int No_cells_x, No_cells_y, No_cells_z;
-  int No_cells, Ncell_min;
+  int No_cells;
   int Max_steps, NumSteps=0, Ntau;
-  double Sphere_vol, Diam_dens;
-  double Rc_max, Rcut, Rcut2, Relax;
+  double Sphere_vol, Diam_dens, Fluid_vol;
+  double Rc_max, Relax;
   vector3 Box, Half;
 
+  // Neighbour cell list, the cells are at least one cut-off distance wide
+  int Ncl[3], No_cl;
+  vector3 Cl_size;
+  bool useCellList;
   int *Link_head, *Link_list;
-  int *Ncell_bound_x, *Ncell_bound_y, *Ncell_bound_z;
-  double *Pbc_x, *Pbc_y, *Pbc_z;
+  double *Rbound;
 
   bool doExit;
   int Nfig, Nsf;
   int printEveryNSteps;
   int Nrot_step;
 
-
   double Sizing = 1.0;
+  double Tolerance = 0.0;
 
   bool rndRotation = true;
+  bool resume = false;
+
+  // Optional voxelised geometry, the ellipsoids are kept in its fluid region
+  FlagMatrix * Flags = 0;
+  double Wall_margin = 0.0;
 
   void init();
   void iterate();
   void calc_forces();
   void calc_motion();
-  void force_part(int ipart_p);
-  void force_all(int ipart_p);
+  void build_cell_list();
+  void force_part(int ipart_p, vector<Contact> & contacts, double & dinner);
+  void force_all(int ipart_p, vector<Contact> & contacts, double & dinner);
+  void force_wall(int ipart_p);
+  void place_in_fluid(int ipart_p);
+  void readBloodCellPositions();
   void outputHeader();
   void output();
   double zeroin(BinaryEllipsoidSystem& ell, double ax, double bx);
@@ -92,55 +113,70 @@ public:
   ~Packing();
   void execute();
 
-  double calc_forces(BinaryEllipsoidSystem& e, Ellipsoid& ei, Ellipsoid& ej);
+  bool calc_forces(BinaryEllipsoidSystem& e, Ellipsoid& ei, Ellipsoid& ej, Contact & c, double & dinner);
 
   // Initialise blood suspension with RBCs and platelets
   void initBlood(float sizeX, float sizeY, float sizeZ, int maxSteps, double sizing, vector<CellType> & ctypes);
   // void initSuspension(vector<int> nPartsPerComponent, vector<vector3> diametersPerComponent, vector<int> domainSize, double nominalPackingDensity, int maxSteps, double sizing);
   void savePov(const char * fileName, int wbcNumber);
   void saveBloodCellPositions();
+  void saveBloodCellPositionsBinary(double binSize = 16.0);
   void getOutput(vector<vector<vector3> > &positions, vector<vector<vector3> > &angles);
   void setRndRotation(bool rndRotation_) {rndRotation = rndRotation_;}
+  // Stop when the actual and nominal packing density differ less than this (relative)
+  void setTolerance(double tolerance_) {Tolerance = tolerance_;}
+  // Start from the <Cell>.pos files in the working directory instead of random positions
+  void setResume(bool resume_) {resume = resume_;}
+  // Pack inside the fluid region of a flag matrix, wallMargin is in [µm]. Must be set before initBlood
+  void setFlagMatrix(FlagMatrix * flags_, double wallMargin) {Flags = flags_; Wall_margin = wallMargin;}
 };
 
 
 
-double Packing::calc_forces(BinaryEllipsoidSystem& e, Ellipsoid& ei, Ellipsoid& ej) {
+// Computes the overlap of a pair, the resulting forces are stored in c and only
+// applied later on, so this can be called concurrently for different pairs.
+bool Packing::calc_forces(BinaryEllipsoidSystem& e, Ellipsoid& ei, Ellipsoid& ej, Contact & c, double & dinner) {
 
   double lambda = zeroin(e, 0., 1.);
   e.get_lambda() = lambda;
 
   if (fabs(lambda) < 1e-10) {
+    #pragma omp critical
+    {
     cout << "e1" << endl << ei << endl;
     cout << "e2" << endl << ej << endl;
     cout << "lambda too small, returning!"<<endl;
-    return 0;
+    }
+    return false;
   }
   double f_AB_scl = 4 * e.f_AB(lambda);
   double f_AB = f_AB_scl / Douter2;
   vector3 n = e.count_n();
-  if (f_AB >= 1) return f_AB;
+  if (f_AB >= 1) return false;
   if (f_AB <= 0) {
+    #pragma omp critical
+    {
     cout << "fab " << f_AB << endl;
     cout << ei << endl;
     cout << ej << endl;
     cout << e << endl;
     cout << "-----------------------------------------------" << endl;
+    }
   }
 //	shift
-  if (f_AB_scl < Dinner) Dinner = f_AB_scl;
-  vector3 f = (1 - f_AB) * norm(n);
-  ei.get_f() -= f;
-  ej.get_f() += f;
+  if (f_AB_scl < dinner) dinner = f_AB_scl;
+  c.f = (1 - f_AB) * norm(n);
+  c.fu_i = vector3();
+  c.fu_j = vector3();
 
 //	rotation
-  if (Epsilon_rot < 1e-10 || NumSteps % Nrot_step) return f_AB;
+  if (Epsilon_rot < 1e-10 || NumSteps % Nrot_step) return true;
 
   if (!ei.getSpecies()->getIsSphere())
-          ei.get_fu() -= (1 - f_AB) * norm(prod(e.count_rac(), n));
+          c.fu_i = (1 - f_AB) * norm(prod(e.count_rac(), n));
   if (!ej.getSpecies()->getIsSphere())
-          ej.get_fu() += (1 - f_AB) * norm(prod(e.count_rbc(), n));
-  return f_AB;
+          c.fu_j = (1 - f_AB) * norm(prod(e.count_rbc(), n));
+  return true;
 }
 
 
@@ -159,12 +195,7 @@ Packing::Packing () {
 Packing::~Packing() {
 	delete[] Link_head;
 	delete[] Link_list;
-	delete[] Ncell_bound_x;
-	delete[] Ncell_bound_y;
-	delete[] Ncell_bound_z;
-	delete[] Pbc_x;
-	delete[] Pbc_y;
-	delete[] Pbc_z;
+	delete[] Rbound;
 	for (int i = 0; i < NumParts; i++) delete particles[i];
 	for (int i = 0; i < NumSpecies; i++) delete species[i];
 	delete[] particles;
@@ -234,8 +265,12 @@ void Packing::initBlood(float sizeX, float sizeY, float sizeZ, int maxSteps, dou
     counter++;
   }
 
-  // Calc nominal packing density
+  // Calc nominal packing density, with a geometry only the fluid volume is available
   double domainVol = sizeX * sizeY * sizeZ;
+  if (Flags) {
+    domainVol = Flags->getFluidVolume() * Sizing * Sizing * Sizing;
+    cout << "Fluid volume of the geometry: " << Flags->getFluidVolume() << " [µm3] (" << domainVol / (sizeX * sizeY * sizeZ) * 100. << "% of the domain)" << endl;
+  }
   double cellVol = 0;
   for (CellType & ctype : ctypes) {
     cellVol += ((4./3. * PI * ctype.dx/2. * ctype.dy/2. * ctype.dz/2.) * ctype.number);
@@ -263,14 +298,12 @@ void Packing::initBlood(float sizeX, float sizeY, float sizeZ, int maxSteps, dou
 
 
 void Packing::init() {
-	int imult;
-	int ndim_x, ndim_y, ndim_z;
 	No_cells = No_cells_x * No_cells_y * No_cells_z;
-	Ncell_min = (No_cells_x < No_cells_y) ?  No_cells_x : No_cells_y;
-	Ncell_min = (No_cells_z < Ncell_min) ? No_cells_z : Ncell_min;
 	Box = vector3(No_cells_x, No_cells_y, No_cells_z);
 	Half = 0.5 * Box;
-	Diam_dens = No_cells / Sphere_vol;
+	Fluid_vol = No_cells;
+	if (Flags) Fluid_vol = Flags->getFluidVolume() * Sizing * Sizing * Sizing;
+	Diam_dens = Fluid_vol / Sphere_vol;
 	double corr = 0;
 	vector3 r;
 	Rc_max = 0;
@@ -294,52 +327,73 @@ void Packing::init() {
 		for (int ip = 0; ip < species[is]->getNum(); ip++)
 			particles[ipart++] = new Ellipsoid (species[is], Box);
 
-	Link_head = new int [No_cells];
+	if (Flags)
+		for (int i = 0; i < NumParts; i++) place_in_fluid(i);
+
+	if (resume) readBloodCellPositions();
+
+	// Bounding sphere (scaled by Douter) of every particle, used to skip pairs
+	// that cannot overlap before solving for their contact function
+	double Rbound_max = 0;
+	Rbound = new double [NumParts];
+	for (int i = 0; i < NumParts; i++) {
+		r = particles[i]->getSpecies()->getSize();
+		Rbound[i] = 0.55 * max(max(r[0], r[1]), r[2]);
+		if (Rbound[i] > Rbound_max) Rbound_max = Rbound[i];
+	}
+
+	// Douter only decreases, so cells sized on the initial cut-off stay valid.
+	// With less than three cells in a direction the 27 neighbouring cells are
+	// no longer distinct, in that case every pair is checked instead.
+	double Rcut_max = 2 * Rbound_max * Douter0;
+	useCellList = true;
+	No_cl = 1;
+	for (int d = 0; d < 3; d++) {
+		Ncl[d] = (int) (Box[d] / Rcut_max);
+		if (Ncl[d] < 3) useCellList = false;
+		if (Ncl[d] < 1) Ncl[d] = 1;
+		Cl_size[d] = Box[d] / Ncl[d];
+		No_cl *= Ncl[d];
+	}
+
+	Link_head = new int [No_cl];
 	Link_list = new int [NumParts];
+}
 
-	ndim_x = 3 * No_cells_x - 1;
-	ndim_y = 3 * No_cells_y - 1;
-	ndim_z = 3 * No_cells_z - 1;
-
-	Ncell_bound_x = new int [ndim_x];
-	Ncell_bound_y = new int [ndim_y];
-	Ncell_bound_z = new int [ndim_z];
-
-	Pbc_x = new double [ndim_x];
-	Pbc_y = new double [ndim_y];
-	Pbc_z = new double [ndim_z];
-
-	imult = 1;
-	corr = -No_cells_x;
-	for (int i = 1; i < ndim_x; i++) {
-		Ncell_bound_x[i] = imult * No_cells_y * No_cells_z;
-		Pbc_x[i] = corr;
-		if (++imult >= No_cells_x) {
-			imult = 0;
-			corr += No_cells_x;
+// Reads the <Cell>.pos files written by a previous (unfinished) run. Missing
+// cells keep their random initial position, superfluous ones are ignored.
+void Packing::readBloodCellPositions() {
+	int speciesCounter = 0;
+
+	for (int j = 0; j < NumSpecies; j++){
+		ifstream cellsFile (species[j]->name + ".pos");
+		if (!cellsFile.is_open()) {
+			cout << "WARNING: Cannot resume " << species[j]->name << ", " << species[j]->name << ".pos not found, using random positions." << endl;
+			speciesCounter += species[j]->getNum();
+			continue;
 		}
-	}
-	imult = 1;
-	corr = -No_cells_y;
-	for (int i = 1; i < ndim_y; i++) {
-		Ncell_bound_y[i] = imult * No_cells_z;
-		Pbc_y[i] = corr;
-		if (++imult >= No_cells_y) {
-			imult = 0;
-			corr += No_cells_y;
+
+		int numInFile = 0;
+		cellsFile >> numInFile;
+		if (numInFile != species[j]->getNum()) {
+			cout << "WARNING: " << species[j]->name << ".pos contains " << numInFile << " cells, while " << species[j]->getNum() << " are requested." << endl;
 		}
-	}
-	imult = 1;
-	corr = -No_cells_z;
-	for (int i = 1; i < ndim_z; i++) {
-		Ncell_bound_z[i] = imult;
-		Pbc_z[i] = corr;
-		if (++imult >= No_cells_z) {
-			imult = 0;
-			corr += No_cells_z;
+
+		int read = 0;
+		double px, py, pz, ex, ey, ez;
+		while (read < species[j]->getNum() && cellsFile >> px >> py >> pz >> ex >> ey >> ez) {
+			Ellipsoid *pi = particles[speciesCounter + read];
+			vector3 pos = vector3(px, py, pz) * Sizing;
+			pos.pbc(Box);
+			pi->get_pos() = pos;
+			pi->get_q() = Quaternion(vector3(ex, ey, ez) * (PI / 180)); //Deg to Rad
+			read++;
 		}
-	}
+		cout << "Resumed " << read << " " << species[j]->name << " cells from " << species[j]->name << ".pos" << endl;
 
+		cellsFile.close();
+		speciesCounter += species[j]->getNum();
+	}
 }
 
 void Packing::iterate() {
@@ -351,8 +405,10 @@ void Packing::iterate() {
 	DensityNominal = Douter * Douter * Douter / Diam_dens;
 	Pactual = Dinner * Dinner * Dinner / Diam_dens;
 	
-	// Stop criterion
+	// Stop criterion, either force-free or (when requested) the inner and outer
+	// diameters have converged to the tolerance
 	isFinished = (Force_step < 1e-15);
+	if (Tolerance > 0. && DensityNominal - Pactual < Tolerance * DensityNominal) isFinished = true;
 
 	if (isFinished) {
 		output();
@@ -367,47 +423,69 @@ void Packing::iterate() {
 	}
 }
 
+// The pair forces are computed in parallel over the particles. Each pair is
+// only visited by its highest index particle; the overlaps found are gathered
+// per thread and applied afterwards, so no two threads write to the same
+// particle and no locking is required.
 void Packing::calc_forces() {
 
-	Dinner = Douter*Douter;
+	double dinner_all = Douter*Douter;
 	int i;
-	
-	#pragma omp parallel  for private(i)
-	for (i = 0; i < No_cells; i++)
-		Link_head[i] = -1;
-	
-	#pragma omp parallel  for private(i)
+
+	#pragma omp parallel for private(i)
 	for (i = 0; i < NumParts; i++) {
 		particles[i]->set_force();
 		particles[i]->set_forceu();
 	}
-	
-	int ipart;
 
-	#pragma omp parallel  for private(ipart) schedule(static)
-	for (ipart = 0; ipart < NumParts; ipart++) {
-		Species* k = particles[ipart]->getSpecies();
-		Rcut = 0.55 * Douter * ((k->getSize())[0] + Rc_max);
-		Rcut2 = Rcut * Rcut;
+	build_cell_list();
 
-		if ((int) (2.0 * Rcut) < Ncell_min - 1) force_part(ipart);
-		else force_all(ipart);
+	vector<Contact> contacts;
+
+	#pragma omp parallel
+	{
+		vector<Contact> contacts_local;
+		double dinner = dinner_all;
+		int ipart;
+
+		#pragma omp for private(ipart) schedule(static) nowait
+		for (ipart = 0; ipart < NumParts; ipart++) {
+			if (useCellList) force_part(ipart, contacts_local, dinner);
+			else force_all(ipart, contacts_local, dinner);
+			// Only touches ipart, the contacts are applied after this loop
+			if (Flags) force_wall(ipart);
+		}
+
+		#pragma omp for ordered schedule(static,1)
+		for (int t = 0; t < omp_get_num_threads(); t++) {
+			#pragma omp ordered
+			{
+			contacts.insert(contacts.end(), contacts_local.begin(), contacts_local.end());
+			if (dinner < dinner_all) dinner_all = dinner;
+			}
+		}
+	}
+
+	for (const Contact & c : contacts) {
+		particles[c.ipart]->get_f() -= c.f;
+		particles[c.jpart]->get_f() += c.f;
+		particles[c.ipart]->get_fu() -= c.fu_i;
+		particles[c.jpart]->get_fu() += c.fu_j;
 	}
-	Dinner = sqrt(Dinner);
+	Dinner = sqrt(dinner_all);
 }
 
 void Packing::calc_motion() {
-	vector3 buff;
-	Force_step = 0;
+	double force_step = 0;
 	Epsilon_scl = Epsilon * Douter0;
 	int i;
 
-	#pragma omp parallel for private(i,buff)
+	#pragma omp parallel for private(i) reduction(+:force_step)
 	for (i = 0; i < NumParts; i++) {
 		Ellipsoid *p = particles[i];
-		Force_step += sqrt(p->get_f()*p->get_f());
+		force_step += sqrt(p->get_f()*p->get_f());
 //	translation
-		buff = p->get_pos() + p->get_f() * Epsilon_scl;
+		vector3 buff = p->get_pos() + p->get_f() * Epsilon_scl;
 		buff.pbc(Box);
 		p->get_pos() = buff;
 
@@ -424,74 +502,121 @@ void Packing::calc_motion() {
 		p->rotate(q);
 	}
 
-	Force_step /= NumParts;
+	Force_step = force_step / NumParts;
+}
+
+// Sorts the particles into the cells, the particles within a cell are linked
+// in increasing order
+void Packing::build_cell_list() {
+	for (int c = 0; c < No_cl; c++) Link_head[c] = -1;
+	if (!useCellList) return;
+
+	for (int ipart = NumParts - 1; ipart >= 0; ipart--) {
+		vector3 & pos = particles[ipart]->get_pos();
+		int icell[3];
+		for (int d = 0; d < 3; d++) {
+			icell[d] = (int) (pos[d] / Cl_size[d]);
+			if (icell[d] >= Ncl[d]) icell[d] = Ncl[d] - 1;
+			if (icell[d] < 0) icell[d] = 0;
+		}
+		int icl = Ncl[2] * (Ncl[1] * icell[0] + icell[1]) + icell[2];
+		Link_list[ipart] = Link_head[icl];
+		Link_head[icl] = ipart;
+	}
 }
 
-void Packing::force_part(int ipart_p) {
-	int	jpart, ifirst;
-	int	icell_x, icell_xy, icell_y, icell_z, icell;
-	int leap_x, leap_y, leap_z;
+void Packing::force_part(int ipart_p, vector<Contact> & contacts, double & dinner) {
 	Ellipsoid *pi = particles[ipart_p], *pj;
-	vector3 rij;
 	vector3 pos = pi->get_pos();
+	int icell[3];
+	for (int d = 0; d < 3; d++) {
+		icell[d] = (int) (pos[d] / Cl_size[d]);
+		if (icell[d] >= Ncl[d]) icell[d] = Ncl[d] - 1;
+		if (icell[d] < 0) icell[d] = 0;
+	}
 
-	int low_cell_x = (int) (pos[0] + No_cells_x - Rcut);
-	int low_cell_y = (int) (pos[1] + No_cells_y - Rcut);
-	int low_cell_z = (int) (pos[2] + No_cells_z - Rcut);
-	int lim_cell_x = (int) (pos[0] + No_cells_x + Rcut);
-	int lim_cell_y = (int) (pos[1] + No_cells_y + Rcut);
-	int lim_cell_z = (int) (pos[2] + No_cells_z + Rcut);
-
-	#pragma omp  parallel
-    for (leap_x=low_cell_x; leap_x<=lim_cell_x; leap_x++) {
-        icell_x = Ncell_bound_x[leap_x];
-        for (leap_y=low_cell_y; leap_y<=lim_cell_y; leap_y++) {
-            icell_xy = Ncell_bound_y[leap_y] + icell_x;
-            #pragma omp for private(leap_z)
-            for (leap_z=low_cell_z; leap_z<=lim_cell_z; leap_z++) {
-                icell = Ncell_bound_z[leap_z] + icell_xy;
-                jpart = Link_head[icell];
-                while (jpart != -1) {
-                    pj = particles[jpart];
-                    rij = pj->get_pos() - pi->get_pos();
-                    BinaryEllipsoidSystem eij(*pi, *pj, rij);
-                    calc_forces(eij, *pi, *pj);
-                    jpart = Link_list[jpart];
-                }
-            }
-        }
-    }
-
-	icell_x = (int) pos[0];
-	icell_y = (int) pos[1];
-	icell_z = (int) pos[2];
-	icell = No_cells_z * (No_cells_y * icell_x + icell_y) + icell_z;
-	ifirst = Link_head[icell];
-	Link_list[ipart_p] = ifirst;
-	Link_head[icell] = ipart_p;
+	for (int leap_x = -1; leap_x <= 1; leap_x++) {
+		int icell_x = (icell[0] + leap_x + Ncl[0]) % Ncl[0];
+		for (int leap_y = -1; leap_y <= 1; leap_y++) {
+			int icell_xy = Ncl[1] * icell_x + (icell[1] + leap_y + Ncl[1]) % Ncl[1];
+			for (int leap_z = -1; leap_z <= 1; leap_z++) {
+				int icl = Ncl[2] * icell_xy + (icell[2] + leap_z + Ncl[2]) % Ncl[2];
+				// Particles are linked in increasing order, so stop at ipart_p
+				for (int jpart = Link_head[icl]; jpart != -1 && jpart < ipart_p; jpart = Link_list[jpart]) {
+					pj = particles[jpart];
+					vector3 rij = pj->get_pos() - pos;
+					rij.pbc_diff(Half, Box);
+					double rcut = Douter * (Rbound[ipart_p] + Rbound[jpart]);
+					if (rij*rij > rcut*rcut) continue;
+					BinaryEllipsoidSystem eij(*pi, *pj, rij);
+					Contact c;
+					if (calc_forces(eij, *pi, *pj, c, dinner)) {
+						c.ipart = ipart_p;
+						c.jpart = jpart;
+						contacts.push_back(c);
+					}
+				}
+			}
+		}
+	}
 }
 
-void Packing::force_all(int ipart_p) {
+void Packing::force_all(int ipart_p, vector<Contact> & contacts, double & dinner) {
 	Ellipsoid *pi = particles[ipart_p], *pj;
 	vector3 pos = pi->get_pos();
-	vector3 rij;
-	int jpart;
 
-	#pragma omp parallel for private(jpart)
-	for (jpart = 0; jpart < ipart_p; jpart++) {
+	for (int jpart = 0; jpart < ipart_p; jpart++) {
 		pj = particles[jpart];
-		rij = pj->get_pos() - pi->get_pos();
+		vector3 rij = pj->get_pos() - pos;
 		rij.pbc_diff(Half, Box);
 		BinaryEllipsoidSystem eij(*pi, *pj, rij);
-		calc_forces(eij, *pi, *pj);
+		Contact c;
+		if (calc_forces(eij, *pi, *pj, c, dinner)) {
+			c.ipart = ipart_p;
+			c.jpart = jpart;
+			contacts.push_back(c);
+		}
 	}
-	int icell_x = (int) pos[0];
-	int icell_y = (int) pos[1];
-	int icell_z = (int) pos[2];
-	int icell = No_cells_z * (No_cells_y * icell_x + icell_y) + icell_z;
-	int ifirst = Link_head[icell];
-	Link_list[ipart_p] = ifirst;
-	Link_head[icell] = ipart_p;
+}
+
+// Pushes the ellipsoid away from the walls of the geometry. The surface of the
+// (unscaled) ellipsoid is sampled in 98 directions, every sample closer to
+// the wall than the margin contributes a force along the wall normal,
+// relative to its penetration depth.
+void Packing::force_wall(int ipart_p) {
+	Ellipsoid *p = particles[ipart_p];
+	vector3 size = p->getSpecies()->getSize();
+	double rmax = 0.5 * max(max(size[0], size[1]), size[2]);
+	matrix33 Qt = transp(p->get_q().countQ());
+	bool doRotation = !(Epsilon_rot < 1e-10 || NumSteps % Nrot_step) && !p->getSpecies()->getIsSphere();
+
+	for (int ux = -2; ux <= 2; ux++)
+	for (int uy = -2; uy <= 2; uy++)
+	for (int uz = -2; uz <= 2; uz++) {
+		if (abs(ux) != 2 && abs(uy) != 2 && abs(uz) != 2) continue; // Surface of the 5x5x5 cube only
+		vector3 u = norm(vector3(ux, uy, uz));
+		vector3 body(0.5 * size[0] * u[0], 0.5 * size[1] * u[1], 0.5 * size[2] * u[2]);
+		vector3 r = Qt * body;
+		vector3 sample = (p->get_pos() + r) * (1./Sizing);
+		double penetration = (Wall_margin - Flags->getDistance(sample)) * Sizing;
+		if (penetration <= 0) continue;
+
+		vector3 n = Flags->getNormal(sample);
+		double mag = (penetration < rmax) ? penetration / rmax : 1.;
+		p->get_f() += mag * n;
+		vector3 torque = prod(r, n);
+		if (doRotation && torque*torque > 1e-20) p->get_fu() += mag * norm(torque);
+	}
+}
+
+// Draws random positions until the center of the ellipsoid lies in the fluid
+void Packing::place_in_fluid(int ipart_p) {
+	vector3 & pos = particles[ipart_p]->get_pos();
+	for (int tries = 0; tries < 10000; tries++) {
+		if (Flags->getDistance(pos * (1./Sizing)) > Wall_margin) return;
+		pos.random().scale(Box);
+	}
+	cout << "WARNING: Could not place particle " << ipart_p << " in the fluid region of the geometry." << endl;
 }
 
 void Packing::outputHeader() {
@@ -543,8 +668,7 @@ void Packing::getOutput(vector<vector<vector3> > &positions, vector<vector<vecto
             Ellipsoid *pi = particles[counter];
 
             vector3 pos = pi->get_pos();
-            matrix33 Q = pi->get_q().countQ();
-            vector3 euler(atan2(Q(1,2),Q(2,2)), -asin(Q(0,2)), atan2(Q(0,1),Q(0,0)));
+            vector3 euler = pi->get_q().eulerAngles();
             //euler *= 180 / PI; //Rad to Deg
 
             positions[ns][nc] = vector3(pos[0], pos[1], pos[2]) * (1./Sizing);
@@ -584,8 +708,7 @@ void Packing::savePov(const char *fileName, int wbcNumber)
         setw(12) << rad[1] << ", " <<
         setw(12) << rad[2] << "> " << endl;
         if (!sph) {	//	sphere
-            matrix33 Q = pi->get_q().countQ();
-            vector3 euler(atan2(Q(1,2),Q(2,2)), -asin(Q(0,2)), atan2(Q(0,1),Q(0,0)));
+            vector3 euler = pi->get_q().eulerAngles();
             euler *= 180 / PI;
             povf << "rotate " << setw(12) << euler[0] << "*x" << endl;
             povf << "rotate " << setw(12) << euler[1] << "*y" << endl;
@@ -631,8 +754,7 @@ void Packing::saveBloodCellPositions()
 			Ellipsoid *pi = particles[i];
 
 			vector3 pos = pi->get_pos() * (1./Sizing);
-			matrix33 Q = pi->get_q().countQ();
-			vector3 euler(atan2(Q(1,2),Q(2,2)), -asin(Q(0,2)), atan2(Q(0,1),Q(0,0)));
+			vector3 euler = pi->get_q().eulerAngles();
 			euler *= 180 / PI; //Rad to Deg
 
 			//if(i < species[0]->getn())
@@ -647,6 +769,60 @@ void Packing::saveBloodCellPositions()
 
 }
 
+// Writes <Cell>.posb files, see cellPositionsBinary.h for the layout. binSize
+// is in [µm] and should be in the order of an atomic block of the simulation.
+void Packing::saveBloodCellPositionsBinary(double binSize)
+{
+	int speciesCounter = 0;
+
+	for (int j = 0; j < NumSpecies; j++){
+		PosbHeader header;
+		initPosbHeader(header, species[j]->name, species[j]->getNum());
+		header.binSize = binSize;
+		for (int d = 0; d < 3; d++) {
+			header.origin[d] = 0.0;
+			header.nBins[d] = (uint32_t)ceil(Box[d] * (1./Sizing) / binSize);
+			if (header.nBins[d] == 0) header.nBins[d] = 1;
+		}
+
+		// Collect the records in the same form as the text output
+		vector<PosbRecord> records(species[j]->getNum());
+		vector<uint64_t> recordBin(species[j]->getNum());
+		vector<uint64_t> binStart(posbNumberOfBins(header)+1, 0);
+		for(int i = 0; i < species[j]->getNum(); i++)
+		{
+			Ellipsoid *pi = particles[speciesCounter+i];
+
+			vector3 pos = pi->get_pos() * (1./Sizing);
+			vector3 euler = pi->get_q().eulerAngles();
+			euler *= 180 / PI; //Rad to Deg
+
+			for (int d = 0; d < 3; d++) {
+				records[i].position[d] = pos[d];
+				records[i].rotation[d] = euler[d];
+			}
+			recordBin[i] = posbLinearBin(header, posbBinOf(header, 0, pos[0]),
+			                             posbBinOf(header, 1, pos[1]),
+			                             posbBinOf(header, 2, pos[2]));
+			binStart[recordBin[i]+1]++;
+		}
+
+		// Counting sort of the records over the bins
+		for (size_t b = 1; b < binStart.size(); b++) binStart[b] += binStart[b-1];
+		vector<PosbRecord> sorted(records.size());
+		vector<uint64_t> fill(binStart.begin(), binStart.end()-1);
+		for (size_t i = 0; i < records.size(); i++) sorted[fill[recordBin[i]]++] = records[i];
+
+		ofstream cellsFile (species[j]->name + ".posb", ios::binary);
+		cellsFile.write((const char *)&header, sizeof(PosbHeader));
+		cellsFile.write((const char *)binStart.data(), binStart.size()*sizeof(uint64_t));
+		cellsFile.write((const char *)sorted.data(), sorted.size()*sizeof(PosbRecord));
+		cellsFile.close();
+
+		speciesCounter += species[j]->getNum();
+	}
+}
+
 /*
  ************************************************************************
  *	    		    C math library
@@ -0,0 +1,85 @@
+/*
+This file is part of the HemoCell library
+
+HemoCell is developed and maintained by the Computational Science Lab 
+in the University of Amsterdam. Any questions or remarks regarding this library 
+can be sent to: info@hemocell.eu
+
+When using the HemoCell library in scientific work please cite the
+corresponding paper: https://doi.org/10.3389/fphys.2017.00563
+
+The HemoCell library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Affero General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+The library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Checks that orientations written to the <Cell>.pos files read back as the
+// same rotation, both for the Euler conversion and through --resume
+
+#include "packing.h"
+
+static double angleDifference(const vector3 & a, const vector3 & b) {
+  double diff = 0;
+  for (int i = 0; i < 3; i++)
+    diff = max(diff, fabs(remainder(a[i] - b[i], 2*PI)));
+  return diff;
+}
+
+static double maxDifference(const matrix33 & a, const matrix33 & b) {
+  double diff = 0;
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      diff = max(diff, fabs(a(i,j) - b(i,j)));
+  return diff;
+}
+
+int main() {
+  int failures = 0;
+
+  double diff = 0;
+  for (int i = 0; i < 10000; i++) {
+    vector3 p;
+    p.random();
+    Quaternion q(Random::getRandLimits(-1, 1), p - vector3(0.5, 0.5, 0.5));
+    Quaternion r(q.eulerAngles());
+    diff = max(diff, maxDifference(q.countQ(), r.countQ()));
+  }
+  cout << "Euler angles round trip, max difference: " << diff << endl;
+  if (diff > 1e-10) failures++;
+
+  vector<CellType> cellTypes;
+  cellTypes.push_back({"RBC", 8.4, 4.4, 8.4, 20});
+  vector<vector<vector3> > positions, written, read;
+
+  Packing writer;
+  writer.initBlood(30, 30, 30, 100, 1.0, cellTypes);
+  writer.execute();
+  writer.saveBloodCellPositions();
+  writer.getOutput(positions, written);
+
+  Packing reader;
+  reader.setResume(true);
+  reader.initBlood(30, 30, 30, 0, 1.0, cellTypes);
+  reader.execute();
+  reader.getOutput(positions, read);
+  remove("RBC.pos");
+
+  // The text output keeps six digits of the angles in degrees
+  diff = 0;
+  for (unsigned int c = 0; c < written[0].size(); c++) {
+    diff = max(diff, angleDifference(written[0][c], read[0][c]));
+  }
+  cout << "RBC.pos write and read, max difference: " << diff << endl;
+  if (diff > 1e-4) failures++;
+
+  return failures;
+}